@@ -0,0 +1,64 @@
+#pragma once
+
+#include "frameloop.h"
+
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Frames rendered before measuring, so loading and driver warm-up stay out of the results
+static constexpr auto DEFAULT_WARMUP_FRAMES = std::size_t{60U};
+
+struct BenchmarkOptions {
+    bool headless = false;
+    // Zero runs interactively until the window closes
+    std::size_t numFrames = 0U;
+    std::size_t numWarmupFrames = DEFAULT_WARMUP_FRAMES;
+    std::optional<std::string> outputPath;
+    std::optional<std::string> recordInputPath;
+    // Replaces live input, so together with --benchmark two builds see the same session
+    std::optional<std::string> replayInputPath;
+    // Chrome trace of the CPU profiling zones
+    std::optional<std::string> tracePath;
+    // Left unset the window uses vsync interactively and runs uncapped for benchmarks
+    std::optional<PresentMode> presentMode;
+    // Implies PresentMode::Capped
+    std::optional<double> targetFps;
+    // Memory report written on exit, without one it goes to stderr
+    std::optional<std::string> memoryReportPath;
+
+    [[nodiscard]] auto IsBenchmark() const noexcept -> bool { return numFrames > 0U; }
+
+    // Accepts --headless, --benchmark <frames>, --warmup <frames>, --output <path>, --record-input <path>,
+    // --replay-input <path>, --trace <path>, --present <vsync|uncapped|capped>, --fps <rate>
+    // and --memory-report <path>
+    [[nodiscard]] static auto Parse(std::span<const std::string_view> args) -> BenchmarkOptions;
+};
+
+struct FrameTimeSummary {
+    double minMs = 0.0;
+    double avgMs = 0.0;
+    double p50Ms = 0.0;
+    double p95Ms = 0.0;
+    double p99Ms = 0.0;
+
+    // Percentiles use the nearest rank
+    [[nodiscard]] static auto FromSamples(std::span<const double> frameTimesMs) -> FrameTimeSummary;
+};
+
+class BenchmarkRecorder {
+    std::vector<double> frameTimesMs;
+    std::size_t totalDrawCalls = 0U;
+    std::size_t totalTriangles = 0U;
+
+public:
+    auto Reserve(std::size_t numFrames) -> void { frameTimesMs.reserve(numFrames); }
+    auto AddFrame(double frameTimeMs, std::size_t numDrawCalls, std::size_t numTriangles) -> void;
+
+    [[nodiscard]] auto NumFrames() const noexcept -> std::size_t { return frameTimesMs.size(); }
+    [[nodiscard]] auto Summary() const -> FrameTimeSummary { return FrameTimeSummary::FromSamples(frameTimesMs); }
+    [[nodiscard]] auto ToJson() const -> std::string;
+};
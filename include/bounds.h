@@ -0,0 +1,84 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <optional>
+#include <utility>
+
+struct BoundingBox {
+    glm::vec3 min{0.0F};
+    glm::vec3 max{0.0F};
+
+    [[nodiscard]] inline auto Center() const noexcept -> glm::vec3 { return (min + max) * 0.5F; }
+    [[nodiscard]] inline auto Extents() const noexcept -> glm::vec3 { return (max - min) * 0.5F; }
+
+    [[nodiscard]] inline auto SurfaceArea() const noexcept -> float {
+        const auto size = max - min;
+        return 2.0F * (size.x * size.y + size.y * size.z + size.z * size.x);
+    }
+
+    [[nodiscard]] inline auto Merged(const BoundingBox& other) const noexcept -> BoundingBox {
+        return BoundingBox{ .min = glm::min(min, other.min), .max = glm::max(max, other.max) };
+    }
+
+    [[nodiscard]] inline auto Contains(const BoundingBox& other) const noexcept -> bool {
+        return min.x <= other.min.x && min.y <= other.min.y && min.z <= other.min.z
+            && max.x >= other.max.x && max.y >= other.max.y && max.z >= other.max.z;
+    }
+
+    [[nodiscard]] inline auto Overlaps(const BoundingBox& other) const noexcept -> bool {
+        return min.x <= other.max.x && min.y <= other.max.y && min.z <= other.max.z
+            && max.x >= other.min.x && max.y >= other.min.y && max.z >= other.min.z;
+    }
+
+    [[nodiscard]] inline auto Transformed(const glm::mat4& transform) const noexcept -> BoundingBox {
+        const auto center = glm::vec3(transform * glm::vec4(Center(), 1.0F));
+        const auto extents = Extents();
+        const auto worldExtents = glm::vec3(
+            std::abs(transform[0][0]) * extents.x + std::abs(transform[1][0]) * extents.y + std::abs(transform[2][0]) * extents.z,
+            std::abs(transform[0][1]) * extents.x + std::abs(transform[1][1]) * extents.y + std::abs(transform[2][1]) * extents.z,
+            std::abs(transform[0][2]) * extents.x + std::abs(transform[1][2]) * extents.y + std::abs(transform[2][2]) * extents.z
+        );
+        return BoundingBox{ .min = center - worldExtents, .max = center + worldExtents };
+    }
+};
+
+struct BoundingSphere {
+    glm::vec3 center{0.0F};
+    float radius = 0.0F;
+
+    [[nodiscard]] inline auto Transformed(const glm::mat4& transform) const noexcept -> BoundingSphere {
+        const auto maxScale = std::max({
+            glm::length(glm::vec3(transform[0])),
+            glm::length(glm::vec3(transform[1])),
+            glm::length(glm::vec3(transform[2]))
+        });
+        return BoundingSphere{ .center = glm::vec3(transform * glm::vec4(center, 1.0F)), .radius = radius * maxScale };
+    }
+};
+
+struct Ray {
+    glm::vec3 origin{0.0F};
+    glm::vec3 direction{0.0F, 0.0F, -1.0F};
+
+    [[nodiscard]] inline auto At(float distance) const noexcept -> glm::vec3 { return origin + direction * distance; }
+
+    // Slab test, the distance where the ray enters the box or zero when it starts inside
+    [[nodiscard]] inline auto Intersect(const BoundingBox& box, float maxDistance) const noexcept -> std::optional<float> {
+        auto entryDistance = 0.0F;
+        auto exitDistance = maxDistance;
+        for (auto axis = 0; axis < 3; ++axis) {
+            const auto invDirection = 1.0F / direction[axis];
+            auto t0 = (box.min[axis] - origin[axis]) * invDirection;
+            auto t1 = (box.max[axis] - origin[axis]) * invDirection;
+            if (t0 > t1) std::swap(t0, t1);
+            // Written so a NaN from a zero direction on a slab boundary leaves the interval alone
+            entryDistance = t0 > entryDistance ? t0 : entryDistance;
+            exitDistance = t1 < exitDistance ? t1 : exitDistance;
+            if (entryDistance > exitDistance) return std::nullopt;
+        }
+        return entryDistance;
+    }
+};
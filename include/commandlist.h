@@ -0,0 +1,52 @@
+#pragma once
+
+#include "gltask.h"
+#include "meshcomponent.h"
+#include "renderqueue.h"
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Matches the std140 Camera block in vert.glsl
+struct CameraUniforms {
+    glm::mat4 view;
+    glm::mat4 proj;
+};
+
+// Everything the GL thread needs to draw one frame, recorded on the simulation side
+struct CommandList {
+    // Consecutive indirect commands sharing a program and vao, submitted with one multi-draw
+    struct DrawBatch {
+        GLuint program;
+        GLuint vao;
+        std::size_t firstCommand;
+        std::size_t numCommands;
+    };
+
+    CameraUniforms camera{};
+    GLsizei viewportWidth = 0;
+    GLsizei viewportHeight = 0;
+
+    std::vector<DrawBatch> batches;
+    std::vector<glm::mat4> instanceData;
+    std::vector<DrawArraysIndirectCommand> indirectCommands;
+
+    // Keeps drawn meshes alive until the list is recorded into again, so the GL thread never frees one
+    std::vector<std::shared_ptr<const GpuMesh>> meshes;
+
+    // Deferred GL work to run before drawing
+    std::vector<GLTask> tasks;
+
+    // Keeps capacity, so recording reaches a steady state without allocating
+    auto Clear() noexcept -> void {
+        batches.clear();
+        instanceData.clear();
+        indirectCommands.clear();
+        meshes.clear();
+        tasks.clear();
+    }
+};
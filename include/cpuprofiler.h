@@ -0,0 +1,124 @@
+#pragma once
+
+#include "spscring.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#if defined(ENABLE_PROFILING) || !defined(NDEBUG)
+inline static constexpr bool ProfilingEnabled = true;
+#else
+inline static constexpr bool ProfilingEnabled = false;
+#endif
+
+struct ProfileEvent {
+    // Zone names must be string literals, only the pointer is kept
+    const char* name;
+    std::int64_t startNs;
+    std::int64_t endNs;
+};
+
+struct CapturedEvent {
+    ProfileEvent event;
+    std::uint32_t threadId;
+};
+
+// Zones are only recorded while a capture is running, each thread writes to its own ring which
+// Collect drains, so nothing on the recording side takes a lock
+class CpuProfiler {
+public:
+    static constexpr auto THREAD_BUFFER_EVENTS = std::size_t{8'192U};
+    // Longer captures stop growing and count the excess as dropped
+    static constexpr auto MAX_CAPTURED_EVENTS = std::size_t{1U << 21U};
+
+private:
+    struct ThreadBuffer {
+        SpscRing<ProfileEvent, THREAD_BUFFER_EVENTS> events;
+        std::uint32_t threadId;
+        std::size_t numDroppedSeen = 0U;
+    };
+
+    std::atomic<bool> capturing{false};
+    std::int64_t captureStartNs = 0;
+
+    mutable std::mutex buffersMutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    // Indexed by thread id, outlives the buffers of threads that have exited
+    std::vector<std::string> threadNames;
+
+    std::vector<CapturedEvent> captured;
+    std::size_t numDropped = 0U;
+
+    [[nodiscard]] CpuProfiler() = default;
+
+    [[nodiscard]] auto GetThreadBuffer() -> ThreadBuffer&;
+
+public:
+    CpuProfiler(const CpuProfiler&) = delete;
+    auto operator=(const CpuProfiler&) -> CpuProfiler& = delete;
+    CpuProfiler(CpuProfiler&&) = delete;
+    auto operator=(CpuProfiler&&) -> CpuProfiler& = delete;
+
+    [[nodiscard]] static auto GetInstance() -> CpuProfiler&;
+
+    [[nodiscard]] static auto Now() noexcept -> std::int64_t {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Names the calling thread in exported traces
+    auto SetThreadName(std::string name) -> void;
+
+    // Discards the previous capture
+    auto BeginCapture() -> void;
+    auto EndCapture() -> void;
+    [[nodiscard]] auto IsCapturing() const noexcept -> bool { return capturing.load(std::memory_order_relaxed); }
+
+    // Producer side, called by ProfileZone on the thread that ran the zone
+    auto Record(const ProfileEvent& event) -> void;
+
+    // Moves every thread's finished zones into the capture, must be called from one thread at a time
+    // and often enough, once per frame, that no ring fills up
+    auto Collect() -> void;
+
+    [[nodiscard]] auto GetCaptured() const noexcept -> const std::vector<CapturedEvent>& { return captured; }
+    // Zones lost to full rings or the capture limit since BeginCapture, as of the last Collect
+    [[nodiscard]] auto NumDropped() const noexcept -> std::size_t { return numDropped; }
+
+    // Chrome trace_event JSON, loads in chrome://tracing and Perfetto
+    [[nodiscard]] auto ToChromeTrace() const -> std::string;
+    auto WriteChromeTrace(const std::filesystem::path& filePath) const -> void;
+};
+
+// Records the time between construction and destruction as a zone on the current thread,
+// compiles to nothing when profiling is disabled
+class ProfileZone {
+    const char* name = nullptr;
+    std::int64_t startNs = 0;
+
+public:
+    [[nodiscard]] explicit ProfileZone([[maybe_unused]] const char* zoneName) noexcept {
+        if constexpr (ProfilingEnabled) {
+            if (!CpuProfiler::GetInstance().IsCapturing()) return;
+            name = zoneName;
+            startNs = CpuProfiler::Now();
+        }
+    }
+
+    ~ProfileZone() noexcept {
+        if constexpr (ProfilingEnabled) {
+            if (name != nullptr) CpuProfiler::GetInstance().Record(ProfileEvent{.name = name, .startNs = startNs, .endNs = CpuProfiler::Now()});
+        }
+    }
+
+    ProfileZone(const ProfileZone&) = delete;
+    auto operator=(const ProfileZone&) -> ProfileZone& = delete;
+    ProfileZone(ProfileZone&&) = delete;
+    auto operator=(ProfileZone&&) -> ProfileZone& = delete;
+};
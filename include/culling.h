@@ -0,0 +1,70 @@
+#pragma once
+
+#include "bounds.h"
+#include "meshcluster.h"
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+struct Frustum {
+    // Normalised planes as (normal, distance), a point is inside when dot(normal, p) + distance >= 0
+    std::array<glm::vec4, 6> planes;
+
+    [[nodiscard]] static auto FromMatrix(const glm::mat4& viewProj) noexcept -> Frustum;
+
+    [[nodiscard]] auto Intersects(const BoundingSphere& sphere) const noexcept -> bool;
+    [[nodiscard]] auto Intersects(const BoundingBox& box) const noexcept -> bool;
+};
+
+struct CullStats {
+    std::size_t tested = 0U;
+    std::size_t culled = 0U;
+};
+
+// Tests world-space spheres against a frustum four at a time from SoA storage
+class FrustumCuller {
+private:
+    std::vector<float> centerX;
+    std::vector<float> centerY;
+    std::vector<float> centerZ;
+    std::vector<float> radius;
+    std::vector<std::uint32_t> visible;
+    CullStats stats;
+
+public:
+    auto Clear() noexcept -> void;
+    auto Reserve(std::size_t count) -> void;
+
+    // Returns the index later reported by Cull
+    auto Add(const BoundingSphere& sphere) -> std::uint32_t;
+
+    // Indices of the spheres touching the frustum, in insertion order
+    [[nodiscard]] auto Cull(const Frustum& frustum) -> const std::vector<std::uint32_t>&;
+
+    [[nodiscard]] auto Size() const noexcept -> std::size_t { return radius.size(); }
+    [[nodiscard]] auto GetStats() const noexcept -> const CullStats& { return stats; }
+    auto ResetStats() noexcept -> void { stats = CullStats{}; }
+};
+
+struct ClusterCullStats {
+    std::size_t tested = 0U;
+    std::size_t frustumCulled = 0U;
+    std::size_t backfaceCulled = 0U;
+};
+
+// Vertex ranges laid out for glMultiDrawArrays
+struct DrawRanges {
+    std::vector<std::int32_t> firsts;
+    std::vector<std::int32_t> counts;
+
+    auto Clear() noexcept -> void { firsts.clear(); counts.clear(); }
+    [[nodiscard]] auto Size() const noexcept -> std::size_t { return firsts.size(); }
+};
+
+// Frustum and camera position must be in the clusters' mesh space, adjacent survivors are merged into one range
+auto CullClusters(std::span<const MeshCluster> clusters, const Frustum& frustum, const glm::vec3& cameraPos, DrawRanges& ranges, ClusterCullStats& stats) -> void;
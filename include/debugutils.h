@@ -1,8 +1,12 @@
 #pragma once
 
-#include <print>
-#include <utility>
+#include "logger.h"
+
+#include <format>
 #include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 
 #ifndef NDEBUG
 inline static constexpr bool DebugRunning = true;
@@ -10,31 +14,35 @@ inline static constexpr bool DebugRunning = true;
 inline static constexpr bool DebugRunning = false;
 #endif
 
+// Messages are queued for the logger thread, so the caller only pays for copying the arguments
 template <class S, class T>
-auto DebugMessage([[maybe_unused]] S&& debugLevel, [[maybe_unused]] T&& message) noexcept -> void {
-    if constexpr (DebugRunning) {
-        std::println(
-            "[{:<7}]: {}", 
-            std::forward<S>(debugLevel), 
-            std::forward<T>(message)
-        );
-    } 
+auto DebugMessage(S&& debugLevel, T&& message) noexcept -> void {
+    auto& logger = Logger::GetInstance();
+    const auto level = ParseLogLevel(debugLevel);
+    if (!logger.IsEnabled(level)) return;
+
+    // Literals are rate limited by address, built strings are not as theirs changes every call
+    const void* site = nullptr;
+    if constexpr (std::is_array_v<std::remove_cvref_t<T>>) site = message;
+
+    logger.Log(level, site, "{}", std::string_view(message));
 }
 
 template <class S, class... Args>
 auto DebugMessage(S&& debugLevel, std::format_string<Args...> format, Args&&... args) noexcept -> void {
-    DebugMessage(std::forward<S>(debugLevel), std::format(format, std::forward<Args>(args)...));
+    const auto formatString = std::string_view(format.get());
+    Logger::GetInstance().Log(ParseLogLevel(debugLevel), formatString.data(), formatString, args...);
 }
 
 template <class S, class T>
-[[noreturn]] auto ThrowMessage([[maybe_unused]] S&& debugLevel, T&& message) -> void {
-    if constexpr (DebugRunning) std::println("[{:<7}]: {}", std::forward<S>(debugLevel), message);
-    
+[[noreturn]] auto ThrowMessage(S&& debugLevel, T&& message) -> void {
+    DebugMessage(std::forward<S>(debugLevel), std::string_view(message));
+
     throw std::runtime_error(message);
 }
 
 template <class S, class... Args>
-[[noreturn]] auto ThrowMessage(S&& debugLevel, std::format_string<Args...> format, Args&&... args) noexcept -> void {
+[[noreturn]] auto ThrowMessage(S&& debugLevel, std::format_string<Args...> format, Args&&... args) -> void {
     ThrowMessage(std::forward<S>(debugLevel), std::format(format, std::forward<Args>(args)...));
 }
 
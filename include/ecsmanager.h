@@ -2,7 +2,9 @@
 
 #include "componentmanagers.h"
 #include "debugutils.h"
+#include "memorytracker.h"
 
+#include <algorithm>
 #include <bitset>
 #include <concepts>
 #include <cstdint>
@@ -14,6 +16,7 @@
 #include <vector>
 #include <unordered_map>
 #include <memory>
+#include <memory_resource>
 
 static constexpr auto MAX_NUM_ENTITIES = EntityId{10'000};
 
@@ -167,15 +170,52 @@ public:
             });
     }
 
+    // GetAll materialised for random access, pass a FrameArena for per-frame queries
+    template <typename... Comps>
+    requires SupportsComponents<ECSManager<CMs...>, Comps...>
+    [[nodiscard]] auto CollectAll(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+        auto query = GetAll<Comps...>();
+        auto result = std::pmr::vector<std::ranges::range_value_t<decltype(query)>>{resource};
+        for (auto&& entry : query) result.push_back(entry);
+        return result;
+    }
+
+    template <typename... Comps>
+    requires SupportsComponents<ECSManager<CMs...>, Comps...>
+    [[nodiscard]] auto CollectAll(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const {
+        auto query = GetAll<Comps...>();
+        auto result = std::pmr::vector<std::ranges::range_value_t<decltype(query)>>{resource};
+        for (auto&& entry : query) result.push_back(entry);
+        return result;
+    }
+
     [[nodiscard]] constexpr auto NumEntitySlots() const noexcept {
         return entityBits.size();
     }
+
+    // Managers without a GetMemoryStats of their own are left out of the component list
+    [[nodiscard]] auto GetMemoryStats() const -> EcsMemoryStats {
+        auto stats = EcsMemoryStats{
+            .numEntitySlots = entityBits.size(),
+            .numLiveEntities = static_cast<std::size_t>(std::ranges::count_if(entityBits, [](const auto& bits) { return bits.has_value(); })),
+            .entitySlotBytes = entityBits.capacity() * sizeof(typename decltype(entityBits)::value_type)
+        };
+
+        std::apply([&](const auto&... cms) {
+            ([&] {
+                if constexpr (requires { cms.GetMemoryStats(); }) stats.components.push_back(cms.GetMemoryStats());
+            }(), ...);
+        }, componentManagers);
+        return stats;
+    }
 };
 
-template <typename T>
+// Tag picks the counter the table reports to, wrappers of another type count under that type
+template <typename T, typename Tag = ComponentMemoryTag<T>>
 struct BasicCompManager {
     using ComponentType = T;
-    std::unordered_map<EntityId, T> map;
+    using Allocator = TrackingAllocator<std::pair<const EntityId, T>, Tag>;
+    std::unordered_map<EntityId, T, std::hash<EntityId>, std::equal_to<EntityId>, Allocator> map;
 
     template <typename... Args>
     requires std::constructible_from<ComponentType, Args...>
@@ -198,18 +238,63 @@ struct BasicCompManager {
         map.erase(iter);
         return true;
     }
+
+    // Bytes cover the table's nodes and buckets
+    [[nodiscard]] auto GetMemoryStats() const -> ComponentMemoryStats {
+        const auto& counter = Tag::Counter();
+        return ComponentMemoryStats{
+            .name = TypeName<T>(),
+            .numComponents = map.size(),
+            .numBuckets = map.bucket_count(),
+            .loadFactor = map.load_factor(),
+            .bytes = counter.Bytes(),
+            .highWater = counter.HighWater()
+        };
+    }
 };
 
+// Counts under T like BasicCompManager<T>, so the counter and GetMemoryStats agree on the name
 template <typename T>
-struct DynamicCompManager : public BasicCompManager<std::unique_ptr<T>> {
+struct DynamicCompManager : public BasicCompManager<std::unique_ptr<T>, ComponentMemoryTag<T>> {
     using ComponentType = T;
+    using Base = BasicCompManager<std::unique_ptr<T>, ComponentMemoryTag<T>>;
+
+    [[nodiscard]] DynamicCompManager() = default;
+    DynamicCompManager(const DynamicCompManager&) = delete;
+    auto operator=(const DynamicCompManager&) -> DynamicCompManager& = delete;
+    DynamicCompManager(DynamicCompManager&&) noexcept = default;
+    auto operator=(DynamicCompManager&& other) noexcept -> DynamicCompManager& {
+        ComponentMemoryTag<T>::Counter().Remove(Base::map.size() * sizeof(T));
+        Base::operator=(std::move(other));
+        return *this;
+    }
+
+    // The pointed-to objects are counted alongside the table at sizeof(T), derived objects may be larger
+    ~DynamicCompManager() noexcept {
+        ComponentMemoryTag<T>::Counter().Remove(Base::map.size() * sizeof(T));
+    }
 
     template <typename... Args>
     requires std::constructible_from<ComponentType, Args...>
     auto New(EntityId id, Args&&... args) -> T& {
-        return *BasicCompManager<std::unique_ptr<T>>::New(id, std::make_unique<Args...>(std::forward<Args>(args)...));
+        const auto numBefore = Base::map.size();
+        auto& component = *Base::New(id, std::make_unique<Args...>(std::forward<Args>(args)...));
+        if (Base::map.size() != numBefore) ComponentMemoryTag<T>::Counter().Add(sizeof(T));
+        return component;
+    }
+
+    auto Delete(EntityId id) -> bool {
+        if (!Base::Delete(id)) return false;
+        ComponentMemoryTag<T>::Counter().Remove(sizeof(T));
+        return true;
+    }
+
+    [[nodiscard]] auto GetMemoryStats() const -> ComponentMemoryStats {
+        auto stats = Base::GetMemoryStats();
+        stats.name = TypeName<T>();
+        return stats;
     }
 
-    [[nodiscard]] auto Get(EntityId id) -> T& { return *BasicCompManager<std::unique_ptr<T>>::Get(id); }
-    [[nodiscard]] auto Get(EntityId id) const -> const T& { return *BasicCompManager<std::unique_ptr<T>>::Get(id).get(); }
+    [[nodiscard]] auto Get(EntityId id) -> T& { return *Base::Get(id); }
+    [[nodiscard]] auto Get(EntityId id) const -> const T& { return *Base::Get(id).get(); }
 };
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+// Bump allocator for data that lives no longer than a frame. Deallocation is a no-op and Reset frees
+// everything at once; after a frame that overflowed, the chunks are merged so later frames of the same
+// size never go back to the upstream resource
+class FrameArena : public std::pmr::memory_resource {
+public:
+    static constexpr auto DEFAULT_CAPACITY = std::size_t{256U * 1'024U};
+
+private:
+    struct Chunk {
+        std::byte* data;
+        std::size_t size;
+        std::size_t alignment;
+    };
+
+    std::pmr::memory_resource* upstream;
+    std::vector<Chunk> chunks;
+    std::size_t currentChunk = 0U;
+    std::size_t offset = 0U;
+
+    std::size_t bytesUsed = 0U;
+    std::size_t highWater = 0U;
+    std::size_t numUpstreamAllocations = 0U;
+
+    auto AddChunk(std::size_t minSize, std::size_t alignment) -> void;
+    auto ReleaseChunks() noexcept -> void;
+
+    auto do_allocate(std::size_t bytes, std::size_t alignment) -> void* override;
+    auto do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) -> void override;
+    [[nodiscard]] auto do_is_equal(const std::pmr::memory_resource& other) const noexcept -> bool override { return this == &other; }
+
+public:
+    [[nodiscard]] explicit FrameArena(std::size_t initialCapacity = DEFAULT_CAPACITY, std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+    ~FrameArena() noexcept override;
+
+    FrameArena(const FrameArena&) = delete;
+    auto operator=(const FrameArena&) -> FrameArena& = delete;
+    FrameArena(FrameArena&&) = delete;
+    auto operator=(FrameArena&&) -> FrameArena& = delete;
+
+    // Invalidates every allocation made since the last reset
+    auto Reset() -> void;
+
+    // The calling thread's arena, reset the first time the thread asks for it after BeginFrame
+    [[nodiscard]] static auto ForThread() -> FrameArena&;
+    // Marks a frame boundary for every thread's arena, allocations from earlier frames must no longer be in use
+    static auto BeginFrame() noexcept -> void;
+
+    [[nodiscard]] auto BytesUsed() const noexcept -> std::size_t { return bytesUsed; }
+    [[nodiscard]] auto HighWater() const noexcept -> std::size_t { return highWater; }
+    [[nodiscard]] auto Capacity() const noexcept -> std::size_t;
+    // Chunks taken from upstream, stays flat once the arena has seen its largest frame
+    [[nodiscard]] auto NumUpstreamAllocations() const noexcept -> std::size_t { return numUpstreamAllocations; }
+};
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+enum class PresentMode : std::uint8_t {
+    // Swap interval 1, the display paces frames
+    Vsync = 0U,
+    // Swap interval 0 and no limiter, for benchmarks
+    Uncapped = 1U,
+    // Swap interval 0 with the frame loop holding frames to targetFps
+    Capped = 2U
+};
+
+[[nodiscard]] auto ParsePresentMode(std::string_view name) noexcept -> std::optional<PresentMode>;
+
+static constexpr auto DEFAULT_SIMULATION_HZ = 120.0;
+static constexpr auto DEFAULT_TARGET_FPS = 144.0;
+
+struct FrameLoopSettings {
+    double simulationHz = DEFAULT_SIMULATION_HZ;
+    PresentMode presentMode = PresentMode::Vsync;
+    // Only used by PresentMode::Capped
+    double targetFps = DEFAULT_TARGET_FPS;
+    // A frame this many steps behind drops the excess instead of spiralling further behind
+    std::size_t maxStepsPerFrame = 8U;
+
+    [[nodiscard]] auto SwapInterval() const noexcept -> int { return presentMode == PresentMode::Vsync ? 1 : 0; }
+};
+
+struct FrameTimingStats {
+    std::uint64_t numFrames = 0U;
+    std::uint64_t numSteps = 0U;
+    // Simulation time thrown away because a frame needed more than maxStepsPerFrame steps
+    std::uint64_t numDroppedSteps = 0U;
+    std::size_t lastSteps = 0U;
+    // From the frame slot opening until EndFrame, so time the limiter spends waiting is not counted
+    double lastFrameMs = 0.0;
+    // Exponential moving average, reacts within a few dozen frames
+    double avgFrameMs = 0.0;
+    double minFrameMs = 0.0;
+    double maxFrameMs = 0.0;
+    // Time the capped limiter spent waiting before the last frame
+    double lastWaitMs = 0.0;
+};
+
+// Runs simulation at a fixed rate whatever the frame rate, with the remainder exposed as an
+// interpolation factor for rendering between the last two simulated states
+class FrameLoop {
+public:
+    using Clock = std::chrono::steady_clock;
+    using Duration = std::chrono::duration<double>;
+
+    // Sleeping is only trusted up to this close to the deadline, the rest is spun
+    static constexpr auto SPIN_THRESHOLD = std::chrono::microseconds{1'500};
+    static constexpr auto AVERAGE_WEIGHT = 0.05;
+
+private:
+    FrameLoopSettings settings;
+    Duration step;
+    Duration accumulator{0.0};
+    std::optional<Clock::time_point> lastFrameStart;
+    FrameTimingStats stats;
+
+    auto WaitForFrameSlot() -> void;
+
+public:
+    [[nodiscard]] explicit FrameLoop(const FrameLoopSettings& settings = FrameLoopSettings{});
+
+    // Call at the top of every frame before sampling input. Waits if the present mode is capped,
+    // then returns how many fixed steps to simulate this frame
+    [[nodiscard]] auto BeginFrame() -> std::size_t;
+
+    // The waiting half of BeginFrame, returns the time since the last frame started or nothing on the first frame
+    [[nodiscard]] auto WaitForFrame() -> std::optional<Duration>;
+
+    // The stepping half of BeginFrame, moves the accumulator by a given frame time for replays and benchmarks
+    [[nodiscard]] auto Advance(Duration frameTime) -> std::size_t;
+
+    // Call once the frame is submitted, records its time in the stats
+    auto EndFrame() -> void;
+
+    // Fraction of a step between the last simulated state and the next one, in [0, 1)
+    [[nodiscard]] auto Alpha() const noexcept -> float { return static_cast<float>(accumulator / step); }
+    [[nodiscard]] auto StepDuration() const noexcept -> Duration { return step; }
+
+    // Fixed for the loop's lifetime, the window applies the swap interval once when it is created
+    [[nodiscard]] auto GetSettings() const noexcept -> const FrameLoopSettings& { return settings; }
+
+    [[nodiscard]] auto GetStats() const noexcept -> const FrameTimingStats& { return stats; }
+    auto ResetStats() noexcept -> void { stats = FrameTimingStats{}; }
+};
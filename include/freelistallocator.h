@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <vector>
+
+// Offset allocator for a linear range, handles stay valid when the range is compacted
+class FreeListAllocator {
+public:
+    using Handle = std::uint32_t;
+
+    struct Relocation {
+        Handle handle;
+        std::uint32_t from;
+        std::uint32_t to;
+        std::uint32_t size;
+    };
+
+private:
+    struct Block {
+        std::uint32_t offset = 0U;
+        std::uint32_t size = 0U;
+        bool live = false;
+    };
+
+    std::uint32_t capacity;
+    std::uint32_t usedSize = 0U;
+    std::map<std::uint32_t, std::uint32_t> freeBlocks;
+    std::vector<Block> blocks;
+    std::vector<Handle> freeHandles;
+
+    auto InsertFree(std::uint32_t offset, std::uint32_t size) -> void;
+
+public:
+    [[nodiscard]] explicit FreeListAllocator(std::uint32_t capacity);
+
+    // Best fit, returns nothing when no single free block is large enough
+    [[nodiscard]] auto Allocate(std::uint32_t size) -> std::optional<Handle>;
+    auto Free(Handle handle) -> void;
+
+    // Extends the range, existing allocations keep their offsets
+    auto Grow(std::uint32_t newCapacity) -> void;
+
+    // Packs every live allocation to the front, returning where each one moved
+    [[nodiscard]] auto Compact() -> std::vector<Relocation>;
+
+    [[nodiscard]] auto Offset(Handle handle) const -> std::uint32_t { return blocks.at(handle).offset; }
+    [[nodiscard]] auto Size(Handle handle) const -> std::uint32_t { return blocks.at(handle).size; }
+
+    [[nodiscard]] auto Capacity() const noexcept -> std::uint32_t { return capacity; }
+    [[nodiscard]] auto UsedSize() const noexcept -> std::uint32_t { return usedSize; }
+    [[nodiscard]] auto FreeSize() const noexcept -> std::uint32_t { return capacity - usedSize; }
+    [[nodiscard]] auto NumFreeBlocks() const noexcept -> std::size_t { return freeBlocks.size(); }
+    [[nodiscard]] auto LargestFreeBlock() const noexcept -> std::uint32_t;
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "freelistallocator.h"
+#include "gltask.h"
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <span>
+
+struct Vertex;
+
+// One large vertex buffer and VAO that every mesh is sub-allocated from, so draws never rebind geometry.
+// Bookkeeping happens on the calling thread, GL work goes through the executor in submission order.
+class GeometryArena {
+public:
+    using Handle = FreeListAllocator::Handle;
+
+    // Capacity in vertices
+    static constexpr auto DEFAULT_CAPACITY = std::uint32_t{1U << 20U};
+
+private:
+    FreeListAllocator allocator;
+    GLExecutor* executor = &InlineGLExecutor::GetInstance();
+    GLuint vao = 0U;
+    GLuint vbo = 0U;
+    // Capacity the current vbo was created with, owned by the GL thread
+    std::uint32_t vboCapacity = 0U;
+
+    auto EnsureCreated() -> void;
+    auto Reallocate(std::uint32_t newCapacity, bool compact) -> void;
+
+public:
+    // GL objects are created on the first allocation, so an arena can outlive any use of a context
+    [[nodiscard]] explicit GeometryArena(std::uint32_t capacity = DEFAULT_CAPACITY);
+    ~GeometryArena() noexcept;
+
+    GeometryArena(const GeometryArena& other) = delete;
+    GeometryArena& operator=(const GeometryArena& other) = delete;
+    GeometryArena(GeometryArena&& other) = delete;
+    GeometryArena& operator=(GeometryArena&& other) = delete;
+
+    // The executor must outlive any further allocation or defragmentation
+    auto SetExecutor(GLExecutor& newExecutor) noexcept -> void { executor = &newExecutor; }
+
+    // Compacts when free space is fragmented and grows when it is exhausted, the vertices are copied for a deferred upload
+    [[nodiscard]] auto Allocate(std::span<const Vertex> vertices) -> Handle;
+    auto Free(Handle handle) -> void;
+
+    // Packs live meshes into a fresh buffer, first vertices change but handles do not
+    auto Defragment() -> void;
+
+    [[nodiscard]] auto FirstVertex(Handle handle) const -> GLint { return static_cast<GLint>(allocator.Offset(handle)); }
+    [[nodiscard]] auto Vao() const noexcept -> GLuint { return vao; }
+    [[nodiscard]] auto GetAllocator() const noexcept -> const FreeListAllocator& { return allocator; }
+};
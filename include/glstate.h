@@ -0,0 +1,94 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <array>
+#include <cstddef>
+#include <optional>
+
+struct GLStateStats {
+    std::size_t issued = 0U;
+    std::size_t elided = 0U;
+};
+
+// Shadows the context's binding and fixed-function state so redundant changes never reach the driver
+class GLState {
+public:
+    // Indexed uniform and shader storage bindings past this are always forwarded
+    static constexpr auto MAX_INDEXED_BINDINGS = std::size_t{16U};
+
+private:
+    struct BufferRange {
+        GLuint buffer;
+        GLintptr offset;
+        GLsizeiptr size;
+
+        [[nodiscard]] auto operator==(const BufferRange& other) const noexcept -> bool = default;
+    };
+
+    static constexpr auto NUM_BUFFER_TARGETS = std::size_t{9U};
+    static constexpr auto NUM_INDEXED_TARGETS = std::size_t{2U};
+    static constexpr auto NUM_CAPABILITIES = std::size_t{8U};
+
+    std::optional<GLuint> program;
+    std::optional<GLuint> vao;
+    std::optional<GLuint> drawFramebuffer;
+    std::optional<GLuint> readFramebuffer;
+    std::array<std::optional<GLuint>, NUM_BUFFER_TARGETS> buffers;
+    std::array<std::array<std::optional<BufferRange>, MAX_INDEXED_BINDINGS>, NUM_INDEXED_TARGETS> bufferRanges;
+    std::array<std::optional<bool>, NUM_CAPABILITIES> capabilities;
+    std::optional<GLenum> depthFunc;
+    std::optional<bool> depthMask;
+    std::optional<std::array<GLenum, 2>> blendFunc;
+    std::optional<GLenum> cullFace;
+    std::optional<std::array<GLint, 4>> viewport;
+    std::optional<std::array<GLfloat, 4>> clearColor;
+
+    GLStateStats stats;
+
+    GLState() = default;
+
+    template <typename T, typename Fn>
+    auto Apply(std::optional<T>& shadow, const T& value, Fn&& issue) noexcept -> void {
+        if (shadow == value) {
+            ++stats.elided;
+            return;
+        }
+
+        shadow = value;
+        ++stats.issued;
+        issue();
+    }
+
+    auto Forward() noexcept -> void { ++stats.issued; }
+
+public:
+    [[nodiscard]] static auto GetInstance() noexcept -> GLState&;
+
+    auto UseProgram(GLuint newProgram) noexcept -> void;
+    auto BindVertexArray(GLuint newVao) noexcept -> void;
+    auto BindBuffer(GLenum target, GLuint buffer) noexcept -> void;
+    auto BindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) noexcept -> void;
+    auto BindFramebuffer(GLenum target, GLuint framebuffer) noexcept -> void;
+
+    auto Enable(GLenum capability) noexcept -> void;
+    auto Disable(GLenum capability) noexcept -> void;
+    auto DepthFunc(GLenum func) noexcept -> void;
+    auto DepthMask(bool enabled) noexcept -> void;
+    auto BlendFunc(GLenum source, GLenum destination) noexcept -> void;
+    auto CullFace(GLenum mode) noexcept -> void;
+    auto Viewport(GLint x, GLint y, GLsizei width, GLsizei height) noexcept -> void;
+    auto ClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) noexcept -> void;
+
+    // Owners report deletions so a reused name is never mistaken for an existing binding
+    auto ProgramDeleted(GLuint deletedProgram) noexcept -> void;
+    auto VertexArrayDeleted(GLuint deletedVao) noexcept -> void;
+    auto BufferDeleted(GLuint deletedBuffer) noexcept -> void;
+    auto FramebufferDeleted(GLuint deletedFramebuffer) noexcept -> void;
+
+    // Forgets everything, for after code that touches GL behind the cache's back
+    auto Invalidate() noexcept -> void;
+
+    [[nodiscard]] auto GetStats() const noexcept -> const GLStateStats& { return stats; }
+    auto ResetStats() noexcept -> void { stats = GLStateStats{}; }
+};
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <functional>
+
+// Work that must run on the thread owning the GL context
+using GLTask = std::move_only_function<void()>;
+
+struct GLExecutor {
+    virtual ~GLExecutor() = default;
+
+    // Runs before the next submitted frame is drawn, in the order deferred
+    virtual auto Defer(GLTask task) -> void = 0;
+
+    // Blocks the caller until the task has run
+    virtual auto RunSync(GLTask task) -> void = 0;
+};
+
+// Runs everything immediately, for when the calling thread already owns the context
+struct InlineGLExecutor final : GLExecutor {
+    [[nodiscard]] static auto GetInstance() noexcept -> InlineGLExecutor& {
+        static InlineGLExecutor executor{};
+        return executor;
+    }
+
+    auto Defer(GLTask task) -> void override { task(); }
+    auto RunSync(GLTask task) -> void override { task(); }
+};
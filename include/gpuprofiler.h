@@ -0,0 +1,118 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Running CPU and GPU times for one named pass, in milliseconds
+struct PassStats {
+    std::string name;
+    double lastCpuMs = 0.0;
+    double lastGpuMs = 0.0;
+    double totalCpuMs = 0.0;
+    double totalGpuMs = 0.0;
+    std::size_t numCpuSamples = 0U;
+    std::size_t numGpuSamples = 0U;
+
+    auto AddCpu(double ms) noexcept -> void {
+        lastCpuMs = ms;
+        totalCpuMs += ms;
+        ++numCpuSamples;
+    }
+
+    auto AddGpu(double ms) noexcept -> void {
+        lastGpuMs = ms;
+        totalGpuMs += ms;
+        ++numGpuSamples;
+    }
+
+    [[nodiscard]] auto AverageCpuMs() const noexcept -> double { return numCpuSamples == 0U ? 0.0 : totalCpuMs / static_cast<double>(numCpuSamples); }
+    [[nodiscard]] auto AverageGpuMs() const noexcept -> double { return numGpuSamples == 0U ? 0.0 : totalGpuMs / static_cast<double>(numGpuSamples); }
+
+    auto ResetTotals() noexcept -> void {
+        totalCpuMs = 0.0;
+        totalGpuMs = 0.0;
+        numCpuSamples = 0U;
+        numGpuSamples = 0U;
+    }
+};
+
+// Brackets passes with timestamp queries and reads them back LATENCY frames later, so timing never stalls the pipeline
+class GpuProfiler {
+public:
+    static constexpr auto LATENCY = std::size_t{4U};
+    static constexpr auto SUMMARY_INTERVAL = std::chrono::seconds{5};
+    static constexpr auto FRAME_PASS = std::string_view{"Frame"};
+
+    using PassToken = std::size_t;
+
+    class ScopedPass {
+        GpuProfiler& profiler;
+        PassToken token;
+
+    public:
+        [[nodiscard]] ScopedPass(GpuProfiler& profiler, std::string_view name) : profiler{profiler}, token{profiler.BeginPass(name)} {}
+        ~ScopedPass() noexcept { profiler.EndPass(token); }
+
+        ScopedPass(const ScopedPass& other) = delete;
+        ScopedPass& operator=(const ScopedPass& other) = delete;
+    };
+
+private:
+    struct PendingPass {
+        std::size_t passIndex;
+        GLuint beginQuery;
+        GLuint endQuery;
+        std::chrono::steady_clock::time_point cpuStart;
+        bool ended;
+    };
+
+    struct FrameSlot {
+        std::vector<PendingPass> pending;
+        std::vector<GLuint> queries;
+        std::size_t numQueriesUsed = 0U;
+    };
+
+    std::array<FrameSlot, LATENCY> slots;
+    std::vector<PassStats> passes;
+    std::size_t frame = 0U;
+    std::size_t numDropped = 0U;
+    PassToken framePass = 0U;
+    std::chrono::steady_clock::time_point lastSummary = std::chrono::steady_clock::now();
+
+    [[nodiscard]] auto CurrentSlot() noexcept -> FrameSlot& { return slots[frame % LATENCY]; }
+    [[nodiscard]] auto AcquireQuery(FrameSlot& slot) -> GLuint;
+    [[nodiscard]] auto FindOrAddPass(std::string_view name) -> std::size_t;
+    auto Collect(FrameSlot& slot) -> void;
+
+public:
+    [[nodiscard]] GpuProfiler() = default;
+    ~GpuProfiler() noexcept;
+
+    GpuProfiler(const GpuProfiler& other) = delete;
+    GpuProfiler& operator=(const GpuProfiler& other) = delete;
+    GpuProfiler(GpuProfiler&& other) = delete;
+    GpuProfiler& operator=(GpuProfiler&& other) = delete;
+
+    // Frames are timed as a pass of their own, named FRAME_PASS
+    auto BeginFrame() -> void;
+    auto EndFrame() -> void;
+
+    [[nodiscard]] auto BeginPass(std::string_view name) -> PassToken;
+    auto EndPass(PassToken token) noexcept -> void;
+    [[nodiscard]] auto Scope(std::string_view name) -> ScopedPass { return ScopedPass{*this, name}; }
+
+    [[nodiscard]] auto GetPasses() const noexcept -> std::span<const PassStats> { return passes; }
+
+    // Passes whose GPU results were still unavailable when their queries were reused
+    [[nodiscard]] auto NumDropped() const noexcept -> std::size_t { return numDropped; }
+
+    // Logs averages since the previous summary and starts a new window
+    auto LogSummary() noexcept -> void;
+};
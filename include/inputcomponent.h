@@ -1,10 +1,20 @@
 #pragma once
+#include "cpuprofiler.h"
 #include "debugutils.h"
+#include "inputevent.h"
+#include "inputrecording.h"
+#include "spscring.h"
 
 #define GLFW_INCLUDE_NONE
 #include <GLFW/glfw3.h>
 
+#include <algorithm>
 #include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
 
 struct InputComponent {
     virtual inline void OnAttach() noexcept {}
@@ -13,8 +23,22 @@ struct InputComponent {
     virtual inline void MousePosCallback([[maybe_unused]] double xPos, [[maybe_unused]] double yPos) noexcept {}
     virtual inline void MouseBtnCallback([[maybe_unused]] int button, [[maybe_unused]] int action, [[maybe_unused]] int mods) noexcept {}
     virtual inline void MouseScrollCallback([[maybe_unused]] double xScroll, [[maybe_unused]] double yScroll) noexcept {}
+
+    // Called once per frame with everything queued since the last one, override to handle the batch directly
+    virtual inline void OnEvents(std::span<const InputEvent> events) noexcept {
+        for (const auto& event : events) {
+            switch (event.type) {
+            case InputEventType::Key: KeyCallback(event.key.key, event.key.scancode, event.key.action, event.key.mods); break;
+            case InputEventType::Char: CharCallback(event.character.codePoint); break;
+            case InputEventType::MouseMove: MousePosCallback(event.mouseMove.x, event.mouseMove.y); break;
+            case InputEventType::MouseButton: MouseBtnCallback(event.mouseButton.button, event.mouseButton.action, event.mouseButton.mods); break;
+            case InputEventType::Scroll: MouseScrollCallback(event.scroll.x, event.scroll.y); break;
+            }
+        }
+    }
 };
 
+// Window callbacks only copy events into a ring, subscribers see them in one batch when Update drains it
 struct GLFWInputAdapter {
     using KeyCallbackFn = GLFWkeyfun;    
     using CharCallbackFn = GLFWcharfun;
@@ -22,9 +46,15 @@ struct GLFWInputAdapter {
     using MouseBtnCallbackFn = GLFWmousebuttonfun;
     using MouseScrollCallbackFn = GLFWscrollfun;
 
+    static constexpr auto EVENT_RING_CAPACITY = std::size_t{1'024U};
+
 private:
-    InputComponent* currentComponent;
-    GLFWwindow* window;
+    SpscRing<InputEvent, EVENT_RING_CAPACITY> events;
+    std::vector<InputComponent*> subscribers;
+    std::vector<InputEvent> frameEvents;
+    bool coalesceEvents = true;
+    InputRecorder* recorder = nullptr;
+    GLFWwindow* window = nullptr;
 
     [[nodiscard]] GLFWInputAdapter() noexcept = default;
 
@@ -33,10 +63,21 @@ private:
     GLFWInputAdapter(GLFWInputAdapter&&) = delete;
     auto operator=(GLFWInputAdapter&&) -> GLFWInputAdapter& = delete;
 
+    static inline void Push(const InputEvent& event) noexcept { GetInstance().events.TryPush(event); }
+
 public:
     static auto Initialize(GLFWwindow* window) noexcept -> GLFWInputAdapter& {
         auto& adapter = GetInstance();
         adapter.window = window;
+        // A drain never yields more than a full ring, so dispatch never allocates
+        adapter.frameEvents.reserve(EVENT_RING_CAPACITY);
+
+        glfwSetKeyCallback(window, static_cast<KeyCallbackFn>([](auto*, int key, int scancode, int action, int mods) { Push(InputEvent::Key(key, scancode, action, mods)); }));
+        glfwSetCharCallback(window, static_cast<CharCallbackFn>([](auto*, unsigned int codePoint) { Push(InputEvent::Char(codePoint)); }));
+        glfwSetCursorPosCallback(window, static_cast<MousePosCallbackFn>([](auto*, double xPos, double yPos) { Push(InputEvent::MouseMove(xPos, yPos)); }));
+        glfwSetMouseButtonCallback(window, static_cast<MouseBtnCallbackFn>([](auto*, int button, int action, int mods) { Push(InputEvent::MouseButton(button, action, mods)); }));
+        glfwSetScrollCallback(window, static_cast<MouseScrollCallbackFn>([](auto*, double xScroll, double yScroll) { Push(InputEvent::Scroll(xScroll, yScroll)); }));
+
         return adapter;
     }
 
@@ -45,21 +86,74 @@ public:
         return adapter;
     }
 
+    // Adds a subscriber, components registered earlier keep receiving events
     inline void RegisterInputComponent(InputComponent& component) {
         if (window == nullptr) ThrowMessage("ERROR", "Trying to register input with no window set");
+        if (std::ranges::find(subscribers, &component) != subscribers.end()) return;
+
+        subscribers.push_back(&component);
+        component.OnAttach();
+    }
+
+    inline void UnregisterInputComponent(InputComponent& component) noexcept { std::erase(subscribers, &component); }
+
+    // Mouse moves and scrolls arriving back to back are merged before dispatch unless disabled
+    inline void SetCoalesceEvents(bool enabled) noexcept { coalesceEvents = enabled; }
+
+    // Every update's dispatched events are appended to the recorder until this is called with nullptr
+    inline void SetRecorder(InputRecorder* inputRecorder) noexcept { recorder = inputRecorder; }
+
+    inline void Update() {
+        auto zone = ProfileZone{"Input::Update"};
+        glfwPollEvents();
 
-        currentComponent = &component;
+        frameEvents.clear();
+        events.Drain([&](const InputEvent& event) { frameEvents.push_back(event); });
+        if (coalesceEvents) CoalesceInputEvents(frameEvents);
+        if (recorder != nullptr) recorder->RecordFrame(frameEvents);
 
+        if (frameEvents.empty()) return;
+        for (auto* subscriber : subscribers) subscriber->OnEvents(frameEvents);
+    }
+
+    // This frame's events, for systems that read input without subscribing
+    [[nodiscard]] inline auto Events() const noexcept -> std::span<const InputEvent> { return frameEvents; }
+    [[nodiscard]] inline auto NumDropped() const noexcept -> std::size_t { return events.NumDropped(); }
+};
+
+// Feeds a recording to subscribers one frame per update, so a replayed session needs no window
+class ReplayInputAdapter {
+    InputRecording recording;
+    std::size_t nextRecorded = 0U;
+    std::uint32_t frame = 0U;
+    std::vector<InputComponent*> subscribers;
+    std::span<const InputEvent> frameEvents;
+
+public:
+    [[nodiscard]] explicit ReplayInputAdapter(InputRecording recording) noexcept : recording{std::move(recording)} {}
+
+    inline void RegisterInputComponent(InputComponent& component) {
+        if (std::ranges::find(subscribers, &component) != subscribers.end()) return;
+
+        subscribers.push_back(&component);
         component.OnAttach();
+    }
+
+    inline void UnregisterInputComponent(InputComponent& component) noexcept { std::erase(subscribers, &component); }
+
+    inline void Update() noexcept {
+        frameEvents = {};
+        if (nextRecorded < recording.frames.size() && recording.frames[nextRecorded].frame == frame) {
+            frameEvents = recording.frames[nextRecorded++].events;
+        }
+        ++frame;
 
-        glfwSetKeyCallback(window, static_cast<KeyCallbackFn>([](auto*, int key, int scancode, int action, int mods) { GetInstance().currentComponent->KeyCallback(key, scancode, action, mods); }));
-        glfwSetCharCallback(window, static_cast<CharCallbackFn>([](auto*, unsigned int codePoint) { GetInstance().currentComponent->CharCallback(codePoint); }));
-        glfwSetCursorPosCallback(window, static_cast<MousePosCallbackFn>([](auto*, double xPos, double yPos) { GetInstance().currentComponent->MousePosCallback(xPos, yPos); }));
-        glfwSetMouseButtonCallback(window, static_cast<MouseBtnCallbackFn>([](auto*, int button, int action, int mods) { GetInstance().currentComponent->MouseBtnCallback(button, action, mods); }));
-        glfwSetScrollCallback(window, static_cast<MouseScrollCallbackFn>([](auto*, double xScroll, double yScroll) { GetInstance().currentComponent->MouseScrollCallback(xScroll, yScroll); }));
+        if (frameEvents.empty()) return;
+        for (auto* subscriber : subscribers) subscriber->OnEvents(frameEvents);
     }
 
-    inline void Update() noexcept { glfwPollEvents(); }
+    [[nodiscard]] inline auto Events() const noexcept -> std::span<const InputEvent> { return frameEvents; }
+    [[nodiscard]] inline auto Finished() const noexcept -> bool { return frame >= recording.numFrames; }
 };
 
 template <typename InputAdapter>
@@ -67,7 +161,9 @@ struct InputSystem {
     InputAdapter& adapter;
 
     inline void RegisterInputComponent(InputComponent& component) { adapter.RegisterInputComponent(component); }
-    inline void Update() noexcept { adapter.Update(); }
+    inline void UnregisterInputComponent(InputComponent& component) noexcept { adapter.UnregisterInputComponent(component); }
+    inline void Update() { adapter.Update(); }
+    [[nodiscard]] inline auto Events() const noexcept -> std::span<const InputEvent> { return adapter.Events(); }
 };
 
 struct DebugInputComponent : public InputComponent {
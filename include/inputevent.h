@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+enum class InputEventType : std::uint8_t {
+    Key = 0U,
+    Char = 1U,
+    MouseMove = 2U,
+    MouseButton = 3U,
+    Scroll = 4U
+};
+
+struct KeyEvent {
+    int key;
+    int scancode;
+    int action;
+    int mods;
+};
+
+struct CharEvent {
+    unsigned int codePoint;
+};
+
+struct MouseMoveEvent {
+    double x;
+    double y;
+};
+
+struct MouseButtonEvent {
+    int button;
+    int action;
+    int mods;
+};
+
+struct ScrollEvent {
+    double x;
+    double y;
+};
+
+// Plain data copied out of the window callbacks, only the member named by type is meaningful
+struct InputEvent {
+    InputEventType type;
+    union {
+        KeyEvent key;
+        CharEvent character;
+        MouseMoveEvent mouseMove;
+        MouseButtonEvent mouseButton;
+        ScrollEvent scroll;
+    };
+
+    [[nodiscard]] static auto Key(int key, int scancode, int action, int mods) noexcept -> InputEvent;
+    [[nodiscard]] static auto Char(unsigned int codePoint) noexcept -> InputEvent;
+    [[nodiscard]] static auto MouseMove(double x, double y) noexcept -> InputEvent;
+    [[nodiscard]] static auto MouseButton(int button, int action, int mods) noexcept -> InputEvent;
+    [[nodiscard]] static auto Scroll(double x, double y) noexcept -> InputEvent;
+};
+
+// Collapses each run of consecutive mouse moves into its last position and sums consecutive scrolls,
+// events of other types keep their order relative to everything else
+auto CoalesceInputEvents(std::vector<InputEvent>& events) noexcept -> void;
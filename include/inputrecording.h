@@ -0,0 +1,48 @@
+#pragma once
+
+#include "inputevent.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <iosfwd>
+#include <optional>
+#include <span>
+#include <vector>
+
+struct RecordedFrame {
+    // Index of the input update the events were dispatched on, frames without input are not stored
+    std::uint32_t frame;
+    // Seconds since the first recorded update
+    double time;
+    std::vector<InputEvent> events;
+};
+
+// Binary layout is a magic and version header followed by frames, each event stores only its active member
+struct InputRecording {
+    static constexpr auto MAGIC = std::uint32_t{0x49594B53U}; // "SKYI"
+    static constexpr auto VERSION = std::uint32_t{1U};
+
+    std::vector<RecordedFrame> frames;
+    // Total updates recorded, including trailing ones without input
+    std::uint32_t numFrames = 0U;
+
+    auto Write(std::ostream& output) const -> void;
+    auto Save(const std::filesystem::path& filePath) const -> void;
+
+    [[nodiscard]] static auto Read(std::istream& input) -> InputRecording;
+    [[nodiscard]] static auto Load(const std::filesystem::path& filePath) -> InputRecording;
+};
+
+class InputRecorder {
+    InputRecording recording;
+    std::optional<std::chrono::steady_clock::time_point> start;
+
+public:
+    // Call once per input update with the events that were dispatched on it
+    auto RecordFrame(std::span<const InputEvent> events) -> void;
+
+    [[nodiscard]] auto GetRecording() const noexcept -> const InputRecording& { return recording; }
+    [[nodiscard]] auto NumFrames() const noexcept -> std::size_t { return recording.numFrames; }
+};
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+using JobTask = std::move_only_function<void()>;
+
+enum class JobAffinity : std::uint8_t {
+    // Runs on whichever worker gets to it first
+    Any,
+    // Waits for the main thread to pump it, for work touching the ECS or resources owned there
+    MainThread
+};
+
+struct JobState;
+struct ParallelBatch;
+
+// Shared completion state of a submitted job, a default handle counts as already done
+class JobHandle {
+    friend class JobSystem;
+
+    std::shared_ptr<JobState> state;
+
+    explicit JobHandle(std::shared_ptr<JobState> state) noexcept : state{std::move(state)} {}
+
+public:
+    JobHandle() noexcept = default;
+
+    [[nodiscard]] auto IsDone() const noexcept -> bool;
+};
+
+// Work-stealing pool shared by loading, culling and scene maintenance. Each worker owns a deque it pushes to and pops
+// from the back of, idle workers steal from the front of the others. Threads that are not workers share one more deque
+class JobSystem {
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<std::shared_ptr<JobState>> jobs;
+    };
+
+    std::thread::id mainThread;
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+
+    std::mutex mainThreadMutex;
+    std::deque<std::shared_ptr<JobState>> mainThreadJobs;
+
+    // ParallelFor batches live on their callers' stacks and are listed here while idle workers may join them
+    mutable std::mutex batchMutex;
+    std::vector<ParallelBatch*> openBatches;
+
+    std::mutex sleepMutex;
+    std::condition_variable_any workReady;
+    std::atomic<std::size_t> numQueued{0U};
+
+    std::vector<std::jthread> workers;
+
+    using RangeTask = std::move_only_function<void(std::size_t begin, std::size_t end)>;
+
+    [[nodiscard]] auto CurrentQueue() const noexcept -> std::size_t;
+    auto RunParallelFor(std::size_t count, std::size_t grainSize, RangeTask body) -> void;
+    auto Schedule(std::shared_ptr<JobState> job) -> void;
+    auto Release(std::shared_ptr<JobState> job) -> void;
+    auto Run(const std::shared_ptr<JobState>& job) -> void;
+    [[nodiscard]] auto TryRunOne(std::size_t queue) -> bool;
+    [[nodiscard]] auto TryRunMainThreadJob() -> bool;
+    [[nodiscard]] auto HasBatchWork() const -> bool;
+    [[nodiscard]] auto TryHelpBatch() -> bool;
+    auto WorkerLoop(std::stop_token stopToken, std::size_t queue) -> void;
+
+public:
+    [[nodiscard]] static auto DefaultThreadCount() noexcept -> unsigned int;
+
+    // The constructing thread is the main thread. With no workers every job runs on whoever waits for it
+    [[nodiscard]] explicit JobSystem(unsigned int numWorkers = DefaultThreadCount());
+    // Jobs already queued are finished before the workers exit
+    ~JobSystem() noexcept;
+
+    JobSystem(const JobSystem&) = delete;
+    auto operator=(const JobSystem&) -> JobSystem& = delete;
+    JobSystem(JobSystem&&) = delete;
+    auto operator=(JobSystem&&) -> JobSystem& = delete;
+
+    // Shared by the whole program, first used from the main thread
+    [[nodiscard]] static auto GetInstance() -> JobSystem&;
+
+    // The task is held back until every dependency is done
+    auto Submit(JobTask task, std::span<const JobHandle> dependencies = {}, JobAffinity affinity = JobAffinity::Any) -> JobHandle;
+
+    // Runs other queued jobs instead of sleeping, but never main-thread jobs. Those only run from RunMainThreadJobs,
+    // so the main thread can't wait on them and workers must not wait on them while the main thread waits on workers
+    auto Wait(const JobHandle& handle) -> void;
+    auto WaitAll(std::span<const JobHandle> handles) -> void;
+
+    // Must be called on the main thread, always runs at least one job when any is ready to guarantee progress
+    auto RunMainThreadJobs(std::chrono::microseconds budget) -> std::size_t;
+
+    // Splits [0, count) into chunks of grainSize calls to fn(begin, end) and returns once all are done. The calling thread
+    // works through chunks too but never picks up unrelated jobs, so it can't be held up by them. The first exception a
+    // chunk throws is rethrown here once every chunk has finished. Nothing is allocated, idle workers join the batch
+    // directly instead of through submitted jobs
+    template <typename Fn>
+    auto ParallelFor(std::size_t count, std::size_t grainSize, Fn&& fn) -> void {
+        RunParallelFor(count, grainSize, [&fn](std::size_t begin, std::size_t end) { fn(begin, end); });
+    }
+
+    [[nodiscard]] auto NumWorkers() const noexcept -> std::size_t { return workers.size(); }
+    [[nodiscard]] auto IsMainThread() const noexcept -> bool { return std::this_thread::get_id() == mainThread; }
+};
@@ -0,0 +1,230 @@
+#pragma once
+
+#include "spscring.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+enum class LogLevel : std::uint8_t {
+    Info = 0U,
+    Warn = 1U,
+    Error = 2U,
+    Crash = 3U,
+    // Only meaningful as a filter, silences everything
+    Off = 4U
+};
+
+// Unknown names log as errors so a typo never hides a message
+[[nodiscard]] auto ParseLogLevel(std::string_view name) noexcept -> LogLevel;
+[[nodiscard]] auto LogLevelName(LogLevel level) noexcept -> std::string_view;
+
+// Arguments are kept in binary and only formatted on the logger thread, strings are copied and may be truncated
+struct LogRecord {
+    static constexpr auto PAYLOAD_SIZE = std::size_t{192U};
+
+    using FormatFn = auto (*)(const LogRecord& record, std::string& output) -> void;
+
+    FormatFn format = nullptr;
+    std::string_view formatString;
+    std::chrono::steady_clock::time_point time;
+    // Messages from the same call site dropped by rate limiting just before this one
+    std::uint32_t numSuppressed = 0U;
+    std::uint16_t payloadSize = 0U;
+    LogLevel level = LogLevel::Info;
+    std::array<std::byte, PAYLOAD_SIZE> payload;
+};
+
+// Arithmetic values are stored as is, anything viewable as a string as a length and its characters,
+// and any other formattable type is formatted on the calling thread and stored as a string
+template <typename T>
+using LogStoredType = std::conditional_t<std::is_arithmetic_v<std::remove_cvref_t<T>>, std::remove_cvref_t<T>, std::string_view>;
+
+class LogPayloadWriter {
+    LogRecord& record;
+
+    auto WriteString(std::string_view value) noexcept -> void {
+        const auto room = LogRecord::PAYLOAD_SIZE - record.payloadSize;
+        if (room < sizeof(std::uint16_t)) return;
+
+        const auto length = static_cast<std::uint16_t>(std::min(value.size(), room - sizeof(std::uint16_t)));
+        std::memcpy(record.payload.data() + record.payloadSize, &length, sizeof(length));
+        std::memcpy(record.payload.data() + record.payloadSize + sizeof(length), value.data(), length);
+        record.payloadSize = static_cast<std::uint16_t>(record.payloadSize + sizeof(length) + length);
+    }
+
+public:
+    [[nodiscard]] explicit LogPayloadWriter(LogRecord& record) noexcept : record{record} {}
+
+    template <typename T>
+    auto Write(const T& value) -> void {
+        using Stored = LogStoredType<T>;
+        if constexpr (std::is_arithmetic_v<Stored>) {
+            if (LogRecord::PAYLOAD_SIZE - record.payloadSize < sizeof(Stored)) return;
+            std::memcpy(record.payload.data() + record.payloadSize, &value, sizeof(Stored));
+            record.payloadSize = static_cast<std::uint16_t>(record.payloadSize + sizeof(Stored));
+        } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+            WriteString(std::string_view(value));
+        } else {
+            WriteString(std::format("{}", value));
+        }
+    }
+};
+
+class LogPayloadReader {
+    const LogRecord& record;
+    std::size_t offset = 0U;
+
+public:
+    [[nodiscard]] explicit LogPayloadReader(const LogRecord& record) noexcept : record{record} {}
+
+    // Values the writer ran out of room for read back as zero or empty
+    template <typename Stored>
+    [[nodiscard]] auto Read() noexcept -> Stored {
+        if constexpr (std::is_arithmetic_v<Stored>) {
+            auto value = Stored{};
+            if (offset + sizeof(Stored) > record.payloadSize) return value;
+            std::memcpy(&value, record.payload.data() + offset, sizeof(Stored));
+            offset += sizeof(Stored);
+            return value;
+        } else {
+            auto length = std::uint16_t{0U};
+            if (offset + sizeof(length) > record.payloadSize) return {};
+            std::memcpy(&length, record.payload.data() + offset, sizeof(length));
+            const auto* characters = reinterpret_cast<const char*>(record.payload.data() + offset + sizeof(length)); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+            offset += sizeof(length) + length;
+            return std::string_view(characters, length);
+        }
+    }
+};
+
+class Logger {
+public:
+    static constexpr auto THREAD_BUFFER_RECORDS = std::size_t{512U};
+    static constexpr auto FLUSH_INTERVAL = std::chrono::milliseconds{5};
+    // Each call site may log this many messages per window, the rest are counted and reported with the next one
+    static constexpr auto RATE_LIMIT_MESSAGES = std::uint32_t{16U};
+    static constexpr auto RATE_LIMIT_WINDOW = std::chrono::seconds{1};
+
+#ifndef NDEBUG
+    static constexpr auto DEFAULT_LEVEL = LogLevel::Info;
+#else
+    static constexpr auto DEFAULT_LEVEL = LogLevel::Warn;
+#endif
+
+    using Sink = std::function<void(LogLevel level, std::string_view line)>;
+
+private:
+    struct ThreadBuffer {
+        SpscRing<LogRecord, THREAD_BUFFER_RECORDS> records;
+        std::size_t numDroppedReported = 0U;
+    };
+
+    struct RateLimit {
+        std::chrono::steady_clock::time_point windowStart;
+        std::uint32_t numLogged = 0U;
+        std::uint32_t numSuppressed = 0U;
+    };
+
+    std::atomic<LogLevel> level{DEFAULT_LEVEL};
+    std::atomic<bool> rateLimiting{true};
+
+    mutable std::mutex buffersMutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+
+    std::mutex sinkMutex;
+    Sink sink;
+
+    std::mutex flushMutex;
+    std::condition_variable_any flushRequested;
+    std::condition_variable_any flushed;
+    std::uint64_t flushRequests = 0U;
+    std::uint64_t flushesDone = 0U;
+
+    std::jthread worker;
+
+    [[nodiscard]] Logger();
+
+    [[nodiscard]] auto GetThreadBuffer() -> ThreadBuffer&;
+    [[nodiscard]] static auto GetRateLimit(const void* site) -> RateLimit&;
+
+    // Returns false when the site is over its budget, otherwise the number of messages skipped before this one
+    [[nodiscard]] auto PassRateLimit(const void* site, std::chrono::steady_clock::time_point now, std::uint32_t& numSuppressed) -> bool;
+    auto Submit(const LogRecord& record) -> void;
+    // Scratch is passed in and kept by the worker, so a drain with nothing to write allocates nothing
+    auto Drain(std::vector<std::shared_ptr<ThreadBuffer>>& snapshot, std::vector<LogRecord>& batch, std::string& line) -> void;
+    auto WorkerLoop(std::stop_token stopToken) -> void;
+
+    template <typename... Args>
+    static auto FormatRecord(const LogRecord& record, std::string& output) -> void {
+        auto reader = LogPayloadReader{record};
+        // Braced initialisation reads the arguments in order
+        auto values = std::tuple<LogStoredType<Args>...>{reader.template Read<LogStoredType<Args>>()...};
+        const auto start = output.size();
+        try {
+            std::apply([&](auto&... value) { std::vformat_to(std::back_inserter(output), record.formatString, std::make_format_args(value...)); }, values);
+        } catch (const std::format_error&) {
+            // A spec meant for a type that was stored as a string, the raw format string is still useful
+            output.resize(start);
+            output += record.formatString;
+        }
+    }
+
+public:
+    ~Logger() noexcept;
+
+    Logger(const Logger&) = delete;
+    auto operator=(const Logger&) -> Logger& = delete;
+    Logger(Logger&&) = delete;
+    auto operator=(Logger&&) -> Logger& = delete;
+
+    [[nodiscard]] static auto GetInstance() -> Logger&;
+
+    auto SetLevel(LogLevel minimum) noexcept -> void { level.store(minimum, std::memory_order_relaxed); }
+    [[nodiscard]] auto GetLevel() const noexcept -> LogLevel { return level.load(std::memory_order_relaxed); }
+    [[nodiscard]] auto IsEnabled(LogLevel messageLevel) const noexcept -> bool { return messageLevel >= GetLevel() && messageLevel != LogLevel::Off; }
+    auto SetRateLimiting(bool enabled) noexcept -> void { rateLimiting.store(enabled, std::memory_order_relaxed); }
+
+    // Lines go to stdout unless a sink is set, an empty sink restores stdout
+    auto SetSink(Sink newSink) -> void;
+
+    // Blocks until everything logged before the call has reached the sink
+    auto Flush() -> void;
+
+    // Rate limited per site, which callers pass as the address of their format string, a null site is never limited.
+    // The format string must outlive the logger, in practice it is a literal
+    template <typename... Args>
+    auto Log(LogLevel messageLevel, const void* site, std::string_view formatString, const Args&... args) noexcept -> void {
+        if (!IsEnabled(messageLevel)) return;
+
+        auto record = LogRecord{};
+        record.time = std::chrono::steady_clock::now();
+        if (!PassRateLimit(site, record.time, record.numSuppressed)) return;
+
+        record.format = &FormatRecord<Args...>;
+        record.formatString = formatString;
+        record.level = messageLevel;
+        auto writer = LogPayloadWriter{record};
+        (writer.Write(args), ...);
+
+        Submit(record);
+        // Nothing is left queued when the process is about to go down
+        if (messageLevel == LogLevel::Crash) Flush();
+    }
+};
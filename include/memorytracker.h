@@ -0,0 +1,149 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <typeinfo>
+#include <vector>
+
+// Live bytes for one subsystem, updated from any thread
+class MemoryCounter {
+    std::atomic<std::int64_t> bytes{0};
+    std::atomic<std::int64_t> highWater{0};
+    std::atomic<std::uint64_t> numAllocations{0U};
+
+public:
+    auto Add(std::size_t size) noexcept -> void {
+        numAllocations.fetch_add(1U, std::memory_order_relaxed);
+        const auto now = bytes.fetch_add(static_cast<std::int64_t>(size), std::memory_order_relaxed) + static_cast<std::int64_t>(size);
+        auto peak = highWater.load(std::memory_order_relaxed);
+        while (now > peak && !highWater.compare_exchange_weak(peak, now, std::memory_order_relaxed)) {}
+    }
+
+    auto Remove(std::size_t size) noexcept -> void {
+        bytes.fetch_sub(static_cast<std::int64_t>(size), std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] auto Bytes() const noexcept -> std::int64_t { return bytes.load(std::memory_order_relaxed); }
+    [[nodiscard]] auto HighWater() const noexcept -> std::int64_t { return highWater.load(std::memory_order_relaxed); }
+    [[nodiscard]] auto NumAllocations() const noexcept -> std::uint64_t { return numAllocations.load(std::memory_order_relaxed); }
+};
+
+struct MemoryCounterSnapshot {
+    std::string name;
+    std::int64_t bytes = 0;
+    std::int64_t highWater = 0;
+    std::uint64_t numAllocations = 0U;
+};
+
+// Registry of named counters, names group by their prefix up to the first '/', e.g. "GPU/Render targets"
+class MemoryTracker {
+    mutable std::mutex countersMutex;
+    std::map<std::string, std::unique_ptr<MemoryCounter>, std::less<>> counters;
+
+    [[nodiscard]] MemoryTracker() = default;
+
+public:
+    MemoryTracker(const MemoryTracker&) = delete;
+    auto operator=(const MemoryTracker&) -> MemoryTracker& = delete;
+    MemoryTracker(MemoryTracker&&) = delete;
+    auto operator=(MemoryTracker&&) -> MemoryTracker& = delete;
+
+    [[nodiscard]] static auto GetInstance() -> MemoryTracker&;
+
+    // Counters are never removed, so callers may keep the reference, typically in a function-local static
+    [[nodiscard]] auto GetCounter(std::string_view name) -> MemoryCounter&;
+
+    // Sorted by name
+    [[nodiscard]] auto Snapshot() const -> std::vector<MemoryCounterSnapshot>;
+    // One line per counter with current and peak usage
+    [[nodiscard]] auto Report() const -> std::string;
+};
+
+// Human readable byte count, e.g. "1.50 MiB"
+[[nodiscard]] auto FormatBytes(std::int64_t bytes) -> std::string;
+
+// Demangled where the platform allows, used to label per-component-type counters
+[[nodiscard]] auto DemangleTypeName(const char* name) -> std::string;
+
+template <typename T>
+[[nodiscard]] auto TypeName() -> std::string {
+    return DemangleTypeName(typeid(T).name());
+}
+
+// Standard allocator that reports every allocation to the counter Tag::Counter() returns.
+// Stateless, so containers using it keep their usual move and swap behaviour
+template <typename T, typename Tag>
+struct TrackingAllocator {
+    using value_type = T;
+
+    [[nodiscard]] TrackingAllocator() noexcept = default;
+    template <typename U>
+    [[nodiscard]] explicit(false) TrackingAllocator([[maybe_unused]] const TrackingAllocator<U, Tag>& other) noexcept {}
+
+    [[nodiscard]] auto allocate(std::size_t n) -> T* {
+        auto* pointer = std::allocator<T>{}.allocate(n);
+        Tag::Counter().Add(n * sizeof(T));
+        return pointer;
+    }
+
+    auto deallocate(T* pointer, std::size_t n) noexcept -> void {
+        Tag::Counter().Remove(n * sizeof(T));
+        std::allocator<T>{}.deallocate(pointer, n);
+    }
+
+    template <typename U>
+    [[nodiscard]] friend auto operator==([[maybe_unused]] const TrackingAllocator& lhs, [[maybe_unused]] const TrackingAllocator<U, Tag>& rhs) noexcept -> bool { return true; }
+};
+
+// Counter name usable as a template argument, e.g. NamedMemoryTag<"GPU/Render targets">
+template <std::size_t N>
+struct MemoryCounterName {
+    char value[N];
+
+    // NOLINTNEXTLINE(google-explicit-constructor) so string literals convert implicitly
+    consteval MemoryCounterName(const char (&name)[N]) noexcept { std::copy_n(name, N, value); }
+};
+
+// Tag for the counter with a fixed name, for TrackingAllocator or for counting by hand through Counter()
+template <MemoryCounterName Name>
+struct NamedMemoryTag {
+    [[nodiscard]] static auto Counter() -> MemoryCounter& {
+        static auto& counter = MemoryTracker::GetInstance().GetCounter(Name.value);
+        return counter;
+    }
+};
+
+// Every component manager of type T shares this counter, whichever ECS it belongs to
+template <typename T>
+struct ComponentMemoryTag {
+    [[nodiscard]] static auto Counter() -> MemoryCounter& {
+        static auto& counter = MemoryTracker::GetInstance().GetCounter("ECS/" + TypeName<T>());
+        return counter;
+    }
+};
+
+struct ComponentMemoryStats {
+    std::string name;
+    std::size_t numComponents = 0U;
+    std::size_t numBuckets = 0U;
+    float loadFactor = 0.0F;
+    // Shared by every manager of the same component type
+    std::int64_t bytes = 0;
+    std::int64_t highWater = 0;
+};
+
+struct EcsMemoryStats {
+    std::size_t numEntitySlots = 0U;
+    std::size_t numLiveEntities = 0U;
+    std::size_t entitySlotBytes = 0U;
+    std::vector<ComponentMemoryStats> components;
+
+    [[nodiscard]] auto Report() const -> std::string;
+};
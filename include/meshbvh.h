@@ -0,0 +1,57 @@
+#pragma once
+
+#include "bounds.h"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+struct MeshHit {
+    float distance;
+    // Index of the triangle in the mesh, i.e. its first vertex divided by three
+    std::uint32_t triangle;
+    // Weights of the triangle's second and third vertices at the hit
+    glm::vec2 barycentric;
+};
+
+// Triangle BVH in mesh space, immutable once built so every instance of a mesh can share it
+class MeshBvh {
+public:
+    static constexpr auto MAX_LEAF_TRIANGLES = std::uint32_t{4U};
+
+    // Depth-first layout, an internal node's first child directly follows it
+    struct Node {
+        glm::vec3 min;
+        // First triangle of a leaf, or the index of an internal node's second child
+        std::uint32_t offset;
+        glm::vec3 max;
+        // Zero for internal nodes
+        std::uint32_t count;
+
+        [[nodiscard]] auto IsLeaf() const noexcept -> bool { return count != 0U; }
+    };
+
+private:
+    std::vector<Node> nodes;
+    // Triangle corners in leaf order, three per triangle
+    std::vector<glm::vec3> corners;
+    std::vector<std::uint32_t> triangleIds;
+
+    struct BuildTriangle;
+    auto BuildNode(std::span<BuildTriangle> triangles) -> void;
+
+public:
+    // Corners are consecutive triples, as in Mesh::vertices
+    [[nodiscard]] static auto Build(std::span<const glm::vec3> triangleCorners) -> MeshBvh;
+
+    // Nearest hit on either side of a triangle, the direction needn't be normalised and distance is in its units
+    [[nodiscard]] auto Intersect(const Ray& ray, float maxDistance) const noexcept -> std::optional<MeshHit>;
+
+    [[nodiscard]] auto NumNodes() const noexcept -> std::size_t { return nodes.size(); }
+    [[nodiscard]] auto NumTriangles() const noexcept -> std::size_t { return triangleIds.size(); }
+    [[nodiscard]] auto GetNodes() const noexcept -> std::span<const Node> { return nodes; }
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "geometryarena.h"
+#include "meshcomponent.h"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Path keyed registry of uploaded meshes, entries expire once the last MeshComponent using them is gone
+class MeshCache {
+private:
+    GeometryArena& arena;
+    std::unordered_map<std::string, std::weak_ptr<const GpuMesh>> entries;
+
+public:
+    [[nodiscard]] explicit MeshCache(GeometryArena& arena) noexcept : arena{arena} {}
+
+    [[nodiscard]] auto GetArena() noexcept -> GeometryArena& { return arena; }
+
+    [[nodiscard]] static auto MakeKey(std::string_view filePath) -> std::string;
+
+    [[nodiscard]] auto Find(const std::string& key) const -> std::shared_ptr<const GpuMesh>;
+    auto Insert(const std::string& key, const Mesh& mesh) -> std::shared_ptr<const GpuMesh>;
+
+    // Synchronous parse and upload on a miss
+    [[nodiscard]] auto Load(std::string_view filePath) -> std::shared_ptr<const GpuMesh>;
+
+    auto Prune() -> std::size_t;
+
+    [[nodiscard]] auto NumEntries() const noexcept -> std::size_t { return entries.size(); }
+    [[nodiscard]] auto NumLive() const noexcept -> std::size_t;
+};
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "bounds.h"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+static constexpr auto DEFAULT_CLUSTER_TRIANGLES = std::size_t{128U};
+
+// Contiguous run of triangles in Mesh::vertices with its bounds and normal cone
+struct MeshCluster {
+    std::uint32_t firstVertex = 0U;
+    std::uint32_t numVertices = 0U;
+    BoundingSphere sphere;
+    glm::vec3 coneAxis{0.0F, 0.0F, 1.0F};
+    // Sine of the cone half-angle, clusters with a cutoff of 1 can never be backface culled
+    float coneCutoff = 1.0F;
+
+    [[nodiscard]] inline auto IsBackfacing(const glm::vec3& cameraPos) const noexcept -> bool {
+        if (coneCutoff >= 1.0F) return false;
+        const auto toCluster = sphere.center - cameraPos;
+        return glm::dot(toCluster, coneAxis) >= coneCutoff * glm::length(toCluster) + sphere.radius;
+    }
+};
@@ -1,6 +1,11 @@
 #pragma once
 
+#include "bounds.h"
 #include "debugutils.h"
+#include "geometryarena.h"
+#include "meshbvh.h"
+#include "meshcluster.h"
+#include "memorytracker.h"
 
 #include <glm/glm.hpp>
 #include <glad/glad.h>
@@ -15,85 +20,132 @@
 #include <cctype>
 #include <string_view>
 #include <charconv>
+#include <memory>
+#include <memory_resource>
+#include <optional>
 
 struct Vertex {
     glm::vec3 position;
     glm::vec3 normal;
 };
 
+// CPU-side vertex storage of every Mesh
+using MeshVertexMemoryTag = NamedMemoryTag<"CPU/Mesh vertices">;
+
 struct Mesh {
     using VertexId = std::uint32_t;
-
-    std::vector<Vertex> vertices;
-
-    [[nodiscard]] static auto ReadObj(const char* filePath) -> Mesh;
-    [[nodiscard]] static auto ReadObj(std::string_view inputStr) -> Mesh;
-    [[nodiscard]] static auto ReadObj(auto&& inputFile) -> Mesh {
+    using VertexBuffer = std::vector<Vertex, TrackingAllocator<Vertex, MeshVertexMemoryTag>>;
+
+    VertexBuffer vertices;
+    BoundingBox bounds;
+    BoundingSphere sphere;
+    std::vector<MeshCluster> clusters;
+    // Only built for meshes that need ray queries, shared with the GpuMesh made from this
+    std::shared_ptr<const MeshBvh> bvh;
+
+    [[nodiscard]] auto NumTriangles() const noexcept -> std::size_t { return vertices.size() / 3U; }
+
+    // Refreshes bounds and sphere from the vertex positions
+    auto ComputeBounds() noexcept -> void;
+
+    // Reorders triangles along a Morton curve and splits them into clusters for finer culling
+    auto BuildClusters(std::size_t maxTriangles = DEFAULT_CLUSTER_TRIANGLES) -> void;
+
+    // Builds a triangle BVH for picking over the current triangle order
+    auto BuildBvh() -> void;
+
+    // Zero-based indices from one "v//vn" or "v/vt/vn" face entry, the texture coordinate is ignored
+    struct ObjFaceVertex {
+        VertexId vertex;
+        std::uint64_t normal;
+    };
+
+    // Splits the next whitespace separated token off the front of line, empty once it runs out
+    [[nodiscard]] static auto NextObjToken(std::string_view& line) noexcept -> std::string_view;
+    // Missing or unparsable components read as zero
+    [[nodiscard]] static auto ParseObjVec3(std::string_view& line) noexcept -> glm::vec3;
+    [[nodiscard]] static auto ParseObjFaceVertex(std::string_view token) noexcept -> std::optional<ObjFaceVertex>;
+
+    // Parse scratch comes from the given resource, loader threads pass their FrameArena
+    [[nodiscard]] static auto ReadObj(const char* filePath, std::pmr::memory_resource* scratch = std::pmr::get_default_resource()) -> Mesh;
+    [[nodiscard]] static auto ReadObj(std::string_view inputStr, std::pmr::memory_resource* scratch = std::pmr::get_default_resource()) -> Mesh;
+    [[nodiscard]] static auto ReadObj(auto&& inputFile, std::pmr::memory_resource* scratch = std::pmr::get_default_resource()) -> Mesh {
         auto mesh = Mesh{};
 
-        auto indexedVertices = std::vector<glm::vec3>{};
-        auto indexedNormals = std::vector<glm::vec3>{};
+        auto indexedVertices = std::pmr::vector<glm::vec3>{scratch};
+        auto indexedNormals = std::pmr::vector<glm::vec3>{scratch};
+        auto faceData = std::pmr::vector<ObjFaceVertex>{scratch};
+        auto line = std::pmr::string{scratch};
 
-        // Read data from file into std::vectors
-        for (std::string line; std::getline(inputFile, line); ){
-            auto iss = std::stringstream{line};
-            std::string rowType;
-            iss >> rowType;
-            if (rowType == "#") {
-                continue;
-            } else if (rowType == "o") {
-                continue;
-            } else if (rowType == "s") {
+        // Lines are tokenised in place, the only allocations are the scratch buffers growing
+        while (std::getline(inputFile, line)) {
+            auto rest = std::string_view{line};
+            const auto rowType = NextObjToken(rest);
+            if (rowType.empty() || rowType == "#" || rowType == "o" || rowType == "s") {
                 continue;
             } else if (rowType == "v") {
-                auto& vertex = indexedVertices.emplace_back();
-                iss >> vertex.x >> vertex.y >> vertex.z;
+                indexedVertices.push_back(ParseObjVec3(rest));
             } else if (rowType == "vn") {
-                auto& normal = indexedNormals.emplace_back();
-                iss >> normal.x >> normal.y >> normal.z;
+                indexedNormals.push_back(ParseObjVec3(rest));
             } else if (rowType == "f") {
-                auto faceData = std::ranges::istream_view<std::string>(iss)
-                | std::views::transform([](const auto& entry) -> std::tuple<VertexId, std::uint64_t> {
-                    auto vertexEnd = std::ranges::find(entry, '/');
-                    auto normalBegin = std::find_if(vertexEnd, entry.cend(), [](const auto& c) { return c != '/'; });
-                    return {
-                        std::stoul(std::string(entry.begin(), vertexEnd)) - 1,
-                        std::stoul(std::string(normalBegin, entry.end())) - 1
-                    };
-                }) | std::ranges::to<std::vector>();
+                faceData.clear();
+                auto malformed = false;
+                for (auto token = NextObjToken(rest); !token.empty() && !malformed; token = NextObjToken(rest)) {
+                    const auto entry = ParseObjFaceVertex(token);
+                    // Indices are only checked against what has been read so far, forward references are malformed too
+                    malformed = !entry.has_value() || entry->vertex >= indexedVertices.size() || entry->normal >= indexedNormals.size();
+                    if (!malformed) faceData.push_back(*entry);
+                }
+
+                // Fewer than three corners would shift every later triangle along by the missing ones
+                if (malformed || faceData.size() < 3) {
+                    DebugMessage("ERROR", "Malformed face \"{}\"", std::string_view{line});
+                    continue;
+                }
 
                 if (faceData.size() > 3) {
                     DebugMessage("ERROR", "Non-triangle faces not supported");
                     continue;
                 }
 
-                std::ranges::copy(
-                    faceData | std::views::transform([&indexedVertices, &indexedNormals](auto& entry) {
-                        return Vertex{ 
-                            indexedVertices[std::get<0>(entry)],
-                            indexedNormals[std::get<1>(entry)]
-                        };
-                    }),
-                    std::back_inserter(mesh.vertices)
-                );
+                for (const auto& entry : faceData) {
+                    mesh.vertices.push_back(Vertex{ indexedVertices[entry.vertex], indexedNormals[entry.normal] });
+                }
             } else {
                 DebugMessage("WARN", "Encountered unknown row type {}", rowType);
             }
         }
 
+        mesh.ComputeBounds();
         return mesh;
     }
 };
 
-struct MeshComponent {
-    GLuint vbo = 0u;
-    GLuint vao = 0u;
-    unsigned int numVertices;
-
-    [[nodiscard]] MeshComponent(const Mesh& mesh) noexcept;
+// GPU copy of a mesh, shared between every MeshComponent that draws it
+struct GpuMesh : std::enable_shared_from_this<GpuMesh> {
+    GeometryArena* arena = nullptr;
+    GeometryArena::Handle allocation = 0u;
+    unsigned int numVertices = 0u;
+    BoundingBox bounds;
+    BoundingSphere sphere;
+    std::vector<MeshCluster> clusters;
+    std::shared_ptr<const MeshBvh> bvh;
+
+    [[nodiscard]] GpuMesh(const Mesh& mesh, GeometryArena& arena);
+    ~GpuMesh() noexcept;
+
+    [[nodiscard]] auto Vao() const noexcept -> GLuint { return arena->Vao(); }
+    [[nodiscard]] auto FirstVertex() const -> GLint { return arena->FirstVertex(allocation); }
+
+    GpuMesh(const GpuMesh& other) = delete;
+    GpuMesh& operator=(const GpuMesh& other) = delete;
+    GpuMesh(GpuMesh&& other) = delete;
+    GpuMesh& operator=(GpuMesh&& other) = delete;
+};
 
-    [[nodiscard]] MeshComponent& operator=(MeshComponent&& other) noexcept;
-    [[nodiscard]] MeshComponent(MeshComponent&& other) noexcept;
+struct MeshComponent {
+    std::shared_ptr<const GpuMesh> gpuMesh;
 
-    ~MeshComponent() noexcept;
+    [[nodiscard]] MeshComponent(const Mesh& mesh, GeometryArena& arena);
+    [[nodiscard]] explicit MeshComponent(std::shared_ptr<const GpuMesh> gpuMesh) noexcept;
 };
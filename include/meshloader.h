@@ -0,0 +1,137 @@
+#pragma once
+
+#include "componentmanagers.h"
+#include "cpuprofiler.h"
+#include "debugutils.h"
+#include "jobsystem.h"
+#include "meshcache.h"
+#include "meshcomponent.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Meshes with at least this many triangles are split into clusters while loading
+static constexpr auto CLUSTER_TRIANGLE_THRESHOLD = std::size_t{4'096U};
+
+// Parses meshes as background jobs, GL uploads are left to the thread owning the context
+class MeshLoader {
+public:
+    struct LoadedMesh {
+        std::string key;
+        Mesh mesh;
+    };
+
+    struct Waiter {
+        EntityId entity;
+        std::uint64_t ticket;
+    };
+
+private:
+    MeshCache& cache;
+    JobSystem& jobs;
+    Mesh placeholder;
+    std::shared_ptr<const GpuMesh> placeholderGpuMesh;
+
+    mutable std::mutex requestMutex;
+    std::vector<JobHandle> parseJobs;
+    std::unordered_map<std::string, std::vector<Waiter>> inFlight;
+    std::unordered_map<EntityId, std::uint64_t> latestTickets;
+    std::uint64_t nextTicket = 1U;
+
+    mutable std::mutex loadedMutex;
+    std::deque<LoadedMesh> loaded;
+
+    std::atomic<std::size_t> numPending{0U};
+    std::atomic<std::size_t> clusterThreshold{CLUSTER_TRIANGLE_THRESHOLD};
+    std::atomic<bool> buildBvh{false};
+
+    auto Parse(const std::string& key) -> void;
+
+    template <typename ECS>
+    auto Attach(ECS& ecs, EntityId entity, std::shared_ptr<const GpuMesh> gpuMesh) -> void {
+        if (ecs.template HasComponents<MeshComponent>(entity)) {
+            ecs.template GetComponent<MeshComponent>(entity).gpuMesh = std::move(gpuMesh);
+        } else {
+            ecs.template NewComponent<MeshComponent>(entity, std::move(gpuMesh));
+        }
+    }
+
+public:
+    [[nodiscard]] explicit MeshLoader(MeshCache& cache, Mesh placeholder = Mesh{}, JobSystem& jobs = JobSystem::GetInstance());
+    // Waits for parses still in flight, they write into the loader
+    ~MeshLoader() noexcept;
+
+    MeshLoader(const MeshLoader&) = delete;
+    auto operator=(const MeshLoader&) -> MeshLoader& = delete;
+    MeshLoader(MeshLoader&&) = delete;
+    auto operator=(MeshLoader&&) -> MeshLoader& = delete;
+
+    // Queues a parse unless the same file is already in flight, a later request for the same entity supersedes earlier ones
+    auto Request(EntityId entity, std::string filePath) -> void;
+
+    // Marks any in-flight request for the entity as stale
+    auto Cancel(EntityId entity) -> void;
+
+    [[nodiscard]] auto TryPopLoaded() -> std::optional<LoadedMesh>;
+
+    // Removes the in-flight entry for a parsed mesh, returning only the entities still waiting on it
+    [[nodiscard]] auto TakeWaiters(const std::string& key) -> std::vector<EntityId>;
+
+    [[nodiscard]] auto NumPending() const noexcept -> std::size_t;
+
+    auto SetClusterThreshold(std::size_t numTriangles) noexcept -> void { clusterThreshold = numTriangles; }
+    // Meshes parsed after this call carry a triangle BVH so they can be picked
+    auto SetBuildBvh(bool enabled) noexcept -> void { buildBvh = enabled; }
+
+    template <typename ECS>
+    auto LoadAsync(ECS& ecs, EntityId entity, std::string filePath) -> void {
+        if (auto resident = cache.Find(MeshCache::MakeKey(filePath))) {
+            Cancel(entity);
+            Attach(ecs, entity, std::move(resident));
+            return;
+        }
+
+        if (!placeholderGpuMesh) placeholderGpuMesh = std::make_shared<const GpuMesh>(placeholder, cache.GetArena());
+        if (!ecs.template HasComponents<MeshComponent>(entity)) Attach(ecs, entity, placeholderGpuMesh);
+
+        Request(entity, std::move(filePath));
+    }
+
+    // Must be called with the GL context current, always uploads at least one mesh to guarantee progress
+    template <typename ECS>
+    auto UploadLoaded(ECS& ecs, std::chrono::microseconds budget) -> std::size_t {
+        auto zone = ProfileZone{"MeshLoader::UploadLoaded"};
+        const auto start = std::chrono::steady_clock::now();
+        auto numUploaded = std::size_t{0U};
+
+        while (numUploaded == 0U || std::chrono::steady_clock::now() - start < budget) {
+            auto loadedMesh = TryPopLoaded();
+            if (!loadedMesh) break;
+
+            auto entities = TakeWaiters(loadedMesh->key);
+            std::erase_if(entities, [&](EntityId entity) {
+                if (ecs.template HasComponents<MeshComponent>(entity)) return false;
+                DebugMessage("WARN", "Entity {} lost its mesh before \"{}\" finished loading", entity, loadedMesh->key);
+                return true;
+            });
+
+            if (entities.empty()) continue;
+
+            auto gpuMesh = cache.Insert(loadedMesh->key, loadedMesh->mesh);
+            for (auto entity : entities) { Attach(ecs, entity, gpuMesh); }
+            ++numUploaded;
+        }
+
+        return numUploaded;
+    }
+};
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "meshcomponent.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Triangles rasterized into the occlusion buffer, usually a simplified stand-in for the drawn mesh
+struct OccluderComponent {
+    // Consecutive triples in mesh space with counter-clockwise front faces
+    std::shared_ptr<const std::vector<glm::vec3>> triangles;
+
+    // Must not extend past the drawn surface, or it hides things that should show around it
+    [[nodiscard]] static inline auto FromMesh(const Mesh& mesh) -> OccluderComponent {
+        auto positions = std::vector<glm::vec3>(mesh.vertices.size());
+        std::ranges::transform(mesh.vertices, positions.begin(), [](const Vertex& vertex) { return vertex.position; });
+        return OccluderComponent{std::make_shared<const std::vector<glm::vec3>>(std::move(positions))};
+    }
+};
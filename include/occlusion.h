@@ -0,0 +1,103 @@
+#pragma once
+
+#include "bounds.h"
+#include "jobsystem.h"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Resolution of the CPU depth buffer, far coarser than the screen so occluders stay cheap to draw
+static constexpr auto DEFAULT_OCCLUSION_WIDTH = 256;
+static constexpr auto DEFAULT_OCCLUSION_HEIGHT = 128;
+
+struct OcclusionStats {
+    std::size_t occluderTriangles = 0U;
+    std::size_t tested = 0U;
+    std::size_t culled = 0U;
+};
+
+// Rasterizes occluders into a low-resolution depth buffer and tests bounds against its max-depth pyramid.
+// Depth is stored as window depth in [0, 1], with 1 where nothing has been drawn
+class OcclusionCuller {
+public:
+    // Tile widths are a multiple of the SIMD width so no two threads ever write the same group of pixels
+    static constexpr auto TILE_WIDTH = 32;
+    static constexpr auto TILE_HEIGHT = 16;
+    static constexpr auto TILES_PER_JOB = std::size_t{4U};
+
+private:
+    struct ScreenTriangle {
+        // Edge functions A * x + B * y + C, all three non-negative inside
+        float edgeA[3];
+        float edgeB[3];
+        float edgeC[3];
+        // Depth as a plane over the screen
+        float depthA;
+        float depthB;
+        float depthC;
+        int minX;
+        int minY;
+        int maxX;
+        int maxY;
+    };
+
+    struct Level {
+        int width;
+        int height;
+        std::size_t offset;
+    };
+
+    int width;
+    int height;
+    int tilesX;
+    int tilesY;
+    glm::mat4 viewProj{1.0F};
+
+    // Level 0 is the rasterized buffer, each level above keeps the farthest depth of the texels below
+    std::vector<float> pyramid;
+    std::vector<Level> levels;
+
+    std::vector<ScreenTriangle> triangles;
+    std::vector<std::vector<std::uint32_t>> tileBins;
+    OcclusionStats stats;
+
+    JobSystem& jobs;
+
+    auto AddTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c) -> void;
+    auto RasterizeTile(std::size_t tile) noexcept -> void;
+    auto BuildPyramid() noexcept -> void;
+
+public:
+    // The calling thread always rasterizes too, so a job system without workers rasterizes serially
+    [[nodiscard]] explicit OcclusionCuller(int width = DEFAULT_OCCLUSION_WIDTH, int height = DEFAULT_OCCLUSION_HEIGHT, JobSystem& jobs = JobSystem::GetInstance());
+
+    OcclusionCuller(const OcclusionCuller&) = delete;
+    auto operator=(const OcclusionCuller&) -> OcclusionCuller& = delete;
+    OcclusionCuller(OcclusionCuller&&) = delete;
+    auto operator=(OcclusionCuller&&) -> OcclusionCuller& = delete;
+
+    // Clears the buffer and the occluders added last frame
+    auto Begin(const glm::mat4& viewProj) -> void;
+
+    // Triangles are consecutive triples in mesh space, back faces are skipped
+    auto AddOccluder(std::span<const glm::vec3> triangles, const glm::mat4& model) -> void;
+
+    // Fills the buffer in parallel tiles and builds the pyramid, call once after every occluder has been added
+    auto Rasterize() -> void;
+
+    [[nodiscard]] auto HasOccluders() const noexcept -> bool { return !triangles.empty(); }
+
+    // Anything crossing the near plane or leaving the screen is kept
+    [[nodiscard]] auto IsVisible(const BoundingBox& worldBox) noexcept -> bool;
+
+    [[nodiscard]] auto Width() const noexcept -> int { return width; }
+    [[nodiscard]] auto Height() const noexcept -> int { return height; }
+    [[nodiscard]] auto DepthAt(int x, int y) const noexcept -> float { return pyramid[static_cast<std::size_t>(y * width + x)]; }
+
+    [[nodiscard]] auto GetStats() const noexcept -> const OcclusionStats& { return stats; }
+    auto ResetStats() noexcept -> void { stats = OcclusionStats{}; }
+};
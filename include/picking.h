@@ -0,0 +1,57 @@
+#pragma once
+
+#include "bounds.h"
+#include "componentmanagers.h"
+#include "meshbvh.h"
+#include "meshcomponent.h"
+#include "scenebvh.h"
+#include "transformcomponent.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+struct PickHit {
+    EntityId entity;
+    // Along the world ray, in units of its direction
+    float distance;
+    std::uint32_t triangle;
+};
+
+// The mesh-space direction is left unnormalised so hit distances stay in world ray units
+[[nodiscard]] inline auto PickMesh(const MeshBvh& bvh, const TransformComponent& transform, const Ray& worldRay, float maxDistance) noexcept -> std::optional<MeshHit> {
+    const auto inverse = transform.GetInverseTransform();
+    const auto meshRay = Ray{
+        .origin = glm::vec3(inverse * glm::vec4(worldRay.origin, 1.0F)),
+        .direction = glm::vec3(inverse * glm::vec4(worldRay.direction, 0.0F))
+    };
+    return bvh.Intersect(meshRay, maxDistance);
+}
+
+// Nearest triangle under the ray, entities whose meshes were loaded without a BVH are skipped
+template <typename ECS>
+[[nodiscard]] auto Pick(ECS& ecs, const SceneBvh& scene, const Ray& worldRay, float maxDistance) -> std::optional<PickHit> {
+    auto candidates = std::vector<RayHit>{};
+    scene.QueryRay(worldRay, maxDistance, candidates);
+
+    auto best = std::optional<PickHit>{};
+    auto bestDistance = maxDistance;
+    for (const auto& candidate : candidates) {
+        // Candidates are sorted by where the ray enters their bounds, nothing further can be closer
+        if (candidate.distance >= bestDistance) break;
+        if (!ecs.template HasComponents<MeshComponent, TransformComponent>(candidate.entity)) continue;
+
+        const auto& gpuMesh = ecs.template GetComponent<MeshComponent>(candidate.entity).gpuMesh;
+        if (!gpuMesh || !gpuMesh->bvh) continue;
+
+        const auto& transform = ecs.template GetComponent<TransformComponent>(candidate.entity);
+        if (auto hit = PickMesh(*gpuMesh->bvh, transform, worldRay, bestDistance)) {
+            bestDistance = hit->distance;
+            best = PickHit{.entity = candidate.entity, .distance = hit->distance, .triangle = hit->triangle};
+        }
+    }
+
+    return best;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct ShaderStage {
+    std::filesystem::path fileName;
+    GLenum type;
+};
+
+struct ProgramDesc {
+    std::vector<ShaderStage> stages;
+    // Each becomes a #define line after the #version directive, e.g. "MAX_LIGHTS 4"
+    std::vector<std::string> defines;
+};
+
+struct ProgramCacheStats {
+    std::size_t numHits = 0U;
+    std::size_t numMisses = 0U;
+    std::size_t numRejected = 0U;
+};
+
+// FNV-1a over the driver string, stage types, defines and raw sources, stable across runs so it can name files
+[[nodiscard]] auto HashProgram(std::string_view driver, const ProgramDesc& desc, std::span<const std::string> sources) noexcept -> std::uint64_t;
+
+// Inserts the defines after the #version line, or at the top when there is none
+[[nodiscard]] auto InjectDefines(std::string_view source, std::span<const std::string> defines) -> std::string;
+
+// Links programs from binaries saved by earlier runs and only compiles what changed, use it on the thread owning the context
+class ProgramCache {
+    std::filesystem::path directory;
+    std::string driver;
+    bool binariesSupported = false;
+    ProgramCacheStats stats;
+
+    [[nodiscard]] auto CachePath(std::uint64_t key) const -> std::filesystem::path;
+    [[nodiscard]] auto LoadBinary(std::uint64_t key) -> GLuint;
+    auto SaveBinary(std::uint64_t key, GLuint program) const -> void;
+
+public:
+    [[nodiscard]] explicit ProgramCache(std::filesystem::path directory);
+
+    // Misses are all issued before any is waited on, so drivers with parallel compile can overlap them
+    [[nodiscard]] auto Load(std::span<const ProgramDesc> descs) -> std::vector<GLuint>;
+    [[nodiscard]] auto Load(const ProgramDesc& desc) -> GLuint;
+
+    [[nodiscard]] auto GetStats() const noexcept -> const ProgramCacheStats& { return stats; }
+};
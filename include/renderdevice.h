@@ -0,0 +1,26 @@
+#pragma once
+
+#include "commandlist.h"
+#include "streambuffer.h"
+
+#include <glad/glad.h>
+
+#include <cstddef>
+
+// GL half of the renderer, replays recorded command lists on the thread owning the context
+class RenderDevice {
+public:
+    // Uniform and shader storage bindings the vertex shader reads camera and model matrices from
+    static constexpr auto CAMERA_BINDING = GLuint{0U};
+    static constexpr auto INSTANCE_BINDING = GLuint{0U};
+
+    // Bytes per stream region, grown on demand
+    static constexpr auto INITIAL_STREAM_SIZE = std::size_t{1U << 20U};
+
+private:
+    // Written once per frame through persistent mappings, so uploads never wait on the driver
+    StreamBuffer frameStream{INITIAL_STREAM_SIZE};
+
+public:
+    auto Replay(const CommandList& commands) -> void;
+};
@@ -1,46 +1,247 @@
 #pragma once
 
+#include "commandlist.h"
+#include "cpuprofiler.h"
 #include "ecsmanager.h"
 #include "meshcomponent.h"
+#include "occludercomponent.h"
+#include "occlusion.h"
+#include "programcache.h"
+#include "renderqueue.h"
+#include "scenebvh.h"
 #include "shader.h"
 #include "cameracomponent.h"
+#include "culling.h"
+#include "transformbatch.h"
 #include "transformcomponent.h"
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
-#include <glm/gtc/type_ptr.hpp>
 
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+struct RenderStats {
+    std::size_t numDrawCalls = 0U;
+    std::size_t numInstances = 0U;
+    std::size_t numTriangles = 0U;
+};
+
+// Record half of the renderer, turns the ECS into a command list without touching GL
 template <typename ECS>
 struct Renderer {
     ECS& ecs;
     ShaderProgram shaderProgram;
     std::optional<EntityId> activeCamera;
+    FrustumCuller culler;
+    OcclusionCuller occlusionCuller;
+    SceneBvh sceneBvh;
+    ClusterCullStats clusterStats;
+    RenderStats renderStats;
+    RenderQueue renderQueue;
+    TransformBatch transformBatch;
+
+    // World matrices live in transformBatch at the same index
+    struct DrawItem {
+        EntityId entity;
+        const GpuMesh* gpuMesh;
+        BoundingBox worldBox;
+        float depth;
+    };
+    std::vector<DrawItem> drawList;
+    DrawRanges clusterRanges;
+
+    [[nodiscard]] Renderer(ECS& ecs, ProgramCache& programCache)
+        : ecs{ecs}, shaderProgram(programCache.Load(ProgramDesc{
+            .stages = {{SHADER_DIR "vert.glsl", GL_VERTEX_SHADER}, {SHADER_DIR "frag.glsl", GL_FRAGMENT_SHADER}}
+        }))
+    {}
 
-    [[nodiscard]] Renderer(ECS& ecs) 
-        : ecs{ecs}, shaderProgram(Shader(SHADER_DIR "vert.glsl", GL_VERTEX_SHADER), Shader(SHADER_DIR "frag.glsl", GL_FRAGMENT_SHADER)) 
+    // Draws with an already linked program, a zero handle records without ever touching GL
+    [[nodiscard]] Renderer(ECS& ecs, GLuint programHandle)
+        : ecs{ecs}, shaderProgram{programHandle}
     {}
 
-    auto RenderMeshes() noexcept -> void {
-        static float x = 0.0f;
+    Renderer(const Renderer& other) = delete;
+    Renderer& operator=(const Renderer& other) = delete;
+
+    // Counts for the last recorded frame
+    [[nodiscard]] auto GetCullStats() const noexcept -> const CullStats& { return culler.GetStats(); }
+    [[nodiscard]] auto GetClusterCullStats() const noexcept -> const ClusterCullStats& { return clusterStats; }
+    [[nodiscard]] auto GetOcclusionStats() const noexcept -> const OcclusionStats& { return occlusionCuller.GetStats(); }
+
+    // World bounds of every drawn entity as of the last recorded frame
+    [[nodiscard]] auto GetScene() const noexcept -> const SceneBvh& { return sceneBvh; }
+    [[nodiscard]] auto GetRenderStats() const noexcept -> const RenderStats& { return renderStats; }
+
+    // Clears the list first, meshes it held from an earlier frame are released on this thread
+    auto Record(CommandList& commands) -> void {
+        auto zone = ProfileZone{"Renderer::Record"};
+        commands.Clear();
+        clusterStats = ClusterCullStats{};
+        renderStats = RenderStats{};
 
         if (!activeCamera) {
             DebugMessage("ERROR", "No active camera found");
             return;
         }
 
-        const auto& camera = ecs.GetComponent<CameraComponent>(activeCamera.value());
-        const auto& cameraTransform = ecs.GetComponent<TransformComponent>(activeCamera.value());
+        const auto& camera = ecs.template GetComponent<CameraComponent>(activeCamera.value());
+        const auto& cameraTransform = ecs.template GetComponent<TransformComponent>(activeCamera.value());
 
         auto view = cameraTransform.GetInverseTransform();
         auto proj = camera.GetProjection();
+        const auto viewProj = proj * view;
+        const auto cameraPos = glm::vec4(cameraTransform.translation, 1.0F);
+
+        culler.Clear();
+        culler.ResetStats();
+        occlusionCuller.ResetStats();
+        drawList.clear();
+        renderQueue.Clear();
+        transformBatch.Clear();
+
+        {
+            auto gatherZone = ProfileZone{"Renderer::GatherMeshes"};
+            for (auto [id, meshComponent] : ecs.template GetAll<MeshComponent>()) {
+                transformBatch.Add(ecs.template HasComponents<TransformComponent>(id)
+                    ? ecs.template GetComponent<TransformComponent>(id)
+                    : TransformComponent::Identity());
+                drawList.push_back(DrawItem{.entity = id, .gpuMesh = meshComponent.gpuMesh.get(), .worldBox = {}, .depth = 0.0F});
+            }
+        }
+
+        const auto models = transformBatch.ComputeWorld();
+        sceneBvh.BeginSync();
+        for (auto i = std::size_t{0U}; i < drawList.size(); ++i) {
+            auto& item = drawList[i];
+            const auto worldSphere = item.gpuMesh->sphere.Transformed(models[i]);
+            const auto viewDepth = -(view * glm::vec4(worldSphere.center, 1.0F)).z;
+            item.depth = (viewDepth - camera.nearZ) / (camera.farZ - camera.nearZ);
+            item.worldBox = item.gpuMesh->bounds.Transformed(models[i]);
+
+            culler.Add(worldSphere);
+            sceneBvh.Update(item.entity, item.worldBox);
+        }
+        sceneBvh.EndSync();
+
+        const auto& visible = culler.Cull(Frustum::FromMatrix(viewProj));
+        RasterizeOccluders(viewProj);
+
+        for (auto index : visible) {
+            const auto& item = drawList[index];
+            if (!occlusionCuller.IsVisible(item.worldBox)) continue;
+
+            renderQueue.Push(DrawPacket{
+                .sortKey = SortKey::Make(RenderPass::Opaque, shaderProgram.programHandle, item.gpuMesh->Vao(), item.gpuMesh->allocation, item.depth),
+                .program = shaderProgram.programHandle,
+                .vao = item.gpuMesh->Vao(),
+                .drawIndex = index
+            });
+        }
+
+        renderQueue.Sort();
+        commands.camera = CameraUniforms{.view = view, .proj = proj};
+        BuildBatches(commands, viewProj, cameraPos);
+
+        renderStats.numDrawCalls = commands.batches.size();
+        renderStats.numInstances = commands.instanceData.size();
+        for (const auto& command : commands.indirectCommands) {
+            renderStats.numTriangles += static_cast<std::size_t>(command.count / 3U) * command.instanceCount;
+        }
+    }
+
+private:
+    // Only ECS types with an occluder manager can hide anything
+    auto RasterizeOccluders(const glm::mat4& viewProj) -> void {
+        auto zone = ProfileZone{"Renderer::RasterizeOccluders"};
+        occlusionCuller.Begin(viewProj);
+
+        if constexpr (SupportsComponent<ECS, OccluderComponent>) {
+            for (auto [id, occluder] : ecs.template GetAll<OccluderComponent>()) {
+                const auto model = ecs.template HasComponents<TransformComponent>(id)
+                    ? ecs.template GetComponent<TransformComponent>(id).GetTransform()
+                    : glm::mat4(1.0F);
+                occlusionCuller.AddOccluder(*occluder.triangles, model);
+            }
+        }
+
+        occlusionCuller.Rasterize();
+    }
+
+    static auto PushCommand(CommandList& commands, const DrawPacket& packet, DrawArraysIndirectCommand command) -> void {
+        auto& batches = commands.batches;
+        const auto extendsBatch = !batches.empty()
+            && batches.back().program == packet.program
+            && batches.back().vao == packet.vao;
+
+        if (extendsBatch) {
+            ++batches.back().numCommands;
+        } else {
+            batches.push_back(CommandList::DrawBatch{
+                .program = packet.program,
+                .vao = packet.vao,
+                .firstCommand = commands.indirectCommands.size(),
+                .numCommands = 1U
+            });
+        }
+
+        commands.indirectCommands.push_back(command);
+    }
+
+    auto BuildBatches(CommandList& commands, const glm::mat4& viewProj, const glm::vec4& cameraPos) -> void {
+        auto zone = ProfileZone{"Renderer::BuildBatches"};
+        auto& instanceData = commands.instanceData;
+        const auto models = transformBatch.Matrices();
+        const GpuMesh* previousMesh = nullptr;
+
+        for (const auto& packet : renderQueue.Packets()) {
+            const auto* gpuMesh = drawList[packet.drawIndex].gpuMesh;
+            const auto& model = models[packet.drawIndex];
+            const auto baseInstance = static_cast<GLuint>(instanceData.size());
+
+            if (gpuMesh->clusters.empty()) {
+                instanceData.push_back(model);
+
+                // Sorting places draws of the same mesh next to each other, so they become one instanced command
+                if (previousMesh == gpuMesh) {
+                    ++commands.indirectCommands.back().instanceCount;
+                    continue;
+                }
+
+                previousMesh = gpuMesh;
+                commands.meshes.push_back(gpuMesh->shared_from_this());
+                PushCommand(commands, packet, DrawArraysIndirectCommand{
+                    .count = gpuMesh->numVertices,
+                    .instanceCount = 1U,
+                    .first = static_cast<GLuint>(gpuMesh->FirstVertex()),
+                    .baseInstance = baseInstance
+                });
+                continue;
+            }
+
+            // Clusters are tested in mesh space so their bounds never need transforming
+            clusterRanges.Clear();
+            CullClusters(gpuMesh->clusters, Frustum::FromMatrix(viewProj * model), glm::vec3(glm::inverse(model) * cameraPos), clusterRanges, clusterStats);
+            previousMesh = nullptr;
+            if (clusterRanges.Size() == 0U) continue;
+
+            instanceData.push_back(model);
+            commands.meshes.push_back(gpuMesh->shared_from_this());
+            const auto firstVertex = static_cast<GLuint>(gpuMesh->FirstVertex());
 
-        for (auto [id, meshComponent] : ecs.GetAll<MeshComponent>()) {
-            glUseProgram(shaderProgram.programHandle);
-            glUniformMatrix4fv(0, 1, GL_FALSE, glm::value_ptr(view));
-            glUniformMatrix4fv(1, 1, GL_FALSE, glm::value_ptr(proj));
-            glBindVertexArray(meshComponent.vao);
-            glDrawArrays(GL_TRIANGLES, 0, meshComponent.numVertices);
+            for (auto i = std::size_t{0U}; i < clusterRanges.Size(); ++i) {
+                PushCommand(commands, packet, DrawArraysIndirectCommand{
+                    .count = static_cast<GLuint>(clusterRanges.counts[i]),
+                    .instanceCount = 1U,
+                    .first = firstVertex + static_cast<GLuint>(clusterRanges.firsts[i]),
+                    .baseInstance = baseInstance
+                });
+            }
         }
     }
-};
\ No newline at end of file
+};
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+enum class RenderPass : std::uint8_t {
+    Opaque = 0U,
+    Transparent = 1U
+};
+
+// Bit layout, most significant first: pass (4) | program (12) | vao (8) | mesh (20) | depth (20)
+struct SortKey {
+    static constexpr auto PASS_BITS = 4U;
+    static constexpr auto PROGRAM_BITS = 12U;
+    static constexpr auto VAO_BITS = 8U;
+    static constexpr auto MESH_BITS = 20U;
+    static constexpr auto DEPTH_BITS = 20U;
+
+    static constexpr auto DEPTH_SHIFT = 0U;
+    static constexpr auto MESH_SHIFT = DEPTH_SHIFT + DEPTH_BITS;
+    static constexpr auto VAO_SHIFT = MESH_SHIFT + MESH_BITS;
+    static constexpr auto PROGRAM_SHIFT = VAO_SHIFT + VAO_BITS;
+    static constexpr auto PASS_SHIFT = PROGRAM_SHIFT + PROGRAM_BITS;
+
+    static_assert(PASS_SHIFT + PASS_BITS == 64U);
+
+    // Depth is normalised to [0, 1], opaque draws sort front to back and transparent ones back to front
+    [[nodiscard]] static auto Make(RenderPass pass, std::uint32_t program, std::uint32_t vao, std::uint32_t mesh, float depth) noexcept -> std::uint64_t;
+};
+
+struct DrawPacket {
+    std::uint64_t sortKey;
+    GLuint program;
+    GLuint vao;
+    std::uint32_t drawIndex;
+};
+
+// Matches the layout glMultiDrawArraysIndirect reads from GL_DRAW_INDIRECT_BUFFER
+struct DrawArraysIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint first;
+    GLuint baseInstance;
+};
+
+// Per-frame list of draw packets, radix sorted by key so state changes cluster together
+class RenderQueue {
+private:
+    std::vector<DrawPacket> packets;
+    std::vector<DrawPacket> scratch;
+
+public:
+    auto Clear() noexcept -> void { packets.clear(); }
+    auto Reserve(std::size_t count) -> void { packets.reserve(count); scratch.reserve(count); }
+    auto Push(const DrawPacket& packet) -> void { packets.push_back(packet); }
+
+    // Stable LSD radix sort over the key bytes, bytes shared by every packet are skipped
+    auto Sort() -> void;
+
+    [[nodiscard]] auto Packets() const noexcept -> std::span<const DrawPacket> { return packets; }
+    [[nodiscard]] auto Size() const noexcept -> std::size_t { return packets.size(); }
+};
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <glad/glad.h>
+
+// Offscreen colour and depth attachments, for rendering without a visible default framebuffer
+class RenderTarget {
+    GLuint framebuffer = 0U;
+    GLuint colour = 0U;
+    GLuint depth = 0U;
+    GLsizei width = 0;
+    GLsizei height = 0;
+
+public:
+    [[nodiscard]] RenderTarget(GLsizei width, GLsizei height);
+    ~RenderTarget() noexcept;
+
+    RenderTarget(const RenderTarget& other) = delete;
+    RenderTarget& operator=(const RenderTarget& other) = delete;
+    RenderTarget(RenderTarget&& other) = delete;
+    RenderTarget& operator=(RenderTarget&& other) = delete;
+
+    // Binds for drawing and sets the viewport to cover the target
+    auto Bind() const noexcept -> void;
+
+    [[nodiscard]] auto Framebuffer() const noexcept -> GLuint { return framebuffer; }
+    [[nodiscard]] auto Width() const noexcept -> GLsizei { return width; }
+    [[nodiscard]] auto Height() const noexcept -> GLsizei { return height; }
+};
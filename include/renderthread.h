@@ -0,0 +1,57 @@
+#pragma once
+
+#include "commandlist.h"
+#include "gltask.h"
+
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+// Owns the GL context on a dedicated thread and replays the previous frame's command list while the next is recorded
+class RenderThread final : public GLExecutor {
+public:
+    using ReplayFn = std::move_only_function<void(const CommandList&)>;
+
+private:
+    GLFWwindow* window;
+    ReplayFn replay;
+    bool present;
+
+    std::mutex mutex;
+    std::condition_variable_any wake;
+    std::condition_variable frameTaken;
+    CommandList pending;
+    bool hasPending = false;
+    std::vector<GLTask> syncTasks;
+
+    // Only touched by the recording thread
+    std::vector<GLTask> deferred;
+
+    std::jthread thread;
+
+    auto ThreadLoop(std::stop_token stopToken) -> void;
+    auto RunSyncTasks(std::unique_lock<std::mutex>& lock) -> void;
+
+public:
+    // Takes the context from the calling thread, which gets it back on destruction
+    [[nodiscard]] RenderThread(GLFWwindow* window, ReplayFn replay, bool present = true);
+    ~RenderThread() noexcept override;
+
+    RenderThread(const RenderThread& other) = delete;
+    RenderThread& operator=(const RenderThread& other) = delete;
+    RenderThread(RenderThread&& other) = delete;
+    RenderThread& operator=(RenderThread&& other) = delete;
+
+    // Hands over a recorded frame and returns an old list to record into, blocking while one frame is already queued
+    auto Submit(CommandList& commands) -> void;
+
+    // Deferred tasks ride along with the next submitted frame, only the recording thread may defer
+    auto Defer(GLTask task) -> void override;
+    auto RunSync(GLTask task) -> void override;
+};
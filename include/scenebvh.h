@@ -0,0 +1,149 @@
+#pragma once
+
+#include "bounds.h"
+#include "componentmanagers.h"
+#include "culling.h"
+#include "jobsystem.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+struct RayHit {
+    EntityId entity;
+    float distance;
+};
+
+struct SceneBvhStats {
+    std::size_t numEntities = 0U;
+    std::size_t numRefits = 0U;
+    std::size_t numRebuilds = 0U;
+};
+
+// Dynamic tree over entity world bounds. Moves refit the path to the root, and once that has
+// degraded the tree past REBUILD_THRESHOLD a binned SAH rebuild runs as a background job
+class SceneBvh {
+public:
+    static constexpr auto NULL_NODE = std::int32_t{-1};
+    // Leaves are padded by this fraction of their size so small moves need no refit
+    static constexpr auto FAT_MARGIN = 0.1F;
+    // Rebuilds once the SAH cost is this many times what the last build produced
+    static constexpr auto REBUILD_THRESHOLD = 1.5F;
+    // Below this many entities rebuilds run inline, a job would cost more than the build
+    static constexpr auto MIN_BACKGROUND_ENTITIES = std::size_t{256U};
+
+    struct Node {
+        BoundingBox bounds;
+        std::int32_t parent = NULL_NODE;
+        std::int32_t left = NULL_NODE;
+        std::int32_t right = NULL_NODE;
+        EntityId entity = 0U;
+
+        [[nodiscard]] auto IsLeaf() const noexcept -> bool { return left == NULL_NODE; }
+    };
+
+    struct Tree {
+        std::vector<Node> nodes;
+        std::vector<std::int32_t> freeNodes;
+        std::unordered_map<EntityId, std::int32_t> leaves;
+        std::int32_t root = NULL_NODE;
+        // Sum over internal nodes, kept up to date so the cost check is free
+        float internalArea = 0.0F;
+
+        [[nodiscard]] auto Cost() const noexcept -> float;
+
+        auto InsertLeaf(EntityId entity, const BoundingBox& bounds) -> void;
+        auto RemoveLeaf(EntityId entity) -> void;
+        auto SetLeafBounds(EntityId entity, const BoundingBox& bounds) -> void;
+
+        [[nodiscard]] static auto Build(std::vector<std::pair<EntityId, BoundingBox>> items) -> Tree;
+
+    private:
+        auto AllocateNode() -> std::int32_t;
+        auto FreeNode(std::int32_t index) -> void;
+        auto SetBounds(std::int32_t index, const BoundingBox& bounds) -> void;
+        auto Refit(std::int32_t index) -> void;
+        auto BuildRange(std::span<std::pair<EntityId, BoundingBox>> items, std::int32_t parent) -> std::int32_t;
+    };
+
+private:
+    struct Entry {
+        BoundingBox fatBounds;
+        std::uint64_t lastSeen;
+    };
+
+    Tree tree;
+    std::unordered_map<EntityId, Entry> entries;
+    float builtCost = 0.0F;
+    std::uint64_t syncStamp = 0U;
+    SceneBvhStats stats;
+
+    // The background build writes builtTree, which is only read here once the job is done
+    std::optional<JobHandle> pendingBuild;
+    Tree builtTree;
+    // Entities touched while a background build was running, replayed onto its result
+    std::unordered_set<EntityId> changedDuringBuild;
+
+    auto MarkChanged(EntityId entity) -> void;
+    auto StartRebuild() -> void;
+    auto AdoptRebuild(Tree built) -> void;
+    [[nodiscard]] auto TakeRebuild() -> Tree;
+
+    template <typename Overlaps, typename Visit>
+    auto Traverse(Overlaps&& overlaps, Visit&& visit) const -> void {
+        if (tree.root == NULL_NODE) return;
+
+        auto stack = std::vector<std::int32_t>{tree.root};
+        while (!stack.empty()) {
+            const auto& node = tree.nodes[static_cast<std::size_t>(stack.back())];
+            stack.pop_back();
+            if (!overlaps(node.bounds)) continue;
+
+            if (node.IsLeaf()) {
+                visit(node);
+            } else {
+                stack.push_back(node.left);
+                stack.push_back(node.right);
+            }
+        }
+    }
+
+public:
+    [[nodiscard]] SceneBvh() = default;
+    ~SceneBvh() noexcept;
+
+    SceneBvh(const SceneBvh&) = delete;
+    auto operator=(const SceneBvh&) -> SceneBvh& = delete;
+    SceneBvh(SceneBvh&&) = delete;
+    auto operator=(SceneBvh&&) -> SceneBvh& = delete;
+
+    // Inserts the entity when it is new, otherwise refits only if it left its padded bounds
+    auto Update(EntityId entity, const BoundingBox& worldBounds) -> void;
+    auto Remove(EntityId entity) -> void;
+    [[nodiscard]] auto Contains(EntityId entity) const -> bool { return entries.contains(entity); }
+
+    // Entities not updated between the two calls are removed, for callers that walk the whole scene each frame
+    auto BeginSync() noexcept -> void { ++syncStamp; }
+    auto EndSync() -> void;
+
+    // Picks up a finished background build and starts a new one when quality has dropped
+    auto Maintain() -> void;
+    // Blocks until the tree has been rebuilt
+    auto Rebuild() -> void;
+
+    auto QueryFrustum(const Frustum& frustum, std::vector<EntityId>& entities) const -> void;
+    auto QueryBox(const BoundingBox& box, std::vector<EntityId>& entities) const -> void;
+    auto QuerySphere(const BoundingSphere& sphere, std::vector<EntityId>& entities) const -> void;
+    // Hits against entity bounds, nearest first
+    auto QueryRay(const Ray& ray, float maxDistance, std::vector<RayHit>& hits) const -> void;
+
+    [[nodiscard]] auto Size() const noexcept -> std::size_t { return entries.size(); }
+    [[nodiscard]] auto Cost() const noexcept -> float { return tree.Cost(); }
+    [[nodiscard]] auto IsRebuilding() const noexcept -> bool { return pendingBuild.has_value(); }
+    [[nodiscard]] auto GetStats() const noexcept -> SceneBvhStats { return SceneBvhStats{.numEntities = entries.size(), .numRefits = stats.numRefits, .numRebuilds = stats.numRebuilds}; }
+};
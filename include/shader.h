@@ -23,6 +23,9 @@ struct Shader {
 struct ShaderProgram {
     GLuint programHandle = 0u;
 
+    // Takes ownership of an already linked program, such as one from ProgramCache
+    [[nodiscard]] explicit ShaderProgram(GLuint programHandle) noexcept : programHandle{programHandle} {}
+
     template <typename... T>
     [[nodiscard]] ShaderProgram(T&&... shaders) {
         if (((shaders.shaderHandle == 0u) || ...)) {
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <optional>
+#include <type_traits>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer thread
+template <typename T, std::size_t Capacity>
+class SpscRing {
+    static_assert(Capacity > 0U && (Capacity & (Capacity - 1U)) == 0U, "Capacity must be a power of two");
+    static_assert(std::is_trivially_copyable_v<T>, "Slots are overwritten in place, T must be trivially copyable");
+
+    static constexpr auto MASK = Capacity - 1U;
+    // Keeps the two indices apart so producer and consumer do not bounce one cache line
+    static constexpr auto CACHE_LINE = std::size_t{64U};
+
+    std::array<T, Capacity> slots{};
+    alignas(CACHE_LINE) std::atomic<std::size_t> head{0U};
+    alignas(CACHE_LINE) std::atomic<std::size_t> tail{0U};
+    alignas(CACHE_LINE) std::atomic<std::size_t> numDropped{0U};
+
+public:
+    // Producer only, fails rather than blocking when the consumer has fallen a full ring behind
+    auto TryPush(const T& value) noexcept -> bool {
+        const auto currentTail = tail.load(std::memory_order_relaxed);
+        if (currentTail - head.load(std::memory_order_acquire) == Capacity) {
+            numDropped.fetch_add(1U, std::memory_order_relaxed);
+            return false;
+        }
+
+        slots[currentTail & MASK] = value;
+        tail.store(currentTail + 1U, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only
+    auto TryPop() noexcept -> std::optional<T> {
+        const auto currentHead = head.load(std::memory_order_relaxed);
+        if (currentHead == tail.load(std::memory_order_acquire)) return std::nullopt;
+
+        auto value = slots[currentHead & MASK];
+        head.store(currentHead + 1U, std::memory_order_release);
+        return value;
+    }
+
+    // Consumer only, hands every queued element to visit and releases their slots in one store
+    template <typename Visit>
+    auto Drain(Visit&& visit) -> std::size_t {
+        const auto currentHead = head.load(std::memory_order_relaxed);
+        const auto currentTail = tail.load(std::memory_order_acquire);
+        for (auto index = currentHead; index != currentTail; ++index) visit(slots[index & MASK]);
+
+        head.store(currentTail, std::memory_order_release);
+        return currentTail - currentHead;
+    }
+
+    [[nodiscard]] auto Size() const noexcept -> std::size_t {
+        // Head first, so the tail read after it can never be behind
+        const auto currentHead = head.load(std::memory_order_acquire);
+        return tail.load(std::memory_order_acquire) - currentHead;
+    }
+    [[nodiscard]] auto NumDropped() const noexcept -> std::size_t { return numDropped.load(std::memory_order_relaxed); }
+    [[nodiscard]] static constexpr auto GetCapacity() noexcept -> std::size_t { return Capacity; }
+};
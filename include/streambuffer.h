@@ -0,0 +1,68 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <span>
+
+// Persistently mapped buffer split into regions the CPU cycles through, each fenced until the GPU has consumed it
+class StreamBuffer {
+public:
+    static constexpr auto NUM_REGIONS = std::size_t{3U};
+
+    struct Allocation {
+        std::byte* data;
+        GLintptr offset;
+        GLsizeiptr size;
+    };
+
+private:
+    GLuint buffer = 0U;
+    std::byte* mapped = nullptr;
+    std::size_t regionSize = 0U;
+    std::size_t alignment = 0U;
+    std::size_t region = 0U;
+    std::size_t head = 0U;
+    std::array<GLsync, NUM_REGIONS> fences{};
+    std::size_t numStalls = 0U;
+
+    auto Create(std::size_t newRegionSize) -> void;
+    auto Destroy() noexcept -> void;
+    auto WaitForRegion(std::size_t index) noexcept -> void;
+
+public:
+    [[nodiscard]] static constexpr auto AlignUp(std::size_t size, std::size_t alignment) noexcept -> std::size_t {
+        return (size + alignment - 1U) / alignment * alignment;
+    }
+
+    // Region size is in bytes, the whole buffer holds NUM_REGIONS of them
+    [[nodiscard]] explicit StreamBuffer(std::size_t regionSize);
+    ~StreamBuffer() noexcept;
+
+    StreamBuffer(const StreamBuffer& other) = delete;
+    StreamBuffer& operator=(const StreamBuffer& other) = delete;
+    StreamBuffer(StreamBuffer&& other) = delete;
+    StreamBuffer& operator=(StreamBuffer&& other) = delete;
+
+    // Blocks only if the GPU is still reading the next region, every region grows when a frame needs more than fits
+    auto BeginFrame(std::size_t requiredSize) -> void;
+    auto EndFrame() noexcept -> void;
+
+    // Offsets are aligned for binding as uniform or shader storage ranges
+    [[nodiscard]] auto Allocate(std::size_t size) -> Allocation;
+
+    template <typename T>
+    [[nodiscard]] auto Write(std::span<const T> values) -> Allocation {
+        auto allocation = Allocate(values.size_bytes());
+        std::memcpy(allocation.data, values.data(), values.size_bytes());
+        return allocation;
+    }
+
+    [[nodiscard]] auto AlignedSize(std::size_t size) const noexcept -> std::size_t { return AlignUp(size, alignment); }
+
+    [[nodiscard]] auto Buffer() const noexcept -> GLuint { return buffer; }
+    [[nodiscard]] auto RegionSize() const noexcept -> std::size_t { return regionSize; }
+    [[nodiscard]] auto NumStalls() const noexcept -> std::size_t { return numStalls; }
+};
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "transformcomponent.h"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+// Gathers transforms into structure-of-arrays form and converts them to matrices several at a time
+class TransformBatch {
+    std::vector<float> scaleX, scaleY, scaleZ;
+    std::vector<float> rotationX, rotationY, rotationZ, rotationW;
+    std::vector<float> translationX, translationY, translationZ;
+
+    std::vector<glm::mat4> matrices;
+
+public:
+    auto Clear() noexcept -> void;
+    auto Reserve(std::size_t size) -> void;
+    auto Add(const TransformComponent& transform) -> void;
+
+    [[nodiscard]] auto Size() const noexcept -> std::size_t { return scaleX.size(); }
+
+    // Both overwrite the same output, indexed in the order transforms were added
+    auto ComputeWorld() -> std::span<const glm::mat4>;
+    auto ComputeInverseWorld() -> std::span<const glm::mat4>;
+
+    [[nodiscard]] auto Matrices() const noexcept -> std::span<const glm::mat4> { return matrices; }
+};
@@ -2,25 +2,46 @@
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
 
+// World matrix is translation * rotation * scale, rotation must be a unit quaternion
 struct TransformComponent {
     glm::vec3 scale;
-    glm::mat4 rotation;
+    glm::quat rotation;
     glm::vec3 translation;
 
+    [[nodiscard]] static inline auto Identity() noexcept -> TransformComponent {
+        return TransformComponent{glm::vec3(1.0F), glm::quat(1.0F, 0.0F, 0.0F, 0.0F), glm::vec3(0.0F)};
+    }
+
+    // Blends two simulated states for rendering between fixed steps, alpha 0 gives a and 1 gives b
+    [[nodiscard]] static inline auto Interpolate(const TransformComponent& a, const TransformComponent& b, float alpha) noexcept -> TransformComponent {
+        return TransformComponent{
+            glm::mix(a.scale, b.scale, alpha),
+            glm::slerp(a.rotation, b.rotation, alpha),
+            glm::mix(a.translation, b.translation, alpha)
+        };
+    }
+
     [[nodiscard]] inline auto GetTransform() const noexcept -> glm::mat4 {
-        auto t = glm::mat4(1.0f);
-        t = glm::scale(t, scale);
-        t = rotation * t;
-        t = glm::translate(t, translation);
-        return t;
+        const auto r = glm::mat3_cast(rotation);
+        return glm::mat4(
+            glm::vec4(r[0] * scale.x, 0.0F),
+            glm::vec4(r[1] * scale.y, 0.0F),
+            glm::vec4(r[2] * scale.z, 0.0F),
+            glm::vec4(translation, 1.0F)
+        );
     }
 
+    // Built directly rather than through glm::inverse, the rotation block is transposed and divided by scale
     [[nodiscard]] inline auto GetInverseTransform() const noexcept -> glm::mat4 {
-        auto t = glm::mat4(1.0f);
-        t = glm::translate(t, -translation);
-        t = glm::transpose(rotation) * t;
-        t = glm::scale(t, 1.0f / scale);
-        return t;
+        const auto r = glm::mat3_cast(rotation);
+        const auto invScale = 1.0F / scale;
+        return glm::mat4(
+            glm::vec4(r[0].x * invScale.x, r[1].x * invScale.y, r[2].x * invScale.z, 0.0F),
+            glm::vec4(r[0].y * invScale.x, r[1].y * invScale.y, r[2].y * invScale.z, 0.0F),
+            glm::vec4(r[0].z * invScale.x, r[1].z * invScale.y, r[2].z * invScale.z, 0.0F),
+            glm::vec4(-glm::dot(r[0], translation) * invScale.x, -glm::dot(r[1], translation) * invScale.y, -glm::dot(r[2], translation) * invScale.z, 1.0F)
+        );
     }
-};
\ No newline at end of file
+};
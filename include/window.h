@@ -6,6 +6,13 @@
 #include <GLFW/glfw3.h>
 
 #include <memory>
+#include <utility>
+
+struct WindowSettings {
+    // Hidden windows still own a context, so headless runs can render into offscreen targets
+    bool visible = true;
+    bool vsync = true;
+};
 
 class Window {
 private:
@@ -19,8 +26,9 @@ private:
     [[nodiscard]] static auto GetInstance() noexcept -> Window&;
 
 public:
-    static void Initialize();
+    static void Initialize(const WindowSettings& settings = WindowSettings{});
     static void Terminate() noexcept;
     [[nodiscard]] static auto GetWindow() noexcept -> GLFWwindow*;
     [[nodiscard]] static auto GetAspectRatio() noexcept -> float;
+    [[nodiscard]] static auto GetFramebufferSize() noexcept -> std::pair<int, int>;
 };
\ No newline at end of file
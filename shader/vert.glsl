@@ -2,12 +2,19 @@
 layout (location = 0) in vec3 pos;
 layout (location = 1) in vec3 colour;
 
-layout (location = 0) uniform mat4 view;
-layout (location = 1) uniform mat4 proj;
+layout (std140, binding = 0) uniform Camera {
+    mat4 view;
+    mat4 proj;
+};
+
+layout (std430, binding = 0) readonly buffer InstanceData {
+    mat4 models[];
+};
 
 out vec3 outColour;
 
 void main() {
-    gl_Position = proj * view * vec4(pos, 1.0);
+    mat4 model = models[gl_BaseInstance + gl_InstanceID];
+    gl_Position = proj * view * model * vec4(pos, 1.0);
     outColour = colour;
 }
\ No newline at end of file
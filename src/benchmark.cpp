@@ -0,0 +1,133 @@
+#include "benchmark.h"
+
+#include "debugutils.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <format>
+#include <numeric>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+auto ParseCount(std::string_view flag, std::span<const std::string_view> args, std::size_t& index) -> std::size_t {
+    if (index + 1U >= args.size()) ThrowMessage("ERROR", "{} expects a frame count", flag);
+
+    const auto value = args[++index];
+    auto count = std::size_t{0U};
+    const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), count);
+    if (error != std::errc{} || end != value.data() + value.size()) ThrowMessage("ERROR", "{} expects a frame count, got \"{}\"", flag, value);
+
+    return count;
+}
+
+auto ParsePath(std::string_view flag, std::span<const std::string_view> args, std::size_t& index) -> std::string {
+    if (index + 1U >= args.size()) ThrowMessage("ERROR", "{} expects a path", flag);
+    return std::string(args[++index]);
+}
+
+auto ParseRate(std::string_view flag, std::span<const std::string_view> args, std::size_t& index) -> double {
+    if (index + 1U >= args.size()) ThrowMessage("ERROR", "{} expects a rate", flag);
+
+    const auto value = args[++index];
+    auto rate = 0.0;
+    const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), rate);
+    if (error != std::errc{} || end != value.data() + value.size() || !(rate > 0.0)) ThrowMessage("ERROR", "{} expects a positive rate, got \"{}\"", flag, value);
+
+    return rate;
+}
+
+auto Percentile(std::span<const double> sorted, double fraction) noexcept -> double {
+    const auto rank = static_cast<std::size_t>(std::ceil(fraction * static_cast<double>(sorted.size())));
+    return sorted[std::clamp(rank, std::size_t{1U}, sorted.size()) - 1U];
+}
+
+}
+
+auto BenchmarkOptions::Parse(std::span<const std::string_view> args) -> BenchmarkOptions {
+    auto options = BenchmarkOptions{};
+
+    for (auto i = std::size_t{0U}; i < args.size(); ++i) {
+        const auto arg = args[i];
+        if (arg == "--headless") {
+            options.headless = true;
+        } else if (arg == "--benchmark") {
+            options.numFrames = ParseCount(arg, args, i);
+        } else if (arg == "--warmup") {
+            options.numWarmupFrames = ParseCount(arg, args, i);
+        } else if (arg == "--output") {
+            options.outputPath = ParsePath(arg, args, i);
+        } else if (arg == "--record-input") {
+            options.recordInputPath = ParsePath(arg, args, i);
+        } else if (arg == "--replay-input") {
+            options.replayInputPath = ParsePath(arg, args, i);
+        } else if (arg == "--trace") {
+            options.tracePath = ParsePath(arg, args, i);
+        } else if (arg == "--present") {
+            if (i + 1U >= args.size()) ThrowMessage("ERROR", "--present expects vsync, uncapped or capped");
+            const auto name = args[++i];
+            options.presentMode = ParsePresentMode(name);
+            if (!options.presentMode) ThrowMessage("ERROR", "--present expects vsync, uncapped or capped, got \"{}\"", name);
+        } else if (arg == "--fps") {
+            options.targetFps = ParseRate(arg, args, i);
+        } else if (arg == "--memory-report") {
+            options.memoryReportPath = ParsePath(arg, args, i);
+        } else {
+            ThrowMessage("ERROR", "Unknown argument \"{}\"", arg);
+        }
+    }
+
+    if (options.recordInputPath && options.replayInputPath) ThrowMessage("ERROR", "--record-input and --replay-input can't be combined");
+    // Nothing could ever close the hidden window, so only runs that end by themselves may hide it
+    if (options.headless && !options.IsBenchmark() && !options.replayInputPath) ThrowMessage("ERROR", "--headless needs --benchmark or --replay-input");
+    if (options.targetFps) {
+        if (options.presentMode && *options.presentMode != PresentMode::Capped) ThrowMessage("ERROR", "--fps only applies to --present capped");
+        options.presentMode = PresentMode::Capped;
+    }
+
+    return options;
+}
+
+auto FrameTimeSummary::FromSamples(std::span<const double> frameTimesMs) -> FrameTimeSummary {
+    if (frameTimesMs.empty()) return FrameTimeSummary{};
+
+    auto sorted = std::vector<double>(frameTimesMs.begin(), frameTimesMs.end());
+    std::ranges::sort(sorted);
+
+    return FrameTimeSummary{
+        .minMs = sorted.front(),
+        .avgMs = std::accumulate(sorted.cbegin(), sorted.cend(), 0.0) / static_cast<double>(sorted.size()),
+        .p50Ms = Percentile(sorted, 0.50),
+        .p95Ms = Percentile(sorted, 0.95),
+        .p99Ms = Percentile(sorted, 0.99)
+    };
+}
+
+auto BenchmarkRecorder::AddFrame(double frameTimeMs, std::size_t numDrawCalls, std::size_t numTriangles) -> void {
+    frameTimesMs.push_back(frameTimeMs);
+    totalDrawCalls += numDrawCalls;
+    totalTriangles += numTriangles;
+}
+
+auto BenchmarkRecorder::ToJson() const -> std::string {
+    const auto summary = Summary();
+    const auto numFrames = std::max(NumFrames(), std::size_t{1U});
+
+    return std::format(
+        "{{\n"
+        "  \"frames\": {},\n"
+        "  \"frameTimeMs\": {{ \"min\": {:.4f}, \"avg\": {:.4f}, \"p50\": {:.4f}, \"p95\": {:.4f}, \"p99\": {:.4f} }},\n"
+        "  \"drawCallsPerFrame\": {:.2f},\n"
+        "  \"trianglesPerFrame\": {:.2f}\n"
+        "}}\n",
+        NumFrames(),
+        summary.minMs, summary.avgMs, summary.p50Ms, summary.p95Ms, summary.p99Ms,
+        static_cast<double>(totalDrawCalls) / static_cast<double>(numFrames),
+        static_cast<double>(totalTriangles) / static_cast<double>(numFrames)
+    );
+}
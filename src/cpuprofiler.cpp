@@ -0,0 +1,144 @@
+#include "cpuprofiler.h"
+
+#include "debugutils.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace {
+
+auto AppendJsonString(std::string& output, std::string_view value) -> void {
+    output += '"';
+    for (const auto c : value) {
+        if (c == '"' || c == '\\') {
+            output += '\\';
+            output += c;
+        } else if (static_cast<unsigned char>(c) < 0x20U) {
+            std::format_to(std::back_inserter(output), "\\u{:04x}", static_cast<unsigned int>(c));
+        } else {
+            output += c;
+        }
+    }
+    output += '"';
+}
+
+}
+
+auto CpuProfiler::GetInstance() -> CpuProfiler& {
+    static CpuProfiler profiler{};
+    return profiler;
+}
+
+auto CpuProfiler::GetThreadBuffer() -> ThreadBuffer& {
+    // Shared with the profiler so zones from a thread that has since exited are still collected
+    thread_local auto buffer = std::shared_ptr<ThreadBuffer>{};
+    if (!buffer) {
+        auto lock = std::scoped_lock{buffersMutex};
+        buffer = std::make_shared<ThreadBuffer>();
+        buffer->threadId = static_cast<std::uint32_t>(threadNames.size());
+        threadNames.push_back(std::format("Thread {}", buffer->threadId));
+        buffers.push_back(buffer);
+    }
+    return *buffer;
+}
+
+auto CpuProfiler::SetThreadName(std::string name) -> void {
+    const auto threadId = GetThreadBuffer().threadId;
+    auto lock = std::scoped_lock{buffersMutex};
+    threadNames[threadId] = std::move(name);
+}
+
+auto CpuProfiler::BeginCapture() -> void {
+    capturing.store(false, std::memory_order_relaxed);
+    Collect();
+
+    captured.clear();
+    numDropped = 0U;
+
+    captureStartNs = Now();
+    capturing.store(true, std::memory_order_relaxed);
+}
+
+auto CpuProfiler::EndCapture() -> void {
+    capturing.store(false, std::memory_order_relaxed);
+    Collect();
+}
+
+auto CpuProfiler::Record(const ProfileEvent& event) -> void {
+    (void) GetThreadBuffer().events.TryPush(event);
+}
+
+auto CpuProfiler::Collect() -> void {
+    auto snapshot = [&] {
+        auto lock = std::scoped_lock{buffersMutex};
+        return buffers;
+    }();
+
+    for (const auto& buffer : snapshot) {
+        buffer->events.Drain([&](const ProfileEvent& event) {
+            // Zones that began before the capture only end inside it when they straddle BeginCapture
+            if (event.startNs < captureStartNs) return;
+            if (captured.size() == MAX_CAPTURED_EVENTS) {
+                ++numDropped;
+                return;
+            }
+            captured.push_back(CapturedEvent{.event = event, .threadId = buffer->threadId});
+        });
+
+        const auto dropped = buffer->events.NumDropped();
+        numDropped += dropped - std::exchange(buffer->numDroppedSeen, dropped);
+    }
+
+    auto lock = std::scoped_lock{buffersMutex};
+    std::erase_if(buffers, [](const auto& buffer) { return buffer.use_count() == 1 && buffer->events.Size() == 0U; });
+}
+
+auto CpuProfiler::ToChromeTrace() const -> std::string {
+    auto output = std::string{"{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"};
+    auto first = true;
+    auto Separate = [&] {
+        if (!first) output += ",\n";
+        first = false;
+    };
+
+    {
+        auto lock = std::scoped_lock{buffersMutex};
+        for (auto threadId = std::size_t{0U}; threadId < threadNames.size(); ++threadId) {
+            Separate();
+            std::format_to(std::back_inserter(output), "{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{},\"args\":{{\"name\":", threadId);
+            AppendJsonString(output, threadNames[threadId]);
+            output += "}}";
+        }
+    }
+
+    for (const auto& [event, threadId] : captured) {
+        Separate();
+        output += "{\"name\":";
+        AppendJsonString(output, event.name);
+        // Microseconds with nanosecond precision, which is the unit the format expects
+        std::format_to(
+            std::back_inserter(output), ",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}}}",
+            threadId, static_cast<double>(event.startNs - captureStartNs) / 1'000.0, static_cast<double>(event.endNs - event.startNs) / 1'000.0
+        );
+    }
+
+    output += "\n]}\n";
+    return output;
+}
+
+auto CpuProfiler::WriteChromeTrace(const std::filesystem::path& filePath) const -> void {
+    auto file = std::ofstream(filePath, std::ofstream::trunc);
+    file << ToChromeTrace();
+    if (!file) ThrowMessage("ERROR", "Couldn't write trace \"{}\"", filePath.string());
+}
@@ -0,0 +1,164 @@
+#include "culling.h"
+
+#include "bounds.h"
+#include "cpuprofiler.h"
+#include "meshcluster.h"
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64)
+#define CULLING_USE_SSE 1
+#include <xmmintrin.h>
+#endif
+
+namespace {
+
+constexpr auto BATCH_SIZE = std::size_t{4U};
+
+auto NormalisePlane(const glm::vec4& plane) noexcept -> glm::vec4 {
+    return plane / glm::length(glm::vec3(plane));
+}
+
+}
+
+auto Frustum::FromMatrix(const glm::mat4& viewProj) noexcept -> Frustum {
+    auto Row = [&](int i) { return glm::vec4(viewProj[0][i], viewProj[1][i], viewProj[2][i], viewProj[3][i]); };
+
+    return Frustum{ .planes = {
+        NormalisePlane(Row(3) + Row(0)),
+        NormalisePlane(Row(3) - Row(0)),
+        NormalisePlane(Row(3) + Row(1)),
+        NormalisePlane(Row(3) - Row(1)),
+        NormalisePlane(Row(3) + Row(2)),
+        NormalisePlane(Row(3) - Row(2))
+    }};
+}
+
+auto Frustum::Intersects(const BoundingSphere& sphere) const noexcept -> bool {
+    for (const auto& plane : planes) {
+        if (glm::dot(glm::vec3(plane), sphere.center) + plane.w < -sphere.radius) return false;
+    }
+    return true;
+}
+
+auto Frustum::Intersects(const BoundingBox& box) const noexcept -> bool {
+    const auto center = box.Center();
+    const auto extents = box.Extents();
+    for (const auto& plane : planes) {
+        const auto projectedRadius = glm::dot(extents, glm::abs(glm::vec3(plane)));
+        if (glm::dot(glm::vec3(plane), center) + plane.w < -projectedRadius) return false;
+    }
+    return true;
+}
+
+auto FrustumCuller::Clear() noexcept -> void {
+    centerX.clear();
+    centerY.clear();
+    centerZ.clear();
+    radius.clear();
+    visible.clear();
+}
+
+auto FrustumCuller::Reserve(std::size_t count) -> void {
+    const auto padded = (count + BATCH_SIZE - 1U) / BATCH_SIZE * BATCH_SIZE;
+    centerX.reserve(padded);
+    centerY.reserve(padded);
+    centerZ.reserve(padded);
+    radius.reserve(padded);
+    visible.reserve(count);
+}
+
+auto FrustumCuller::Add(const BoundingSphere& sphere) -> std::uint32_t {
+    const auto index = static_cast<std::uint32_t>(radius.size());
+    centerX.push_back(sphere.center.x);
+    centerY.push_back(sphere.center.y);
+    centerZ.push_back(sphere.center.z);
+    radius.push_back(sphere.radius);
+    return index;
+}
+
+auto FrustumCuller::Cull(const Frustum& frustum) -> const std::vector<std::uint32_t>& {
+    auto zone = ProfileZone{"FrustumCuller::Cull"};
+    const auto count = radius.size();
+    const auto padded = (count + BATCH_SIZE - 1U) / BATCH_SIZE * BATCH_SIZE;
+
+    // Padding lanes are tested but never reported
+    centerX.resize(padded);
+    centerY.resize(padded);
+    centerZ.resize(padded);
+    radius.resize(padded);
+
+    visible.clear();
+
+    for (auto i = std::size_t{0U}; i < padded; i += BATCH_SIZE) {
+#ifdef CULLING_USE_SSE
+        const auto x = _mm_loadu_ps(&centerX[i]);
+        const auto y = _mm_loadu_ps(&centerY[i]);
+        const auto z = _mm_loadu_ps(&centerZ[i]);
+        const auto negRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&radius[i]));
+
+        auto inside = _mm_cmpeq_ps(x, x);
+        for (const auto& plane : frustum.planes) {
+            auto dist = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(plane.x)), _mm_mul_ps(y, _mm_set1_ps(plane.y)));
+            dist = _mm_add_ps(dist, _mm_mul_ps(z, _mm_set1_ps(plane.z)));
+            dist = _mm_add_ps(dist, _mm_set1_ps(plane.w));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(dist, negRadius));
+        }
+        const auto mask = static_cast<unsigned int>(_mm_movemask_ps(inside));
+#else
+        auto mask = 0U;
+        for (auto lane = std::size_t{0U}; lane < BATCH_SIZE; ++lane) {
+            auto inside = true;
+            for (const auto& plane : frustum.planes) {
+                const auto dist = plane.x * centerX[i + lane] + plane.y * centerY[i + lane] + plane.z * centerZ[i + lane] + plane.w;
+                inside = inside && dist >= -radius[i + lane];
+            }
+            mask |= static_cast<unsigned int>(inside) << lane;
+        }
+#endif
+
+        for (auto lane = std::size_t{0U}; lane < BATCH_SIZE && i + lane < count; ++lane) {
+            if ((mask & (1U << lane)) != 0U) visible.push_back(static_cast<std::uint32_t>(i + lane));
+        }
+    }
+
+    centerX.resize(count);
+    centerY.resize(count);
+    centerZ.resize(count);
+    radius.resize(count);
+
+    stats.tested += count;
+    stats.culled += count - visible.size();
+    return visible;
+}
+
+auto CullClusters(std::span<const MeshCluster> clusters, const Frustum& frustum, const glm::vec3& cameraPos, DrawRanges& ranges, ClusterCullStats& stats) -> void {
+    stats.tested += clusters.size();
+
+    for (const auto& cluster : clusters) {
+        if (!frustum.Intersects(cluster.sphere)) {
+            ++stats.frustumCulled;
+            continue;
+        }
+
+        if (cluster.IsBackfacing(cameraPos)) {
+            ++stats.backfaceCulled;
+            continue;
+        }
+
+        const auto first = static_cast<std::int32_t>(cluster.firstVertex);
+        const auto count = static_cast<std::int32_t>(cluster.numVertices);
+        if (ranges.Size() > 0U && ranges.firsts.back() + ranges.counts.back() == first) {
+            ranges.counts.back() += count;
+        } else {
+            ranges.firsts.push_back(first);
+            ranges.counts.push_back(count);
+        }
+    }
+}
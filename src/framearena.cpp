@@ -0,0 +1,103 @@
+#include "framearena.h"
+
+#include "memorytracker.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <numeric>
+
+namespace {
+
+auto frameEpoch = std::atomic<std::uint64_t>{0U};
+
+using ArenaMemory = NamedMemoryTag<"CPU/Frame arenas">;
+
+}
+
+FrameArena::FrameArena(std::size_t initialCapacity, std::pmr::memory_resource* upstream)
+    : upstream{upstream}
+{
+    AddChunk(initialCapacity, alignof(std::max_align_t));
+}
+
+FrameArena::~FrameArena() noexcept {
+    ReleaseChunks();
+}
+
+auto FrameArena::AddChunk(std::size_t minSize, std::size_t alignment) -> void {
+    // Doubling keeps the number of chunks logarithmic in the largest frame
+    const auto size = std::max(minSize, Capacity());
+    const auto chunkAlignment = std::max(alignment, alignof(std::max_align_t));
+    auto* data = static_cast<std::byte*>(upstream->allocate(size, chunkAlignment));
+    ++numUpstreamAllocations;
+    ArenaMemory::Counter().Add(size);
+
+    chunks.push_back(Chunk{.data = data, .size = size, .alignment = chunkAlignment});
+    currentChunk = chunks.size() - 1U;
+    offset = 0U;
+}
+
+auto FrameArena::ReleaseChunks() noexcept -> void {
+    for (const auto& chunk : chunks) {
+        upstream->deallocate(chunk.data, chunk.size, chunk.alignment);
+        ArenaMemory::Counter().Remove(chunk.size);
+    }
+    chunks.clear();
+}
+
+auto FrameArena::do_allocate(std::size_t bytes, std::size_t alignment) -> void* {
+    for (; currentChunk < chunks.size(); ++currentChunk, offset = 0U) {
+        const auto& chunk = chunks[currentChunk];
+        const auto base = reinterpret_cast<std::uintptr_t>(chunk.data); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+        const auto alignedOffset = ((base + offset + alignment - 1U) & ~(alignment - 1U)) - base;
+        if (alignedOffset + bytes > chunk.size) continue;
+
+        bytesUsed += alignedOffset + bytes - offset;
+        highWater = std::max(highWater, bytesUsed);
+        offset = alignedOffset + bytes;
+        return chunk.data + alignedOffset;
+    }
+
+    AddChunk(bytes, alignment);
+    bytesUsed += bytes;
+    highWater = std::max(highWater, bytesUsed);
+    offset = bytes;
+    return chunks.back().data;
+}
+
+auto FrameArena::do_deallocate([[maybe_unused]] void* pointer, [[maybe_unused]] std::size_t bytes, [[maybe_unused]] std::size_t alignment) -> void {}
+
+auto FrameArena::Reset() -> void {
+    if (chunks.size() > 1U) {
+        const auto total = Capacity();
+        ReleaseChunks();
+        AddChunk(total, alignof(std::max_align_t));
+    }
+
+    currentChunk = 0U;
+    offset = 0U;
+    bytesUsed = 0U;
+}
+
+auto FrameArena::Capacity() const noexcept -> std::size_t {
+    return std::accumulate(chunks.cbegin(), chunks.cend(), std::size_t{0U}, [](std::size_t sum, const Chunk& chunk) { return sum + chunk.size; });
+}
+
+auto FrameArena::ForThread() -> FrameArena& {
+    thread_local auto arena = FrameArena{};
+    thread_local auto arenaEpoch = frameEpoch.load(std::memory_order_acquire);
+
+    const auto epoch = frameEpoch.load(std::memory_order_acquire);
+    if (arenaEpoch != epoch) {
+        arena.Reset();
+        arenaEpoch = epoch;
+    }
+    return arena;
+}
+
+auto FrameArena::BeginFrame() noexcept -> void {
+    frameEpoch.fetch_add(1U, std::memory_order_acq_rel);
+}
@@ -0,0 +1,84 @@
+#include "frameloop.h"
+
+#include "debugutils.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <optional>
+#include <string_view>
+#include <thread>
+#include <utility>
+
+auto ParsePresentMode(std::string_view name) noexcept -> std::optional<PresentMode> {
+    if (name == "vsync") return PresentMode::Vsync;
+    if (name == "uncapped") return PresentMode::Uncapped;
+    if (name == "capped") return PresentMode::Capped;
+    return std::nullopt;
+}
+
+FrameLoop::FrameLoop(const FrameLoopSettings& settings)
+    : settings{settings}, step{1.0 / settings.simulationHz}
+{
+    if (!(settings.simulationHz > 0.0)) ThrowMessage("ERROR", "Simulation rate must be positive, got {}", settings.simulationHz);
+    if (settings.presentMode == PresentMode::Capped && !(settings.targetFps > 0.0)) ThrowMessage("ERROR", "Frame cap must be positive, got {}", settings.targetFps);
+}
+
+auto FrameLoop::WaitForFrameSlot() -> void {
+    stats.lastWaitMs = 0.0;
+    if (settings.presentMode != PresentMode::Capped || !lastFrameStart) return;
+
+    const auto deadline = *lastFrameStart + std::chrono::duration_cast<Clock::duration>(Duration{1.0 / settings.targetFps});
+    const auto waitStart = Clock::now();
+    if (waitStart >= deadline) return;
+
+    // Sleep wakes late by up to a scheduler tick, so it only covers the bulk of the wait
+    if (deadline - waitStart > SPIN_THRESHOLD) std::this_thread::sleep_until(deadline - SPIN_THRESHOLD);
+    while (Clock::now() < deadline) std::this_thread::yield();
+
+    stats.lastWaitMs = std::chrono::duration<double, std::milli>(Clock::now() - waitStart).count();
+}
+
+auto FrameLoop::BeginFrame() -> std::size_t {
+    const auto frameTime = WaitForFrame();
+    return frameTime ? Advance(*frameTime) : 0U;
+}
+
+auto FrameLoop::WaitForFrame() -> std::optional<Duration> {
+    WaitForFrameSlot();
+
+    // The first frame only starts the clock, it has no frame time to report
+    const auto previousFrameStart = std::exchange(lastFrameStart, Clock::now());
+    if (!previousFrameStart) return std::nullopt;
+
+    return Duration{*lastFrameStart - *previousFrameStart};
+}
+
+auto FrameLoop::Advance(Duration frameTime) -> std::size_t {
+    accumulator += frameTime;
+    auto numSteps = static_cast<std::size_t>(accumulator / step);
+    if (numSteps > settings.maxStepsPerFrame) {
+        stats.numDroppedSteps += numSteps - settings.maxStepsPerFrame;
+        numSteps = settings.maxStepsPerFrame;
+        // Dropped steps take their time with them so a stall isn't followed by frames of catching up
+        accumulator = Duration{std::fmod(accumulator.count(), step.count())};
+    } else {
+        accumulator -= step * static_cast<double>(numSteps);
+    }
+
+    stats.lastSteps = numSteps;
+    stats.numSteps += numSteps;
+    return numSteps;
+}
+
+auto FrameLoop::EndFrame() -> void {
+    if (!lastFrameStart) return;
+
+    const auto frameMs = std::chrono::duration<double, std::milli>(Clock::now() - *lastFrameStart).count();
+    stats.lastFrameMs = frameMs;
+    stats.avgFrameMs = stats.numFrames == 0U ? frameMs : stats.avgFrameMs + AVERAGE_WEIGHT * (frameMs - stats.avgFrameMs);
+    stats.minFrameMs = stats.numFrames == 0U ? frameMs : std::min(stats.minFrameMs, frameMs);
+    stats.maxFrameMs = std::max(stats.maxFrameMs, frameMs);
+    ++stats.numFrames;
+}
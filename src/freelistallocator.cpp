@@ -0,0 +1,120 @@
+#include "freelistallocator.h"
+
+#include "debugutils.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <format>
+#include <iterator>
+#include <optional>
+#include <ranges>
+#include <vector>
+
+FreeListAllocator::FreeListAllocator(std::uint32_t capacity)
+    : capacity{capacity}
+{
+    if (capacity > 0U) freeBlocks.emplace(0U, capacity);
+}
+
+auto FreeListAllocator::InsertFree(std::uint32_t offset, std::uint32_t size) -> void {
+    auto next = freeBlocks.lower_bound(offset);
+
+    if (next != freeBlocks.end() && offset + size == next->first) {
+        size += next->second;
+        next = freeBlocks.erase(next);
+    }
+
+    if (next != freeBlocks.begin()) {
+        auto previous = std::prev(next);
+        if (previous->first + previous->second == offset) {
+            previous->second += size;
+            return;
+        }
+    }
+
+    freeBlocks.emplace_hint(next, offset, size);
+}
+
+auto FreeListAllocator::Allocate(std::uint32_t size) -> std::optional<Handle> {
+    auto best = freeBlocks.end();
+
+    if (size > 0U) {
+        for (auto iter = freeBlocks.begin(); iter != freeBlocks.end(); ++iter) {
+            if (iter->second < size) continue;
+            if (best == freeBlocks.end() || iter->second < best->second) best = iter;
+            if (best->second == size) break;
+        }
+
+        if (best == freeBlocks.end()) return std::nullopt;
+    }
+
+    // Empty allocations never consume space
+    const auto offset = size > 0U ? best->first : 0U;
+    if (size > 0U) {
+        const auto remaining = best->second - size;
+        freeBlocks.erase(best);
+        if (remaining > 0U) freeBlocks.emplace(offset + size, remaining);
+    }
+
+    usedSize += size;
+
+    auto handle = Handle{};
+    if (!freeHandles.empty()) {
+        handle = freeHandles.back();
+        freeHandles.pop_back();
+    } else {
+        handle = static_cast<Handle>(blocks.size());
+        blocks.emplace_back();
+    }
+
+    blocks[handle] = Block{ .offset = offset, .size = size, .live = true };
+    return handle;
+}
+
+auto FreeListAllocator::Free(Handle handle) -> void {
+    auto& block = blocks.at(handle);
+    if (!block.live) {
+        DebugMessage("ERROR", "Double free of allocation {}", handle);
+        return;
+    }
+
+    if (block.size > 0U) InsertFree(block.offset, block.size);
+    usedSize -= block.size;
+    block = Block{};
+    freeHandles.push_back(handle);
+}
+
+auto FreeListAllocator::Grow(std::uint32_t newCapacity) -> void {
+    if (newCapacity <= capacity) return;
+    InsertFree(capacity, newCapacity - capacity);
+    capacity = newCapacity;
+}
+
+auto FreeListAllocator::Compact() -> std::vector<Relocation> {
+    auto relocations = std::vector<Relocation>{};
+
+    for (auto handle = Handle{0U}; handle < blocks.size(); ++handle) {
+        const auto& block = blocks[handle];
+        if (block.live && block.size > 0U) relocations.push_back(Relocation{ .handle = handle, .from = block.offset, .to = 0U, .size = block.size });
+    }
+
+    std::ranges::sort(relocations, {}, &Relocation::from);
+
+    auto cursor = std::uint32_t{0U};
+    for (auto& relocation : relocations) {
+        relocation.to = cursor;
+        blocks[relocation.handle].offset = cursor;
+        cursor += relocation.size;
+    }
+
+    freeBlocks.clear();
+    if (cursor < capacity) freeBlocks.emplace(cursor, capacity - cursor);
+
+    return relocations;
+}
+
+auto FreeListAllocator::LargestFreeBlock() const noexcept -> std::uint32_t {
+    auto largest = std::uint32_t{0U};
+    for (const auto& [offset, size] : freeBlocks) { largest = std::max(largest, size); }
+    return largest;
+}
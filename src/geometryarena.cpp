@@ -0,0 +1,139 @@
+#include "geometryarena.h"
+
+#include "debugutils.h"
+#include "freelistallocator.h"
+#include "glstate.h"
+#include "memorytracker.h"
+#include "meshcomponent.h"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <limits>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace {
+
+auto ByteSize(std::uint32_t numVertices) noexcept -> GLsizeiptr {
+    return static_cast<GLsizeiptr>(numVertices) * static_cast<GLsizeiptr>(sizeof(Vertex));
+}
+
+using GpuMemory = NamedMemoryTag<"GPU/Geometry arena">;
+
+auto CreateVertexBuffer(std::uint32_t capacity) -> GLuint {
+    auto buffer = GLuint{0U};
+    glCreateBuffers(1, &buffer);
+    glNamedBufferData(buffer, ByteSize(capacity), nullptr, GL_STATIC_DRAW);
+    GpuMemory::Counter().Add(static_cast<std::size_t>(ByteSize(capacity)));
+    return buffer;
+}
+
+auto DeleteVertexBuffer(GLuint buffer, std::uint32_t capacity) -> void {
+    GLState::GetInstance().BufferDeleted(buffer);
+    glDeleteBuffers(1, &buffer);
+    GpuMemory::Counter().Remove(static_cast<std::size_t>(ByteSize(capacity)));
+}
+
+}
+
+GeometryArena::GeometryArena(std::uint32_t capacity)
+    : allocator{capacity}
+{}
+
+GeometryArena::~GeometryArena() noexcept {
+    if (vao != 0U) {
+        GLState::GetInstance().VertexArrayDeleted(vao);
+        glDeleteVertexArrays(1, &vao);
+    }
+    if (vbo != 0U) DeleteVertexBuffer(vbo, vboCapacity);
+}
+
+auto GeometryArena::EnsureCreated() -> void {
+    if (vao != 0U) return;
+
+    // Draws are recorded against the vao name, so creation cannot be deferred
+    executor->RunSync([this] {
+        vboCapacity = allocator.Capacity();
+        vbo = CreateVertexBuffer(vboCapacity);
+
+        glCreateVertexArrays(1, &vao);
+        glVertexArrayVertexBuffer(vao, 0, vbo, 0, sizeof(Vertex));
+
+        glEnableVertexArrayAttrib(vao, 0);
+        glVertexArrayAttribFormat(vao, 0, 3, GL_FLOAT, GL_FALSE, offsetof(Vertex, position));
+        glVertexArrayAttribBinding(vao, 0, 0);
+
+        glEnableVertexArrayAttrib(vao, 1);
+        glVertexArrayAttribFormat(vao, 1, 3, GL_FLOAT, GL_FALSE, offsetof(Vertex, normal));
+        glVertexArrayAttribBinding(vao, 1, 0);
+    });
+}
+
+auto GeometryArena::Reallocate(std::uint32_t newCapacity, bool compact) -> void {
+    const auto oldCapacity = allocator.Capacity();
+    auto relocations = compact ? allocator.Compact() : std::vector<FreeListAllocator::Relocation>{};
+    allocator.Grow(newCapacity);
+
+    executor->Defer([this, newCapacity, oldCapacity, compact, relocations = std::move(relocations)] {
+        const auto newVbo = CreateVertexBuffer(newCapacity);
+
+        if (compact) {
+            for (const auto& relocation : relocations) {
+                glCopyNamedBufferSubData(vbo, newVbo, ByteSize(relocation.from), ByteSize(relocation.to), ByteSize(relocation.size));
+            }
+        } else if (oldCapacity > 0U) {
+            glCopyNamedBufferSubData(vbo, newVbo, 0, 0, ByteSize(oldCapacity));
+        }
+
+        DeleteVertexBuffer(vbo, vboCapacity);
+        vbo = newVbo;
+        vboCapacity = newCapacity;
+        glVertexArrayVertexBuffer(vao, 0, vbo, 0, sizeof(Vertex));
+    });
+}
+
+auto GeometryArena::Allocate(std::span<const Vertex> vertices) -> Handle {
+    EnsureCreated();
+
+    if (vertices.size() > std::numeric_limits<std::uint32_t>::max() / 2U) [[unlikely]] {
+        ThrowMessage("ERROR", "Mesh with {} vertices is too large for the geometry arena", vertices.size());
+    }
+
+    const auto numVertices = static_cast<std::uint32_t>(vertices.size());
+    auto handle = allocator.Allocate(numVertices);
+
+    if (!handle && allocator.FreeSize() >= numVertices) {
+        DebugMessage("INFO", "Defragmenting geometry arena ({} free blocks)", allocator.NumFreeBlocks());
+        Reallocate(allocator.Capacity(), true);
+        handle = allocator.Allocate(numVertices);
+    }
+
+    if (!handle) {
+        const auto newCapacity = std::max(allocator.Capacity() * 2U, allocator.UsedSize() + numVertices);
+        DebugMessage("INFO", "Growing geometry arena to {} vertices", newCapacity);
+        Reallocate(newCapacity, false);
+        handle = allocator.Allocate(numVertices);
+    }
+
+    if (numVertices > 0U) {
+        executor->Defer([this, offset = allocator.Offset(*handle), data = std::vector<Vertex>(vertices.begin(), vertices.end())] {
+            glNamedBufferSubData(vbo, ByteSize(offset), std::span(data).size_bytes(), data.data());
+        });
+    }
+
+    return *handle;
+}
+
+auto GeometryArena::Free(Handle handle) -> void {
+    allocator.Free(handle);
+}
+
+auto GeometryArena::Defragment() -> void {
+    if (vao == 0U) return;
+    Reallocate(allocator.Capacity(), true);
+}
@@ -0,0 +1,196 @@
+#include "glstate.h"
+
+#include <glad/glad.h>
+
+#include <array>
+#include <cstddef>
+#include <optional>
+
+namespace {
+
+auto BufferTargetSlot(GLenum target) noexcept -> std::optional<std::size_t> {
+    switch (target) {
+        case GL_ARRAY_BUFFER: return 0U;
+        case GL_ELEMENT_ARRAY_BUFFER: return 1U;
+        case GL_DRAW_INDIRECT_BUFFER: return 2U;
+        case GL_UNIFORM_BUFFER: return 3U;
+        case GL_SHADER_STORAGE_BUFFER: return 4U;
+        case GL_COPY_READ_BUFFER: return 5U;
+        case GL_COPY_WRITE_BUFFER: return 6U;
+        case GL_PIXEL_PACK_BUFFER: return 7U;
+        case GL_PIXEL_UNPACK_BUFFER: return 8U;
+        default: return std::nullopt;
+    }
+}
+
+auto IndexedTargetSlot(GLenum target) noexcept -> std::optional<std::size_t> {
+    switch (target) {
+        case GL_UNIFORM_BUFFER: return 0U;
+        case GL_SHADER_STORAGE_BUFFER: return 1U;
+        default: return std::nullopt;
+    }
+}
+
+auto CapabilitySlot(GLenum capability) noexcept -> std::optional<std::size_t> {
+    switch (capability) {
+        case GL_DEPTH_TEST: return 0U;
+        case GL_BLEND: return 1U;
+        case GL_CULL_FACE: return 2U;
+        case GL_SCISSOR_TEST: return 3U;
+        case GL_STENCIL_TEST: return 4U;
+        case GL_MULTISAMPLE: return 5U;
+        case GL_FRAMEBUFFER_SRGB: return 6U;
+        case GL_PRIMITIVE_RESTART: return 7U;
+        default: return std::nullopt;
+    }
+}
+
+constexpr auto ELEMENT_ARRAY_SLOT = std::size_t{1U};
+
+}
+
+auto GLState::GetInstance() noexcept -> GLState& {
+    static GLState state{};
+    return state;
+}
+
+auto GLState::UseProgram(GLuint newProgram) noexcept -> void {
+    Apply(program, newProgram, [&] { glUseProgram(newProgram); });
+}
+
+auto GLState::BindVertexArray(GLuint newVao) noexcept -> void {
+    Apply(vao, newVao, [&] {
+        glBindVertexArray(newVao);
+        // The element array binding belongs to the vertex array
+        buffers[ELEMENT_ARRAY_SLOT].reset();
+    });
+}
+
+auto GLState::BindBuffer(GLenum target, GLuint buffer) noexcept -> void {
+    const auto slot = BufferTargetSlot(target);
+    if (!slot) {
+        Forward();
+        glBindBuffer(target, buffer);
+        return;
+    }
+
+    Apply(buffers[*slot], buffer, [&] { glBindBuffer(target, buffer); });
+}
+
+auto GLState::BindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) noexcept -> void {
+    const auto slot = IndexedTargetSlot(target);
+    if (!slot || index >= MAX_INDEXED_BINDINGS) {
+        Forward();
+        glBindBufferRange(target, index, buffer, offset, size);
+        if (auto genericSlot = BufferTargetSlot(target)) buffers[*genericSlot] = buffer;
+        return;
+    }
+
+    Apply(bufferRanges[*slot][index], BufferRange{buffer, offset, size}, [&] {
+        glBindBufferRange(target, index, buffer, offset, size);
+        // Indexed binds also replace the target's generic binding
+        if (auto genericSlot = BufferTargetSlot(target)) buffers[*genericSlot] = buffer;
+    });
+}
+
+auto GLState::BindFramebuffer(GLenum target, GLuint framebuffer) noexcept -> void {
+    switch (target) {
+        case GL_DRAW_FRAMEBUFFER:
+            Apply(drawFramebuffer, framebuffer, [&] { glBindFramebuffer(target, framebuffer); });
+            return;
+        case GL_READ_FRAMEBUFFER:
+            Apply(readFramebuffer, framebuffer, [&] { glBindFramebuffer(target, framebuffer); });
+            return;
+        default:
+            if (drawFramebuffer == framebuffer && readFramebuffer == framebuffer) {
+                ++stats.elided;
+                return;
+            }
+
+            Forward();
+            glBindFramebuffer(target, framebuffer);
+            drawFramebuffer = framebuffer;
+            readFramebuffer = framebuffer;
+    }
+}
+
+auto GLState::Enable(GLenum capability) noexcept -> void {
+    const auto slot = CapabilitySlot(capability);
+    if (!slot) {
+        Forward();
+        glEnable(capability);
+        return;
+    }
+
+    Apply(capabilities[*slot], true, [&] { glEnable(capability); });
+}
+
+auto GLState::Disable(GLenum capability) noexcept -> void {
+    const auto slot = CapabilitySlot(capability);
+    if (!slot) {
+        Forward();
+        glDisable(capability);
+        return;
+    }
+
+    Apply(capabilities[*slot], false, [&] { glDisable(capability); });
+}
+
+auto GLState::DepthFunc(GLenum func) noexcept -> void {
+    Apply(depthFunc, func, [&] { glDepthFunc(func); });
+}
+
+auto GLState::DepthMask(bool enabled) noexcept -> void {
+    Apply(depthMask, enabled, [&] { glDepthMask(enabled ? GL_TRUE : GL_FALSE); });
+}
+
+auto GLState::BlendFunc(GLenum source, GLenum destination) noexcept -> void {
+    Apply(blendFunc, std::array{source, destination}, [&] { glBlendFunc(source, destination); });
+}
+
+auto GLState::CullFace(GLenum mode) noexcept -> void {
+    Apply(cullFace, mode, [&] { glCullFace(mode); });
+}
+
+auto GLState::Viewport(GLint x, GLint y, GLsizei width, GLsizei height) noexcept -> void {
+    Apply(viewport, std::array{x, y, width, height}, [&] { glViewport(x, y, width, height); });
+}
+
+auto GLState::ClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) noexcept -> void {
+    Apply(clearColor, std::array{red, green, blue, alpha}, [&] { glClearColor(red, green, blue, alpha); });
+}
+
+// A deleted name may be reused by the next object created, so its bindings are forgotten rather than assumed zero
+auto GLState::ProgramDeleted(GLuint deletedProgram) noexcept -> void {
+    if (program == deletedProgram) program.reset();
+}
+
+auto GLState::VertexArrayDeleted(GLuint deletedVao) noexcept -> void {
+    if (vao == deletedVao) {
+        vao.reset();
+        buffers[ELEMENT_ARRAY_SLOT].reset();
+    }
+}
+
+auto GLState::BufferDeleted(GLuint deletedBuffer) noexcept -> void {
+    for (auto& buffer : buffers) {
+        if (buffer == deletedBuffer) buffer.reset();
+    }
+
+    for (auto& ranges : bufferRanges) {
+        for (auto& range : ranges) {
+            if (range && range->buffer == deletedBuffer) range.reset();
+        }
+    }
+}
+
+auto GLState::FramebufferDeleted(GLuint deletedFramebuffer) noexcept -> void {
+    if (drawFramebuffer == deletedFramebuffer) drawFramebuffer.reset();
+    if (readFramebuffer == deletedFramebuffer) readFramebuffer.reset();
+}
+
+auto GLState::Invalidate() noexcept -> void {
+    const auto keptStats = stats;
+    *this = GLState{};
+    stats = keptStats;
+}
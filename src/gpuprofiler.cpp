@@ -0,0 +1,118 @@
+#include "gpuprofiler.h"
+
+#include "debugutils.h"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <format>
+#include <string>
+#include <string_view>
+
+namespace {
+
+constexpr auto NANOSECONDS_PER_MILLISECOND = 1'000'000.0;
+
+auto ElapsedMs(std::chrono::steady_clock::time_point start) noexcept -> double {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+}
+
+GpuProfiler::~GpuProfiler() noexcept {
+    for (auto& slot : slots) {
+        if (slot.queries.empty()) continue;
+        glDeleteQueries(static_cast<GLsizei>(slot.queries.size()), slot.queries.data());
+    }
+}
+
+auto GpuProfiler::AcquireQuery(FrameSlot& slot) -> GLuint {
+    if (slot.numQueriesUsed == slot.queries.size()) {
+        auto query = GLuint{0U};
+        glCreateQueries(GL_TIMESTAMP, 1, &query);
+        slot.queries.push_back(query);
+    }
+
+    return slot.queries[slot.numQueriesUsed++];
+}
+
+auto GpuProfiler::FindOrAddPass(std::string_view name) -> std::size_t {
+    const auto iter = std::ranges::find(passes, name, &PassStats::name);
+    if (iter != passes.cend()) return static_cast<std::size_t>(iter - passes.cbegin());
+
+    passes.push_back(PassStats{.name = std::string(name)});
+    return passes.size() - 1U;
+}
+
+auto GpuProfiler::Collect(FrameSlot& slot) -> void {
+    for (const auto& pending : slot.pending) {
+        if (!pending.ended) continue;
+
+        // Timestamps resolve in order, so an available end implies an available begin
+        auto available = GLint{0};
+        glGetQueryObjectiv(pending.endQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available == GL_FALSE) {
+            ++numDropped;
+            continue;
+        }
+
+        auto beginTime = GLuint64{0U};
+        auto endTime = GLuint64{0U};
+        glGetQueryObjectui64v(pending.beginQuery, GL_QUERY_RESULT, &beginTime);
+        glGetQueryObjectui64v(pending.endQuery, GL_QUERY_RESULT, &endTime);
+        passes[pending.passIndex].AddGpu(static_cast<double>(endTime - beginTime) / NANOSECONDS_PER_MILLISECOND);
+    }
+
+    slot.pending.clear();
+    slot.numQueriesUsed = 0U;
+}
+
+auto GpuProfiler::BeginFrame() -> void {
+    Collect(CurrentSlot());
+    framePass = BeginPass(FRAME_PASS);
+}
+
+auto GpuProfiler::EndFrame() -> void {
+    EndPass(framePass);
+    ++frame;
+
+    if (std::chrono::steady_clock::now() - lastSummary >= SUMMARY_INTERVAL) LogSummary();
+}
+
+auto GpuProfiler::BeginPass(std::string_view name) -> PassToken {
+    auto& slot = CurrentSlot();
+    const auto passIndex = FindOrAddPass(name);
+    const auto beginQuery = AcquireQuery(slot);
+    const auto endQuery = AcquireQuery(slot);
+
+    glQueryCounter(beginQuery, GL_TIMESTAMP);
+    slot.pending.push_back(PendingPass{
+        .passIndex = passIndex,
+        .beginQuery = beginQuery,
+        .endQuery = endQuery,
+        .cpuStart = std::chrono::steady_clock::now(),
+        .ended = false
+    });
+
+    return slot.pending.size() - 1U;
+}
+
+auto GpuProfiler::EndPass(PassToken token) noexcept -> void {
+    auto& pending = CurrentSlot().pending[token];
+    glQueryCounter(pending.endQuery, GL_TIMESTAMP);
+    pending.ended = true;
+    passes[pending.passIndex].AddCpu(ElapsedMs(pending.cpuStart));
+}
+
+auto GpuProfiler::LogSummary() noexcept -> void {
+    lastSummary = std::chrono::steady_clock::now();
+
+    for (auto& pass : passes) {
+        DebugMessage("INFO", "{:<12} cpu {:7.3f} ms  gpu {:7.3f} ms", pass.name, pass.AverageCpuMs(), pass.AverageGpuMs());
+        pass.ResetTotals();
+    }
+
+    if (numDropped > 0U) DebugMessage("INFO", "{} passes dropped waiting on GPU results", numDropped);
+}
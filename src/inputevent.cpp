@@ -0,0 +1,55 @@
+#include "inputevent.h"
+
+#include <cstddef>
+#include <vector>
+
+auto InputEvent::Key(int key, int scancode, int action, int mods) noexcept -> InputEvent {
+    auto event = InputEvent{.type = InputEventType::Key};
+    event.key = KeyEvent{.key = key, .scancode = scancode, .action = action, .mods = mods};
+    return event;
+}
+
+auto InputEvent::Char(unsigned int codePoint) noexcept -> InputEvent {
+    auto event = InputEvent{.type = InputEventType::Char};
+    event.character = CharEvent{.codePoint = codePoint};
+    return event;
+}
+
+auto InputEvent::MouseMove(double x, double y) noexcept -> InputEvent {
+    auto event = InputEvent{.type = InputEventType::MouseMove};
+    event.mouseMove = MouseMoveEvent{.x = x, .y = y};
+    return event;
+}
+
+auto InputEvent::MouseButton(int button, int action, int mods) noexcept -> InputEvent {
+    auto event = InputEvent{.type = InputEventType::MouseButton};
+    event.mouseButton = MouseButtonEvent{.button = button, .action = action, .mods = mods};
+    return event;
+}
+
+auto InputEvent::Scroll(double x, double y) noexcept -> InputEvent {
+    auto event = InputEvent{.type = InputEventType::Scroll};
+    event.scroll = ScrollEvent{.x = x, .y = y};
+    return event;
+}
+
+auto CoalesceInputEvents(std::vector<InputEvent>& events) noexcept -> void {
+    if (events.empty()) return;
+
+    auto last = std::size_t{0U};
+    for (auto i = std::size_t{1U}; i < events.size(); ++i) {
+        const auto& event = events[i];
+        auto& previous = events[last];
+
+        if (event.type == InputEventType::MouseMove && previous.type == InputEventType::MouseMove) {
+            previous.mouseMove = event.mouseMove;
+        } else if (event.type == InputEventType::Scroll && previous.type == InputEventType::Scroll) {
+            previous.scroll.x += event.scroll.x;
+            previous.scroll.y += event.scroll.y;
+        } else {
+            events[++last] = event;
+        }
+    }
+
+    events.resize(last + 1U);
+}
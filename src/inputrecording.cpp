@@ -0,0 +1,135 @@
+#include "inputrecording.h"
+
+#include "debugutils.h"
+#include "inputevent.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+template <typename T>
+auto WriteValue(std::ostream& output, const T& value) -> void {
+    static_assert(std::is_trivially_copyable_v<T>);
+    output.write(reinterpret_cast<const char*>(&value), sizeof(T)); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+}
+
+template <typename T>
+auto ReadValue(std::istream& input) -> T {
+    static_assert(std::is_trivially_copyable_v<T>);
+    auto value = T{};
+    input.read(reinterpret_cast<char*>(&value), sizeof(T)); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    return value;
+}
+
+// Every event takes at least its type, so this bounds how many the rest of the stream can hold
+auto MaxEventsLeft(std::istream& input) -> std::size_t {
+    const auto position = input.tellg();
+    // Streams that can't seek get a generous cap instead
+    if (position < 0) return std::numeric_limits<std::uint16_t>::max();
+
+    input.seekg(0, std::istream::end);
+    const auto end = input.tellg();
+    input.seekg(position);
+    return end > position ? static_cast<std::size_t>(end - position) / sizeof(InputEventType) : 0U;
+}
+
+auto WriteEvent(std::ostream& output, const InputEvent& event) -> void {
+    WriteValue(output, event.type);
+    switch (event.type) {
+    case InputEventType::Key: WriteValue(output, event.key); break;
+    case InputEventType::Char: WriteValue(output, event.character); break;
+    case InputEventType::MouseMove: WriteValue(output, event.mouseMove); break;
+    case InputEventType::MouseButton: WriteValue(output, event.mouseButton); break;
+    case InputEventType::Scroll: WriteValue(output, event.scroll); break;
+    }
+}
+
+auto ReadEvent(std::istream& input) -> InputEvent {
+    auto event = InputEvent{.type = ReadValue<InputEventType>(input)};
+    switch (event.type) {
+    case InputEventType::Key: event.key = ReadValue<KeyEvent>(input); break;
+    case InputEventType::Char: event.character = ReadValue<CharEvent>(input); break;
+    case InputEventType::MouseMove: event.mouseMove = ReadValue<MouseMoveEvent>(input); break;
+    case InputEventType::MouseButton: event.mouseButton = ReadValue<MouseButtonEvent>(input); break;
+    case InputEventType::Scroll: event.scroll = ReadValue<ScrollEvent>(input); break;
+    default: ThrowMessage("ERROR", "Input recording has unknown event type {}", static_cast<int>(event.type));
+    }
+    return event;
+}
+
+}
+
+auto InputRecording::Write(std::ostream& output) const -> void {
+    WriteValue(output, MAGIC);
+    WriteValue(output, VERSION);
+    WriteValue(output, numFrames);
+
+    for (const auto& frame : frames) {
+        WriteValue(output, frame.frame);
+        WriteValue(output, frame.time);
+        WriteValue(output, static_cast<std::uint32_t>(frame.events.size()));
+        for (const auto& event : frame.events) WriteEvent(output, event);
+    }
+}
+
+auto InputRecording::Save(const std::filesystem::path& filePath) const -> void {
+    auto file = std::ofstream(filePath, std::ofstream::binary | std::ofstream::trunc);
+    Write(file);
+    if (!file) ThrowMessage("ERROR", "Couldn't write input recording \"{}\"", filePath.string());
+}
+
+auto InputRecording::Read(std::istream& input) -> InputRecording {
+    if (ReadValue<std::uint32_t>(input) != MAGIC || !input) ThrowMessage("ERROR", "Not an input recording");
+    if (const auto version = ReadValue<std::uint32_t>(input); version != VERSION) ThrowMessage("ERROR", "Unsupported input recording version {}", version);
+
+    auto recording = InputRecording{};
+    recording.numFrames = ReadValue<std::uint32_t>(input);
+
+    while (input.peek() != std::istream::traits_type::eof()) {
+        auto& frame = recording.frames.emplace_back();
+        frame.frame = ReadValue<std::uint32_t>(input);
+        frame.time = ReadValue<double>(input);
+        const auto numEvents = ReadValue<std::uint32_t>(input);
+        // Checked before allocating, a corrupt count would otherwise ask for billions of events
+        if (!input || numEvents > MaxEventsLeft(input)) ThrowMessage("ERROR", "Input recording is truncated");
+        frame.events.resize(numEvents);
+        for (auto& event : frame.events) event = ReadEvent(input);
+
+        if (!input) ThrowMessage("ERROR", "Input recording is truncated");
+        if (frame.frame >= recording.numFrames || (recording.frames.size() > 1U && frame.frame <= recording.frames.rbegin()[1].frame)) {
+            ThrowMessage("ERROR", "Input recording has out of order frame {}", frame.frame);
+        }
+    }
+
+    return recording;
+}
+
+auto InputRecording::Load(const std::filesystem::path& filePath) -> InputRecording {
+    auto file = std::ifstream(filePath, std::ifstream::binary);
+    if (!file.is_open()) ThrowMessage("ERROR", "Couldn't open file \"{}\"", filePath.string());
+    return Read(file);
+}
+
+auto InputRecorder::RecordFrame(std::span<const InputEvent> events) -> void {
+    const auto now = std::chrono::steady_clock::now();
+    if (!start) start = now;
+
+    const auto frame = recording.numFrames++;
+    if (events.empty()) return;
+
+    recording.frames.push_back(RecordedFrame{
+        .frame = frame,
+        .time = std::chrono::duration<double>(now - *start).count(),
+        .events = std::vector<InputEvent>(events.begin(), events.end())
+    });
+}
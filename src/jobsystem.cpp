@@ -0,0 +1,309 @@
+#include "jobsystem.h"
+
+#include "cpuprofiler.h"
+#include "debugutils.h"
+#include "memorytracker.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stop_token>
+#include <thread>
+#include <utility>
+#include <vector>
+
+struct JobState {
+    JobTask task;
+    JobAffinity affinity;
+    // One for each unfinished dependency, plus one held by Submit until they are all registered
+    std::atomic<std::uint32_t> numBlockers{1U};
+
+    std::mutex mutex;
+    std::atomic<bool> done{false};
+    std::vector<std::shared_ptr<JobState>> continuations;
+};
+
+// Chunks are claimed from a shared counter, so a helper joining after they are all claimed does nothing
+struct ParallelBatch {
+    std::size_t count;
+    std::size_t grainSize;
+    std::size_t numChunks;
+    std::move_only_function<void(std::size_t, std::size_t)> body;
+
+    std::atomic<std::size_t> nextChunk{0U};
+    // Workers still inside RunChunks, the caller can't return while any of them might touch the batch
+    std::atomic<std::size_t> numHelpers{0U};
+    std::mutex errorMutex;
+    std::exception_ptr error;
+
+    [[nodiscard]] auto HasWork() const noexcept -> bool { return nextChunk.load(std::memory_order_relaxed) < numChunks; }
+
+    auto RunChunks() noexcept -> void {
+        for (auto chunk = nextChunk.fetch_add(1U); chunk < numChunks; chunk = nextChunk.fetch_add(1U)) {
+            const auto begin = chunk * grainSize;
+            try {
+                body(begin, std::min(begin + grainSize, count));
+            } catch (...) {
+                auto lock = std::scoped_lock{errorMutex};
+                if (!error) error = std::current_exception();
+            }
+        }
+    }
+};
+
+namespace {
+
+thread_local const JobSystem* currentSystem = nullptr;
+thread_local auto currentQueue = std::size_t{0U};
+
+}
+
+auto JobHandle::IsDone() const noexcept -> bool {
+    return !state || state->done.load(std::memory_order_acquire);
+}
+
+auto JobSystem::DefaultThreadCount() noexcept -> unsigned int {
+    const auto hardwareThreads = std::thread::hardware_concurrency();
+    return std::max(hardwareThreads, 2U) - 1U;
+}
+
+JobSystem::JobSystem(unsigned int numWorkers)
+    : mainThread{std::this_thread::get_id()}
+{
+    DebugMessage("INFO", "Starting job system with {} workers", numWorkers);
+
+    // The last queue takes submissions from threads that are not workers
+    queues.reserve(numWorkers + 1U);
+    for (auto i = 0U; i <= numWorkers; ++i) queues.push_back(std::make_unique<WorkQueue>());
+
+    // Created up front so they outlive a static job system, workers name themselves on start
+    // and their thread-local arenas give memory back to the tracker as they exit
+    auto& profiler = CpuProfiler::GetInstance();
+    static_cast<void>(MemoryTracker::GetInstance());
+    workers.reserve(numWorkers);
+    for (auto i = std::size_t{0U}; i < numWorkers; ++i) {
+        workers.emplace_back([this, &profiler, i](std::stop_token stopToken) {
+            profiler.SetThreadName(std::format("Job worker {}", i));
+            WorkerLoop(stopToken, i);
+        });
+    }
+}
+
+JobSystem::~JobSystem() noexcept {
+    for (auto& worker : workers) { worker.request_stop(); }
+    workReady.notify_all();
+}
+
+auto JobSystem::GetInstance() -> JobSystem& {
+    static auto instance = JobSystem{};
+    return instance;
+}
+
+auto JobSystem::CurrentQueue() const noexcept -> std::size_t {
+    return currentSystem == this ? currentQueue : queues.size() - 1U;
+}
+
+auto JobSystem::Submit(JobTask task, std::span<const JobHandle> dependencies, JobAffinity affinity) -> JobHandle {
+    auto job = std::make_shared<JobState>();
+    job->task = std::move(task);
+    job->affinity = affinity;
+
+    for (const auto& dependency : dependencies) {
+        if (!dependency.state) continue;
+
+        auto lock = std::scoped_lock{dependency.state->mutex};
+        if (dependency.state->done.load(std::memory_order_relaxed)) continue;
+        job->numBlockers.fetch_add(1U, std::memory_order_relaxed);
+        dependency.state->continuations.push_back(job);
+    }
+
+    auto handle = JobHandle{job};
+    Release(std::move(job));
+    return handle;
+}
+
+auto JobSystem::Release(std::shared_ptr<JobState> job) -> void {
+    if (job->numBlockers.fetch_sub(1U, std::memory_order_acq_rel) == 1U) Schedule(std::move(job));
+}
+
+auto JobSystem::Schedule(std::shared_ptr<JobState> job) -> void {
+    if (job->affinity == JobAffinity::MainThread) {
+        auto lock = std::scoped_lock{mainThreadMutex};
+        mainThreadJobs.push_back(std::move(job));
+        return;
+    }
+
+    {
+        auto& queue = *queues[CurrentQueue()];
+        auto lock = std::scoped_lock{queue.mutex};
+        // Counted before it can be popped so the count never dips below the real number of jobs
+        numQueued.fetch_add(1U, std::memory_order_release);
+        queue.jobs.push_back(std::move(job));
+    }
+
+    // A worker between checking the count and sleeping holds the mutex, so this can't slip in unseen
+    { auto lock = std::scoped_lock{sleepMutex}; }
+    workReady.notify_one();
+}
+
+auto JobSystem::Run(const std::shared_ptr<JobState>& job) -> void {
+    try {
+        job->task();
+    } catch (const std::exception& exception) {
+        DebugMessage("ERROR", "Job threw: {}", exception.what());
+    } catch (...) {
+        DebugMessage("ERROR", "Job threw something other than an exception");
+    }
+    // Captures are released before anyone waiting can see the job as done
+    job->task = nullptr;
+
+    auto continuations = std::vector<std::shared_ptr<JobState>>{};
+    {
+        auto lock = std::scoped_lock{job->mutex};
+        job->done.store(true, std::memory_order_release);
+        continuations.swap(job->continuations);
+    }
+    for (auto& continuation : continuations) Release(std::move(continuation));
+}
+
+auto JobSystem::TryRunOne(std::size_t queue) -> bool {
+    auto job = std::shared_ptr<JobState>{};
+
+    // Newest first from our own queue keeps its data warm, oldest first from the others takes the biggest pieces
+    {
+        auto& own = *queues[queue];
+        auto lock = std::scoped_lock{own.mutex};
+        if (!own.jobs.empty()) {
+            job = std::move(own.jobs.back());
+            own.jobs.pop_back();
+        }
+    }
+
+    for (auto offset = std::size_t{1U}; !job && offset < queues.size(); ++offset) {
+        auto& victim = *queues[(queue + offset) % queues.size()];
+        auto lock = std::scoped_lock{victim.mutex};
+        if (victim.jobs.empty()) continue;
+        job = std::move(victim.jobs.front());
+        victim.jobs.pop_front();
+    }
+
+    if (!job) return false;
+
+    numQueued.fetch_sub(1U, std::memory_order_relaxed);
+    Run(job);
+    return true;
+}
+
+auto JobSystem::TryRunMainThreadJob() -> bool {
+    auto job = std::shared_ptr<JobState>{};
+    {
+        auto lock = std::scoped_lock{mainThreadMutex};
+        if (mainThreadJobs.empty()) return false;
+        job = std::move(mainThreadJobs.front());
+        mainThreadJobs.pop_front();
+    }
+
+    Run(job);
+    return true;
+}
+
+auto JobSystem::Wait(const JobHandle& handle) -> void {
+    if (handle.state && handle.state->affinity == JobAffinity::MainThread && IsMainThread() && !handle.IsDone()) {
+        ThrowMessage("ERROR", "The main thread can't wait on a main-thread job, it only runs from RunMainThreadJobs");
+    }
+
+    const auto queue = CurrentQueue();
+    while (!handle.IsDone()) {
+        if (TryRunOne(queue)) continue;
+        // Whatever is left is already running elsewhere
+        std::this_thread::yield();
+    }
+}
+
+auto JobSystem::WaitAll(std::span<const JobHandle> handles) -> void {
+    for (const auto& handle : handles) Wait(handle);
+}
+
+auto JobSystem::RunParallelFor(std::size_t count, std::size_t grainSize, RangeTask body) -> void {
+    grainSize = std::max(grainSize, std::size_t{1U});
+    const auto numChunks = (count + grainSize - 1U) / grainSize;
+    if (numChunks <= 1U || workers.empty()) {
+        if (count > 0U) body(std::size_t{0U}, count);
+        return;
+    }
+
+    auto batch = ParallelBatch{.count = count, .grainSize = grainSize, .numChunks = numChunks, .body = std::move(body)};
+    {
+        auto lock = std::scoped_lock{batchMutex};
+        openBatches.push_back(&batch);
+    }
+    // Same handshake as Schedule, a worker about to sleep either sees the batch or gets woken
+    { auto lock = std::scoped_lock{sleepMutex}; }
+    workReady.notify_all();
+
+    batch.RunChunks();
+
+    // Once it is unlisted no worker can join, the ones already in are only finishing chunks they claimed
+    {
+        auto lock = std::scoped_lock{batchMutex};
+        std::erase(openBatches, &batch);
+    }
+    while (batch.numHelpers.load(std::memory_order_acquire) > 0U) std::this_thread::yield();
+
+    if (batch.error) std::rethrow_exception(batch.error);
+}
+
+auto JobSystem::HasBatchWork() const -> bool {
+    auto lock = std::scoped_lock{batchMutex};
+    return std::ranges::any_of(openBatches, [](const ParallelBatch* batch) { return batch->HasWork(); });
+}
+
+auto JobSystem::TryHelpBatch() -> bool {
+    auto* batch = [this]() -> ParallelBatch* {
+        auto lock = std::scoped_lock{batchMutex};
+        const auto open = std::ranges::find_if(openBatches, [](const ParallelBatch* batch) { return batch->HasWork(); });
+        if (open == openBatches.end()) return nullptr;
+        (*open)->numHelpers.fetch_add(1U, std::memory_order_relaxed);
+        return *open;
+    }();
+    if (!batch) return false;
+
+    batch->RunChunks();
+    batch->numHelpers.fetch_sub(1U, std::memory_order_release);
+    return true;
+}
+
+auto JobSystem::RunMainThreadJobs(std::chrono::microseconds budget) -> std::size_t {
+    auto zone = ProfileZone{"JobSystem::RunMainThreadJobs"};
+    const auto start = std::chrono::steady_clock::now();
+    auto numRun = std::size_t{0U};
+
+    while (numRun == 0U || std::chrono::steady_clock::now() - start < budget) {
+        if (!TryRunMainThreadJob()) break;
+        ++numRun;
+    }
+
+    return numRun;
+}
+
+auto JobSystem::WorkerLoop(std::stop_token stopToken, std::size_t queue) -> void {
+    currentSystem = this;
+    currentQueue = queue;
+
+    while (true) {
+        // A batch has its caller waiting on it, so it comes before queued jobs
+        if (TryHelpBatch()) continue;
+        if (TryRunOne(queue)) continue;
+
+        // Stopping still drains the queues, the wait only gives up once nothing is left
+        auto lock = std::unique_lock{sleepMutex};
+        if (!workReady.wait(lock, stopToken, [this] { return numQueued.load(std::memory_order_acquire) > 0U || HasBatchWork(); })) return;
+    }
+}
@@ -0,0 +1,185 @@
+#include "logger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <format>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+auto ParseLogLevel(std::string_view name) noexcept -> LogLevel {
+    if (name == "INFO") return LogLevel::Info;
+    if (name == "WARN") return LogLevel::Warn;
+    if (name == "CRASH") return LogLevel::Crash;
+    return LogLevel::Error;
+}
+
+auto LogLevelName(LogLevel level) noexcept -> std::string_view {
+    switch (level) {
+    case LogLevel::Info: return "INFO";
+    case LogLevel::Warn: return "WARN";
+    case LogLevel::Error: return "ERROR";
+    case LogLevel::Crash: return "CRASH";
+    case LogLevel::Off: return "OFF";
+    }
+    return "UNKNOWN";
+}
+
+Logger::Logger()
+    : worker{[this](std::stop_token stopToken) { WorkerLoop(std::move(stopToken)); }}
+{}
+
+Logger::~Logger() noexcept {
+    worker.request_stop();
+    flushRequested.notify_all();
+    if (worker.joinable()) worker.join();
+}
+
+auto Logger::GetInstance() -> Logger& {
+    static Logger logger{};
+    return logger;
+}
+
+auto Logger::GetThreadBuffer() -> ThreadBuffer& {
+    // The logger keeps its own reference so whatever a finished thread logged is still written
+    thread_local auto buffer = std::shared_ptr<ThreadBuffer>{};
+    if (!buffer) {
+        buffer = std::make_shared<ThreadBuffer>();
+        auto lock = std::scoped_lock{buffersMutex};
+        buffers.push_back(buffer);
+    }
+    return *buffer;
+}
+
+auto Logger::GetRateLimit(const void* site) -> RateLimit& {
+    thread_local auto limits = std::unordered_map<const void*, RateLimit>{};
+    return limits[site];
+}
+
+auto Logger::PassRateLimit(const void* site, std::chrono::steady_clock::time_point now, std::uint32_t& numSuppressed) -> bool {
+    if (site == nullptr || !rateLimiting.load(std::memory_order_relaxed)) return true;
+
+    auto& limit = GetRateLimit(site);
+    if (now - limit.windowStart >= RATE_LIMIT_WINDOW) {
+        limit.windowStart = now;
+        limit.numLogged = 0U;
+    }
+
+    if (limit.numLogged == RATE_LIMIT_MESSAGES) {
+        ++limit.numSuppressed;
+        return false;
+    }
+
+    ++limit.numLogged;
+    numSuppressed = std::exchange(limit.numSuppressed, 0U);
+    return true;
+}
+
+auto Logger::Submit(const LogRecord& record) -> void {
+    // A full buffer drops the message, the count is reported once the logger thread catches up
+    (void) GetThreadBuffer().records.TryPush(record);
+}
+
+auto Logger::SetSink(Sink newSink) -> void {
+    auto lock = std::scoped_lock{sinkMutex};
+    sink = std::move(newSink);
+}
+
+auto Logger::Flush() -> void {
+    if (std::this_thread::get_id() == worker.get_id()) return;
+
+    auto lock = std::unique_lock{flushMutex};
+    const auto ticket = ++flushRequests;
+    flushRequested.notify_all();
+    flushed.wait(lock, [&] { return flushesDone >= ticket; });
+}
+
+auto Logger::Drain(std::vector<std::shared_ptr<ThreadBuffer>>& snapshot, std::vector<LogRecord>& batch, std::string& line) -> void {
+    {
+        auto lock = std::scoped_lock{buffersMutex};
+        std::erase_if(buffers, [](const auto& buffer) { return buffer.use_count() == 1 && buffer->records.Size() == 0U; });
+        snapshot.assign(buffers.begin(), buffers.end());
+    }
+
+    batch.clear();
+    auto numDropped = std::size_t{0U};
+    for (const auto& buffer : snapshot) {
+        buffer->records.Drain([&](const LogRecord& record) { batch.push_back(record); });
+
+        const auto dropped = buffer->records.NumDropped();
+        numDropped += dropped - std::exchange(buffer->numDroppedReported, dropped);
+    }
+    // Holding on to the references would keep finished threads' buffers from ever being erased
+    snapshot.clear();
+
+    // Each thread's records are already in order, sorting interleaves them the way they happened
+    std::ranges::stable_sort(batch, {}, &LogRecord::time);
+
+    auto output = std::string{};
+    auto lock = std::scoped_lock{sinkMutex};
+    auto Emit = [&](LogLevel level) {
+        if (sink) {
+            sink(level, line);
+        } else {
+            output += line;
+            output += '\n';
+        }
+    };
+
+    for (const auto& record : batch) {
+        line.clear();
+        std::format_to(std::back_inserter(line), "[{:<7}]: ", LogLevelName(record.level));
+        record.format(record, line);
+        if (record.numSuppressed > 0U) std::format_to(std::back_inserter(line), " ({} similar messages suppressed)", record.numSuppressed);
+        Emit(record.level);
+    }
+
+    if (numDropped > 0U) {
+        line = std::format("[{:<7}]: Logger buffers were full, {} messages dropped", LogLevelName(LogLevel::Warn), numDropped);
+        Emit(LogLevel::Warn);
+    }
+
+    if (!output.empty()) {
+        std::fwrite(output.data(), 1U, output.size(), stdout);
+        std::fflush(stdout);
+    }
+}
+
+auto Logger::WorkerLoop(std::stop_token stopToken) -> void {
+    auto snapshot = std::vector<std::shared_ptr<ThreadBuffer>>{};
+    auto batch = std::vector<LogRecord>{};
+    auto line = std::string{};
+
+    auto FinishFlush = [&](std::uint64_t ticket) {
+        {
+            auto lock = std::scoped_lock{flushMutex};
+            flushesDone = std::max(flushesDone, ticket);
+        }
+        flushed.notify_all();
+    };
+
+    while (!stopToken.stop_requested()) {
+        const auto ticket = [&] {
+            auto lock = std::unique_lock{flushMutex};
+            flushRequested.wait_for(lock, stopToken, FLUSH_INTERVAL, [&] { return flushRequests != flushesDone; });
+            return flushRequests;
+        }();
+
+        Drain(snapshot, batch, line);
+        FinishFlush(ticket);
+    }
+
+    // Whatever was logged before shutdown still goes out
+    const auto ticket = [&] {
+        auto lock = std::scoped_lock{flushMutex};
+        return flushRequests;
+    }();
+    Drain(snapshot, batch, line);
+    FinishFlush(ticket);
+}
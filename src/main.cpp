@@ -1,8 +1,27 @@
+#include "benchmark.h"
 #include "cameracomponent.h"
+#include "commandlist.h"
+#include "cpuprofiler.h"
 #include "ecsmanager.h"
+#include "framearena.h"
+#include "frameloop.h"
+#include "geometryarena.h"
+#include "glstate.h"
+#include "gpuprofiler.h"
 #include "inputcomponent.h"
+#include "inputrecording.h"
+#include "jobsystem.h"
+#include "logger.h"
+#include "meshcache.h"
 #include "meshcomponent.h"
+#include "meshloader.h"
+#include "memorytracker.h"
+#include "occludercomponent.h"
+#include "programcache.h"
+#include "renderdevice.h"
 #include "renderer.h"
+#include "rendertarget.h"
+#include "renderthread.h"
 #include "transformcomponent.h"
 #include "window.h"
 
@@ -10,42 +29,255 @@
 #define GLFW_INCLUDE_NONE
 #include <GLFW/glfw3.h>
 
-auto main() noexcept -> int try {
-    Window::Initialize();
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <format>
+#include <fstream>
+#include <optional>
+#include <print>
+#include <utility>
+#include <string_view>
+#include <vector>
+
+constexpr auto MESH_UPLOAD_BUDGET = std::chrono::microseconds{2'000};
+constexpr auto MAIN_THREAD_JOB_BUDGET = std::chrono::microseconds{1'000};
+
+// Benchmark scene, a grid of meshes orbited by the camera at a fixed step per simulation step
+constexpr auto BENCHMARK_GRID_SIZE = 16;
+constexpr auto BENCHMARK_GRID_SPACING = 3.0F;
+constexpr auto BENCHMARK_CAMERA_DISTANCE = 40.0F;
+constexpr auto BENCHMARK_ORBIT_STEP = 0.01F;
+
+namespace {
+
+auto OrbitTransform(float angle) noexcept -> TransformComponent {
+    const auto rotation = glm::angleAxis(angle, glm::vec3(0.0F, 1.0F, 0.0F));
+    return TransformComponent{glm::vec3(1.0F), rotation, rotation * glm::vec3(0.0F, 0.0F, BENCHMARK_CAMERA_DISTANCE)};
+}
+
+}
+
+auto main(int argc, char** argv) noexcept -> int try {
+    const auto args = std::vector<std::string_view>(argv + 1, argv + argc);
+    const auto options = BenchmarkOptions::Parse(args);
+
+    // A benchmark without --output prints its report to stdout, logging moves to stderr so the JSON stays parseable
+    if (options.IsBenchmark() && !options.outputPath) {
+        Logger::GetInstance().SetSink([](LogLevel, std::string_view line) { std::println(stderr, "{}", line); });
+    }
+
+    // Started here so this is the thread that owns main-thread jobs
+    auto& jobSystem = JobSystem::GetInstance();
+
+    // Benchmarks run uncapped by default so frame times are not limited by the display
+    auto frameLoop = FrameLoop{FrameLoopSettings{
+        .presentMode = options.presentMode.value_or(options.IsBenchmark() ? PresentMode::Uncapped : PresentMode::Vsync),
+        .targetFps = options.targetFps.value_or(DEFAULT_TARGET_FPS)
+    }};
+    Window::Initialize(WindowSettings{.visible = !options.headless, .vsync = frameLoop.GetSettings().SwapInterval() == 1});
+
+    // Declared before the ECS so it outlives every mesh allocated from it
+    auto geometryArena = GeometryArena{};
 
     auto ecs = ECSManager<
         BasicCompManager<MeshComponent>,
         BasicCompManager<CameraComponent>,
-        BasicCompManager<TransformComponent>
+        BasicCompManager<TransformComponent>,
+        BasicCompManager<OccluderComponent>
     >{};
 
-    GLFWInputAdapter::Initialize(Window::GetWindow());
-    auto inputSystem = InputSystem{GLFWInputAdapter::GetInstance()};
+    // A replay stands in for the window's input entirely, live callbacks are never installed
+    auto replayAdapter = std::optional<ReplayInputAdapter>{};
+    if (options.replayInputPath) replayAdapter.emplace(InputRecording::Load(*options.replayInputPath));
+    auto inputRecorder = InputRecorder{};
+
     auto dbgIC = DebugInputComponent{};
-    inputSystem.RegisterInputComponent(dbgIC);
+    auto replayInput = std::optional<InputSystem<ReplayInputAdapter>>{};
+    auto liveInput = std::optional<InputSystem<GLFWInputAdapter>>{};
+    if (replayAdapter) {
+        replayInput.emplace(*replayAdapter);
+        replayInput->RegisterInputComponent(dbgIC);
+    } else {
+        auto& inputAdapter = GLFWInputAdapter::Initialize(Window::GetWindow());
+        if (options.recordInputPath) inputAdapter.SetRecorder(&inputRecorder);
+        liveInput.emplace(inputAdapter);
+        liveInput->RegisterInputComponent(dbgIC);
+    }
+    auto UpdateInput = [&] {
+        if (replayInput) {
+            // Still polled so the window stays responsive
+            glfwPollEvents();
+            replayInput->Update();
+        } else {
+            liveInput->Update();
+        }
+    };
 
-    auto renderer = Renderer{ecs};
-    auto renderMesh = ecs.NewEntity().value(); // NOLINT
-    ecs.NewComponent<MeshComponent>(renderMesh, Mesh::ReadObj(DATA_DIR "tris.obj"));
+    auto programCache = ProgramCache{PROGRAM_CACHE_DIR};
+    auto renderer = Renderer{ecs, programCache};
+    auto renderDevice = RenderDevice{};
+    auto meshCache = MeshCache{geometryArena};
+    auto meshLoader = MeshLoader{meshCache};
+    if (options.IsBenchmark()) {
+        constexpr auto gridOffset = 0.5F * BENCHMARK_GRID_SPACING * static_cast<float>(BENCHMARK_GRID_SIZE - 1);
+        for (auto x = 0; x < BENCHMARK_GRID_SIZE; ++x) {
+            for (auto z = 0; z < BENCHMARK_GRID_SIZE; ++z) {
+                auto entity = ecs.NewEntity().value(); // NOLINT
+                const auto position = glm::vec3(BENCHMARK_GRID_SPACING * static_cast<float>(x) - gridOffset, 0.0F, BENCHMARK_GRID_SPACING * static_cast<float>(z) - gridOffset);
+                ecs.NewComponent<TransformComponent>(entity, glm::vec3(1.0F), glm::quat(1.0F, 0.0F, 0.0F, 0.0F), position);
+                meshLoader.LoadAsync(ecs, entity, DATA_DIR "tris.obj");
+            }
+        }
+    } else {
+        auto renderMesh = ecs.NewEntity().value(); // NOLINT
+        meshLoader.LoadAsync(ecs, renderMesh, DATA_DIR "tris.obj");
+    }
 
     auto camera = ecs.NewEntity().value(); // NOLINT
     ecs.NewComponent<CameraComponent>(camera, 45.0F, Window::GetAspectRatio(), 0.1F, 100.0F); // NOLINT (cppcoreguidelines-avoid-magic-numbers)
 
-    ecs.NewComponent<TransformComponent>(camera, glm::vec3(1.0F), glm::mat4(1.0F), glm::vec3(0.0F, 0.0F, 10.0F)); // NOLINT (cppcoreguidelines-avoid-magic-numbers)
+    const auto cameraDistance = options.IsBenchmark() ? BENCHMARK_CAMERA_DISTANCE : 10.0F; // NOLINT (cppcoreguidelines-avoid-magic-numbers)
+    ecs.NewComponent<TransformComponent>(camera, glm::vec3(1.0F), glm::quat(1.0F, 0.0F, 0.0F, 0.0F), glm::vec3(0.0F, 0.0F, cameraDistance));
 
     renderer.activeCamera = camera;
 
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_LESS);
+    auto profiler = GpuProfiler{};
+    auto& glState = GLState::GetInstance();
+    glState.Enable(GL_DEPTH_TEST);
+    glState.DepthFunc(GL_LESS);
+    glState.Enable(GL_CULL_FACE);
+
+    // Headless runs draw into an offscreen target the size of the hidden window's framebuffer
+    auto renderTarget = std::optional<RenderTarget>{};
+    if (options.headless) {
+        const auto [width, height] = Window::GetFramebufferSize();
+        renderTarget.emplace(width, height);
+        renderTarget->Bind();
+    }
+
+    // Everything GL from here on happens on the render thread, declared last so it hands the context back first
+    auto renderThread = RenderThread{Window::GetWindow(), [&](const CommandList& commands) {
+        profiler.BeginFrame();
+
+        {
+            auto pass = profiler.Scope("Clear");
+            glState.ClearColor(0.2F, 0.3F, 0.3F, 1.0F); // NOLINT (cppcoreguidelines-avoid-magic-numbers)
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        }
+
+        {
+            auto pass = profiler.Scope("Meshes");
+            renderDevice.Replay(commands);
+        }
+
+        profiler.EndFrame();
+    }, !options.headless};
+    geometryArena.SetExecutor(renderThread);
+
+    auto commands = CommandList{};
+    auto recorder = BenchmarkRecorder{};
+    recorder.Reserve(options.numFrames);
+    auto frameIndex = std::size_t{0U};
+
+    // The benchmark camera's last two simulated states
+    auto orbitAngle = 0.0F;
+    auto previousCamera = OrbitTransform(orbitAngle);
+    auto currentCamera = previousCamera;
+
+    // Benchmarks trace only the measured frames, interactive runs the whole session
+    auto& cpuProfiler = CpuProfiler::GetInstance();
+    cpuProfiler.SetThreadName("Main");
+    if (options.tracePath && !ProfilingEnabled) DebugMessage("WARN", "Profiling zones are compiled out, configure with ENABLE_PROFILING to fill the trace");
+    if (options.tracePath && !options.IsBenchmark()) cpuProfiler.BeginCapture();
 
     while (glfwWindowShouldClose(Window::GetWindow()) != GLFW_TRUE) {
-        glClearColor(0.2F, 0.3F, 0.3F, 1.0F); // NOLINT (cppcoreguidelines-avoid-magic-numbers)
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        // Benchmarks stop after their frame count, anything else replayed ends with the recording
+        if (replayAdapter && replayAdapter->Finished() && !options.IsBenchmark()) {
+            DebugMessage("INFO", "Input replay finished");
+            break;
+        }
+
+        if (cpuProfiler.IsCapturing()) cpuProfiler.Collect();
+        // Scratch handed out during the last frame on any thread is dead from here on
+        FrameArena::BeginFrame();
+        auto frameZone = ProfileZone{"Frame"};
+
+        // Input is sampled right after the frame slot opens so it is as fresh as possible.
+        // Benchmarks still wait for their slot but simulate exactly one step per frame, so every run draws the same frames
+        auto numSteps = std::size_t{0U};
+        if (options.IsBenchmark()) {
+            static_cast<void>(frameLoop.WaitForFrame());
+            numSteps = frameLoop.Advance(frameLoop.StepDuration());
+        } else {
+            numSteps = frameLoop.BeginFrame();
+        }
+        UpdateInput();
+
+        // Nothing is simulated interactively yet, only the benchmark camera moves
+        if (options.IsBenchmark()) {
+            auto simulateZone = ProfileZone{"Simulate"};
+            for (auto i = std::size_t{0U}; i < numSteps; ++i) {
+                previousCamera = currentCamera;
+                orbitAngle += BENCHMARK_ORBIT_STEP;
+                currentCamera = OrbitTransform(orbitAngle);
+            }
+            ecs.GetComponent<TransformComponent>(camera) = TransformComponent::Interpolate(previousCamera, currentCamera, frameLoop.Alpha());
+        }
+
+        // Jobs that touch the ECS run here, between simulation and recording, and nowhere else
+        jobSystem.RunMainThreadJobs(MAIN_THREAD_JOB_BUDGET);
+        // Uploads are deferred onto the render thread and run before this frame is drawn
+        meshLoader.UploadLoaded(ecs, MESH_UPLOAD_BUDGET);
+        renderer.Record(commands);
+
+        const auto [width, height] = renderTarget ? std::pair{renderTarget->Width(), renderTarget->Height()} : Window::GetFramebufferSize();
+        commands.viewportWidth = width;
+        commands.viewportHeight = height;
+
+        renderThread.Submit(commands);
+        // Submit waits for the render thread to take the last frame, so a slow render side shows up here too
+        frameLoop.EndFrame();
 
-        renderer.RenderMeshes();
+        if (!options.IsBenchmark()) continue;
+
+        // Measuring starts once warm-up is over and every mesh has loaded
+        ++frameIndex;
+        if (frameIndex <= options.numWarmupFrames || meshLoader.NumPending() > 0U) continue;
+
+        if (options.tracePath && !cpuProfiler.IsCapturing()) cpuProfiler.BeginCapture();
+
+        const auto& renderStats = renderer.GetRenderStats();
+        recorder.AddFrame(frameLoop.GetStats().lastFrameMs, renderStats.numDrawCalls, renderStats.numTriangles);
+        if (recorder.NumFrames() == options.numFrames) break;
+    }
+
+    if (options.recordInputPath) inputRecorder.GetRecording().Save(*options.recordInputPath);
+
+    if (options.tracePath) {
+        cpuProfiler.EndCapture();
+        if (cpuProfiler.NumDropped() > 0U) DebugMessage("WARN", "Trace is missing {} zones", cpuProfiler.NumDropped());
+        cpuProfiler.WriteChromeTrace(*options.tracePath);
+    }
+
+    // Taken while every subsystem is still alive, so the report shows what the session ended holding
+    const auto memoryReport = std::format("{}\n{}", ecs.GetMemoryStats().Report(), MemoryTracker::GetInstance().Report());
+    // Written directly rather than logged, so release builds that only log warnings still get it
+    if (options.memoryReportPath) {
+        auto reportFile = std::ofstream(*options.memoryReportPath);
+        reportFile << memoryReport;
+    } else {
+        Logger::GetInstance().Flush();
+        std::print(stderr, "Memory on exit\n{}", memoryReport);
+    }
 
-        glfwSwapBuffers(Window::GetWindow());
-        glfwPollEvents();
+    if (options.IsBenchmark()) {
+        if (options.outputPath) {
+            auto outputFile = std::ofstream(*options.outputPath);
+            outputFile << recorder.ToJson();
+        } else {
+            std::print("{}", recorder.ToJson());
+        }
     }
 
     return 0;
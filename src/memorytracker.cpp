@@ -0,0 +1,79 @@
+#include "memorytracker.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if __has_include(<cxxabi.h>)
+#include <cxxabi.h>
+#define MEMORY_TRACKER_DEMANGLE 1
+#endif
+
+auto MemoryTracker::GetInstance() -> MemoryTracker& {
+    static auto instance = MemoryTracker{};
+    return instance;
+}
+
+auto MemoryTracker::GetCounter(std::string_view name) -> MemoryCounter& {
+    auto lock = std::scoped_lock{countersMutex};
+    if (const auto found = counters.find(name); found != counters.end()) return *found->second;
+    return *counters.emplace(std::string(name), std::make_unique<MemoryCounter>()).first->second;
+}
+
+auto MemoryTracker::Snapshot() const -> std::vector<MemoryCounterSnapshot> {
+    auto lock = std::scoped_lock{countersMutex};
+    auto snapshot = std::vector<MemoryCounterSnapshot>{};
+    snapshot.reserve(counters.size());
+    for (const auto& [name, counter] : counters) {
+        snapshot.push_back(MemoryCounterSnapshot{.name = name, .bytes = counter->Bytes(), .highWater = counter->HighWater(), .numAllocations = counter->NumAllocations()});
+    }
+    return snapshot;
+}
+
+auto MemoryTracker::Report() const -> std::string {
+    auto report = std::format("{:<48} {:>12} {:>12} {:>12}\n", "Counter", "Live", "Peak", "Allocations");
+    for (const auto& counter : Snapshot()) {
+        report += std::format("{:<48} {:>12} {:>12} {:>12}\n", counter.name, FormatBytes(counter.bytes), FormatBytes(counter.highWater), counter.numAllocations);
+    }
+    return report;
+}
+
+auto EcsMemoryStats::Report() const -> std::string {
+    auto report = std::format("Entities: {} of {} slots live, {}\n", numLiveEntities, numEntitySlots, FormatBytes(static_cast<std::int64_t>(entitySlotBytes)));
+    report += std::format("{:<48} {:>10} {:>10} {:>8} {:>12} {:>12}\n", "Component", "Count", "Buckets", "Load", "Live", "Peak");
+    for (const auto& component : components) {
+        report += std::format("{:<48} {:>10} {:>10} {:>8.2f} {:>12} {:>12}\n",
+            component.name, component.numComponents, component.numBuckets, component.loadFactor, FormatBytes(component.bytes), FormatBytes(component.highWater));
+    }
+    return report;
+}
+
+auto FormatBytes(std::int64_t bytes) -> std::string {
+    static constexpr auto UNITS = std::array<std::string_view, 4>{"KiB", "MiB", "GiB", "TiB"};
+
+    if (bytes < 1'024 && bytes > -1'024) return std::format("{} B", bytes);
+
+    auto value = static_cast<double>(bytes) / 1'024.0;
+    auto unit = std::size_t{0U};
+    while ((value >= 1'024.0 || value <= -1'024.0) && unit + 1U < UNITS.size()) {
+        value /= 1'024.0;
+        ++unit;
+    }
+    return std::format("{:.2f} {}", value, UNITS[unit]);
+}
+
+auto DemangleTypeName(const char* name) -> std::string {
+#ifdef MEMORY_TRACKER_DEMANGLE
+    auto status = 0;
+    const auto demangled = std::unique_ptr<char, decltype(&std::free)>{abi::__cxa_demangle(name, nullptr, nullptr, &status), &std::free};
+    if (status == 0 && demangled) return std::string(demangled.get());
+#endif
+    return std::string(name);
+}
@@ -0,0 +1,268 @@
+#include "meshbvh.h"
+
+#include "bounds.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64)
+#define MESHBVH_USE_SSE 1
+#include <xmmintrin.h>
+#endif
+
+namespace {
+
+constexpr auto NUM_BINS = 12;
+constexpr auto NO_HIT = std::numeric_limits<float>::infinity();
+constexpr auto PARALLEL_EPSILON = 1e-12F;
+
+struct RaySetup {
+    glm::vec3 origin;
+    glm::vec3 direction;
+    glm::vec3 invDirection;
+#ifdef MESHBVH_USE_SSE
+    __m128 originLanes;
+    __m128 invDirectionLanes;
+#endif
+};
+
+// Entry distance into the node's box, or infinity when the ray misses it before maxDistance
+auto IntersectNode(const MeshBvh::Node& node, const RaySetup& ray, float maxDistance) noexcept -> float {
+#ifdef MESHBVH_USE_SSE
+    // The fourth lane holds the node's integers and is never read back
+    const auto t0 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&node.min.x), ray.originLanes), ray.invDirectionLanes);
+    const auto t1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&node.max.x), ray.originLanes), ray.invDirectionLanes);
+    const auto near = _mm_min_ps(t0, t1);
+    const auto far = _mm_max_ps(t0, t1);
+
+    const auto entry = _mm_max_ss(
+        _mm_max_ss(near, _mm_shuffle_ps(near, near, _MM_SHUFFLE(1, 1, 1, 1))),
+        _mm_max_ss(_mm_shuffle_ps(near, near, _MM_SHUFFLE(2, 2, 2, 2)), _mm_setzero_ps())
+    );
+    const auto exit = _mm_min_ss(
+        _mm_min_ss(far, _mm_shuffle_ps(far, far, _MM_SHUFFLE(1, 1, 1, 1))),
+        _mm_min_ss(_mm_shuffle_ps(far, far, _MM_SHUFFLE(2, 2, 2, 2)), _mm_set_ss(maxDistance))
+    );
+
+    const auto entryDistance = _mm_cvtss_f32(entry);
+    return entryDistance <= _mm_cvtss_f32(exit) ? entryDistance : NO_HIT;
+#else
+    auto entryDistance = 0.0F;
+    auto exitDistance = maxDistance;
+    for (auto axis = 0; axis < 3; ++axis) {
+        const auto t0 = (node.min[axis] - ray.origin[axis]) * ray.invDirection[axis];
+        const auto t1 = (node.max[axis] - ray.origin[axis]) * ray.invDirection[axis];
+        entryDistance = std::max(entryDistance, std::min(t0, t1));
+        exitDistance = std::min(exitDistance, std::max(t0, t1));
+    }
+    return entryDistance <= exitDistance ? entryDistance : NO_HIT;
+#endif
+}
+
+}
+
+struct MeshBvh::BuildTriangle {
+    BoundingBox bounds;
+    glm::vec3 centroid;
+    std::uint32_t id;
+};
+
+auto MeshBvh::Build(std::span<const glm::vec3> triangleCorners) -> MeshBvh {
+    auto bvh = MeshBvh{};
+    const auto numTriangles = triangleCorners.size() / 3U;
+    if (numTriangles == 0U) return bvh;
+
+    auto triangles = std::vector<BuildTriangle>{};
+    triangles.reserve(numTriangles);
+    for (auto i = std::size_t{0U}; i < numTriangles; ++i) {
+        const auto& a = triangleCorners[i * 3U];
+        const auto& b = triangleCorners[i * 3U + 1U];
+        const auto& c = triangleCorners[i * 3U + 2U];
+        triangles.push_back(BuildTriangle{
+            .bounds = BoundingBox{ .min = glm::min(a, glm::min(b, c)), .max = glm::max(a, glm::max(b, c)) },
+            .centroid = (a + b + c) / 3.0F,
+            .id = static_cast<std::uint32_t>(i)
+        });
+    }
+
+    bvh.nodes.reserve(numTriangles * 2U / MAX_LEAF_TRIANGLES + 1U);
+    bvh.triangleIds.reserve(numTriangles);
+    bvh.BuildNode(triangles);
+
+    bvh.corners.reserve(numTriangles * 3U);
+    for (const auto id : bvh.triangleIds) {
+        bvh.corners.insert(bvh.corners.end(), triangleCorners.begin() + id * 3U, triangleCorners.begin() + id * 3U + 3U);
+    }
+
+    return bvh;
+}
+
+auto MeshBvh::BuildNode(std::span<BuildTriangle> triangles) -> void {
+    const auto index = nodes.size();
+    auto bounds = triangles.front().bounds;
+    auto centroidBounds = BoundingBox{ .min = triangles.front().centroid, .max = triangles.front().centroid };
+    for (const auto& triangle : triangles) {
+        bounds = bounds.Merged(triangle.bounds);
+        centroidBounds.min = glm::min(centroidBounds.min, triangle.centroid);
+        centroidBounds.max = glm::max(centroidBounds.max, triangle.centroid);
+    }
+    nodes.push_back(Node{ .min = bounds.min, .offset = 0U, .max = bounds.max, .count = 0U });
+
+    auto MakeLeaf = [&] {
+        nodes[index].offset = static_cast<std::uint32_t>(triangleIds.size());
+        nodes[index].count = static_cast<std::uint32_t>(triangles.size());
+        for (const auto& triangle : triangles) triangleIds.push_back(triangle.id);
+    };
+
+    if (triangles.size() <= MAX_LEAF_TRIANGLES) {
+        MakeLeaf();
+        return;
+    }
+
+    const auto size = centroidBounds.max - centroidBounds.min;
+    const auto axis = size.x > size.y ? (size.x > size.z ? 0 : 2) : (size.y > size.z ? 1 : 2);
+    auto middle = triangles.size() / 2U;
+
+    if (size[axis] > 0.0F) {
+        // Binned SAH over centroids, the same scheme as the scene BVH
+        struct Bin {
+            std::size_t count = 0U;
+            std::optional<BoundingBox> bounds;
+        };
+        auto bins = std::array<Bin, NUM_BINS>{};
+        auto BinOf = [&](const BuildTriangle& triangle) {
+            const auto offset = (triangle.centroid[axis] - centroidBounds.min[axis]) / size[axis];
+            return std::min(static_cast<int>(offset * static_cast<float>(NUM_BINS)), NUM_BINS - 1);
+        };
+
+        for (const auto& triangle : triangles) {
+            auto& bin = bins[static_cast<std::size_t>(BinOf(triangle))];
+            ++bin.count;
+            bin.bounds = bin.bounds ? bin.bounds->Merged(triangle.bounds) : triangle.bounds;
+        }
+
+        auto rightCosts = std::array<float, NUM_BINS>{};
+        auto accumulated = std::optional<BoundingBox>{};
+        auto count = std::size_t{0U};
+        for (auto i = NUM_BINS - 1; i > 0; --i) {
+            const auto& bin = bins[static_cast<std::size_t>(i)];
+            if (bin.bounds) accumulated = accumulated ? accumulated->Merged(*bin.bounds) : *bin.bounds;
+            count += bin.count;
+            rightCosts[static_cast<std::size_t>(i)] = accumulated ? static_cast<float>(count) * accumulated->SurfaceArea() : NO_HIT;
+        }
+
+        auto bestSplit = 0;
+        auto bestCost = NO_HIT;
+        accumulated.reset();
+        count = 0U;
+        for (auto i = 1; i < NUM_BINS; ++i) {
+            const auto& bin = bins[static_cast<std::size_t>(i - 1)];
+            if (bin.bounds) accumulated = accumulated ? accumulated->Merged(*bin.bounds) : *bin.bounds;
+            count += bin.count;
+            if (count == 0U) continue;
+
+            const auto cost = static_cast<float>(count) * accumulated->SurfaceArea() + rightCosts[static_cast<std::size_t>(i)];
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestSplit = i;
+            }
+        }
+
+        if (bestSplit > 0) {
+            const auto split = std::ranges::partition(triangles, [&](const auto& triangle) { return BinOf(triangle) < bestSplit; });
+            middle = static_cast<std::size_t>(split.begin() - triangles.begin());
+        }
+    }
+
+    if (middle == 0U || middle == triangles.size()) {
+        middle = triangles.size() / 2U;
+        std::ranges::nth_element(triangles, triangles.begin() + static_cast<std::ptrdiff_t>(middle), {}, [axis](const auto& triangle) { return triangle.centroid[axis]; });
+    }
+
+    BuildNode(triangles.first(middle));
+    nodes[index].offset = static_cast<std::uint32_t>(nodes.size());
+    BuildNode(triangles.subspan(middle));
+}
+
+auto MeshBvh::Intersect(const Ray& ray, float maxDistance) const noexcept -> std::optional<MeshHit> {
+    if (nodes.empty()) return std::nullopt;
+
+    const auto invDirection = 1.0F / ray.direction;
+    const auto setup = RaySetup{
+        .origin = ray.origin,
+        .direction = ray.direction,
+        .invDirection = invDirection,
+#ifdef MESHBVH_USE_SSE
+        .originLanes = _mm_setr_ps(ray.origin.x, ray.origin.y, ray.origin.z, 0.0F),
+        .invDirectionLanes = _mm_setr_ps(invDirection.x, invDirection.y, invDirection.z, 0.0F)
+#endif
+    };
+
+    auto best = std::optional<MeshHit>{};
+    auto bestDistance = maxDistance;
+
+    struct StackEntry {
+        std::uint32_t node;
+        float distance;
+    };
+    auto stack = std::vector<StackEntry>{};
+    stack.reserve(64U);
+
+    const auto rootDistance = IntersectNode(nodes.front(), setup, bestDistance);
+    if (rootDistance != NO_HIT) stack.push_back(StackEntry{.node = 0U, .distance = rootDistance});
+
+    while (!stack.empty()) {
+        const auto [index, distance] = stack.back();
+        stack.pop_back();
+        if (distance > bestDistance) continue;
+
+        const auto& node = nodes[index];
+        if (node.IsLeaf()) {
+            // Möller-Trumbore, either winding counts as a hit
+            for (auto i = node.offset; i < node.offset + node.count; ++i) {
+                const auto& v0 = corners[i * 3U];
+                const auto edge1 = corners[i * 3U + 1U] - v0;
+                const auto edge2 = corners[i * 3U + 2U] - v0;
+                const auto p = glm::cross(ray.direction, edge2);
+                const auto det = glm::dot(edge1, p);
+                if (std::abs(det) < PARALLEL_EPSILON) continue;
+
+                const auto invDet = 1.0F / det;
+                const auto s = ray.origin - v0;
+                const auto u = glm::dot(s, p) * invDet;
+                if (u < 0.0F || u > 1.0F) continue;
+
+                const auto q = glm::cross(s, edge1);
+                const auto v = glm::dot(ray.direction, q) * invDet;
+                if (v < 0.0F || u + v > 1.0F) continue;
+
+                const auto t = glm::dot(edge2, q) * invDet;
+                if (t < 0.0F || t >= bestDistance) continue;
+
+                bestDistance = t;
+                best = MeshHit{.distance = t, .triangle = triangleIds[i], .barycentric = glm::vec2(u, v)};
+            }
+            continue;
+        }
+
+        // Nearer child is pushed last so it is visited first and can shrink bestDistance for the other
+        auto first = StackEntry{.node = index + 1U, .distance = IntersectNode(nodes[index + 1U], setup, bestDistance)};
+        auto second = StackEntry{.node = node.offset, .distance = IntersectNode(nodes[node.offset], setup, bestDistance)};
+        if (first.distance > second.distance) std::swap(first, second);
+
+        if (second.distance != NO_HIT) stack.push_back(second);
+        if (first.distance != NO_HIT) stack.push_back(first);
+    }
+
+    return best;
+}
@@ -0,0 +1,48 @@
+#include "meshcache.h"
+
+#include "debugutils.h"
+#include "meshcomponent.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <format>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+auto MeshCache::MakeKey(std::string_view filePath) -> std::string {
+    return std::filesystem::path(filePath).lexically_normal().generic_string();
+}
+
+auto MeshCache::Find(const std::string& key) const -> std::shared_ptr<const GpuMesh> {
+    auto iter = entries.find(key);
+    if (iter == entries.cend()) return nullptr;
+    return iter->second.lock();
+}
+
+auto MeshCache::Insert(const std::string& key, const Mesh& mesh) -> std::shared_ptr<const GpuMesh> {
+    if (auto existing = Find(key)) {
+        DebugMessage("WARN", "Mesh \"{}\" is already resident, keeping the existing upload", key);
+        return existing;
+    }
+
+    auto gpuMesh = std::make_shared<const GpuMesh>(mesh, arena);
+    entries.insert_or_assign(key, gpuMesh);
+    return gpuMesh;
+}
+
+auto MeshCache::Load(std::string_view filePath) -> std::shared_ptr<const GpuMesh> {
+    auto key = MakeKey(filePath);
+    if (auto existing = Find(key)) return existing;
+
+    return Insert(key, Mesh::ReadObj(key.c_str()));
+}
+
+auto MeshCache::Prune() -> std::size_t {
+    return std::erase_if(entries, [](const auto& entry) { return entry.second.expired(); });
+}
+
+auto MeshCache::NumLive() const noexcept -> std::size_t {
+    return static_cast<std::size_t>(std::ranges::count_if(entries, [](const auto& entry) { return !entry.second.expired(); }));
+}
@@ -1,19 +1,36 @@
 #include "meshcomponent.h"
 
+#include "cpuprofiler.h"
 #include "debugutils.h"
+#include "geometryarena.h"
+#include "meshbvh.h"
 
-#include <bit>
+#include <algorithm>
+#include <charconv>
+#include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <format>
 #include <fstream>
 #include <limits>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <ranges>
+#include <span>
 #include <sstream>
+#include <string>
 #include <string_view>
 #include <utility>
 #include <vector>
 
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#define MESH_USE_SSE 1
+#include <emmintrin.h>
+#endif
 
-auto Mesh::ReadObj(const char* filePath) -> Mesh {
+auto Mesh::ReadObj(const char* filePath, std::pmr::memory_resource* scratch) -> Mesh {
+    auto zone = ProfileZone{"Mesh::ReadObj"};
     DebugMessage("INFO", "Reading object file \"{}\"", filePath);
     auto inputFile = std::ifstream(filePath);
 
@@ -22,57 +39,222 @@ auto Mesh::ReadObj(const char* filePath) -> Mesh {
         return Mesh{};
     }
 
-    return Mesh::ReadObj(inputFile);
+    return Mesh::ReadObj(inputFile, scratch);
 }
 
-auto Mesh::ReadObj(std::string_view inputStr) -> Mesh {
+auto Mesh::ReadObj(std::string_view inputStr, std::pmr::memory_resource* scratch) -> Mesh {
     auto objStream = std::stringstream{};
     objStream << inputStr;
-    return Mesh::ReadObj(objStream);
+    return Mesh::ReadObj(objStream, scratch);
 }
 
-MeshComponent::MeshComponent(const Mesh& mesh) noexcept
-    : numVertices{static_cast<unsigned int>(mesh.vertices.size())}
-{
-    glGenVertexArrays(1, &vao);
-    glGenBuffers(1, &vbo);
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-
-    const auto meshSize = [&] {
-        if (mesh.vertices.size() * sizeof(Vertex) > static_cast<size_t>(std::numeric_limits<GLsizeiptr>::max())) [[unlikely]] {
-            DebugMessage("WARN", "Mesh loaded is too large, cropping to size");
-            return std::numeric_limits<GLsizeiptr>::max();
-        }
-
-        return static_cast<GLsizeiptr>(mesh.vertices.size() * sizeof(Vertex));
-    }();
-
-    glBufferData(GL_ARRAY_BUFFER, meshSize, mesh.vertices.data(), GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), std::bit_cast<void *>(offsetof(Vertex, position)));
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), std::bit_cast<void *>(offsetof(Vertex, normal)));
-    glEnableVertexAttribArray(1);
+auto Mesh::NextObjToken(std::string_view& line) noexcept -> std::string_view {
+    static constexpr auto WHITESPACE = std::string_view{" \t\r"};
+
+    const auto begin = std::min(line.find_first_not_of(WHITESPACE), line.size());
+    const auto end = std::min(line.find_first_of(WHITESPACE, begin), line.size());
+    const auto token = line.substr(begin, end - begin);
+    line.remove_prefix(end);
+    return token;
+}
+
+auto Mesh::ParseObjVec3(std::string_view& line) noexcept -> glm::vec3 {
+    auto result = glm::vec3(0.0F);
+    for (auto i = 0; i < 3; ++i) {
+        const auto token = NextObjToken(line);
+        std::from_chars(token.data(), token.data() + token.size(), result[i]);
+    }
+    return result;
+}
+
+auto Mesh::ParseObjFaceVertex(std::string_view token) noexcept -> std::optional<ObjFaceVertex> {
+    const auto* const end = token.data() + token.size();
+
+    auto vertex = VertexId{0U};
+    const auto [vertexEnd, vertexError] = std::from_chars(token.data(), end, vertex);
+    if (vertexError != std::errc{} || vertex == 0U) return std::nullopt;
+
+    // The normal is always the last field, whether or not a texture coordinate sits before it
+    const auto lastSlash = token.rfind('/');
+    if (vertexEnd == end || *vertexEnd != '/' || lastSlash == std::string_view::npos) return std::nullopt;
+
+    auto normal = std::uint64_t{0U};
+    const auto [normalEnd, normalError] = std::from_chars(token.data() + lastSlash + 1U, end, normal);
+    if (normalError != std::errc{} || normalEnd != end || normal == 0U) return std::nullopt;
+
+    return ObjFaceVertex{ .vertex = vertex - 1U, .normal = normal - 1U };
+}
+
+auto Mesh::ComputeBounds() noexcept -> void {
+    if (vertices.empty()) {
+        bounds = BoundingBox{};
+        sphere = BoundingSphere{};
+        return;
+    }
+
+    // Each load reads position plus normal.x, the fourth lane is ignored
+    static_assert(offsetof(Vertex, normal) == offsetof(Vertex, position) + sizeof(glm::vec3));
+
+#ifdef MESH_USE_SSE
+    auto minPos = _mm_loadu_ps(&vertices.front().position.x);
+    auto maxPos = minPos;
+    for (const auto& vertex : vertices) {
+        const auto position = _mm_loadu_ps(&vertex.position.x);
+        minPos = _mm_min_ps(minPos, position);
+        maxPos = _mm_max_ps(maxPos, position);
+    }
+
+    alignas(16) float minOut[4];
+    alignas(16) float maxOut[4];
+    _mm_store_ps(minOut, minPos);
+    _mm_store_ps(maxOut, maxPos);
+    bounds = BoundingBox{ .min = glm::vec3(minOut[0], minOut[1], minOut[2]), .max = glm::vec3(maxOut[0], maxOut[1], maxOut[2]) };
+
+    const auto center = bounds.Center();
+    const auto centerPos = _mm_setr_ps(center.x, center.y, center.z, 0.0F);
+    const auto xyzMask = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+    auto maxDistSq = _mm_setzero_ps();
+    for (const auto& vertex : vertices) {
+        const auto offset = _mm_and_ps(_mm_sub_ps(_mm_loadu_ps(&vertex.position.x), centerPos), xyzMask);
+        auto distSq = _mm_mul_ps(offset, offset);
+        distSq = _mm_add_ps(distSq, _mm_movehl_ps(distSq, distSq));
+        distSq = _mm_add_ss(distSq, _mm_shuffle_ps(distSq, distSq, _MM_SHUFFLE(1, 1, 1, 1)));
+        maxDistSq = _mm_max_ss(maxDistSq, distSq);
+    }
+    sphere = BoundingSphere{ .center = center, .radius = std::sqrt(_mm_cvtss_f32(maxDistSq)) };
+#else
+    bounds = BoundingBox{ .min = vertices.front().position, .max = vertices.front().position };
+    for (const auto& vertex : vertices) {
+        bounds.min = glm::min(bounds.min, vertex.position);
+        bounds.max = glm::max(bounds.max, vertex.position);
+    }
+
+    const auto center = bounds.Center();
+    auto maxDistSq = 0.0F;
+    for (const auto& vertex : vertices) {
+        const auto offset = vertex.position - center;
+        maxDistSq = std::max(maxDistSq, glm::dot(offset, offset));
+    }
+    sphere = BoundingSphere{ .center = center, .radius = std::sqrt(maxDistSq) };
+#endif
+}
+
+namespace {
+
+// Spreads the low 10 bits so two zero bits sit between each
+auto ExpandBits(std::uint32_t value) noexcept -> std::uint32_t {
+    value = (value * 0x00010001U) & 0xFF0000FFU;
+    value = (value * 0x00000101U) & 0x0F00F00FU;
+    value = (value * 0x00000011U) & 0xC30C30C3U;
+    value = (value * 0x00000005U) & 0x49249249U;
+    return value;
+}
+
+auto MortonCode(const glm::vec3& unitPos) noexcept -> std::uint32_t {
+    auto Quantise = [](float f) { return static_cast<std::uint32_t>(std::clamp(f * 1024.0F, 0.0F, 1023.0F)); };
+    return (ExpandBits(Quantise(unitPos.x)) << 2U) | (ExpandBits(Quantise(unitPos.y)) << 1U) | ExpandBits(Quantise(unitPos.z));
+}
+
+auto FaceNormal(std::span<const Vertex, 3> triangle) noexcept -> std::optional<glm::vec3> {
+    const auto normal = glm::cross(triangle[1].position - triangle[0].position, triangle[2].position - triangle[0].position);
+    const auto length = glm::length(normal);
+    if (length <= std::numeric_limits<float>::epsilon()) return std::nullopt;
+    return normal / length;
+}
+
+auto MakeCluster(std::span<const Vertex> vertices, std::uint32_t firstVertex) -> MeshCluster {
+    auto cluster = MeshCluster{ .firstVertex = firstVertex, .numVertices = static_cast<std::uint32_t>(vertices.size()) };
+
+    auto box = BoundingBox{ .min = vertices.front().position, .max = vertices.front().position };
+    for (const auto& vertex : vertices) {
+        box.min = glm::min(box.min, vertex.position);
+        box.max = glm::max(box.max, vertex.position);
+    }
+
+    cluster.sphere.center = box.Center();
+    for (const auto& vertex : vertices) {
+        cluster.sphere.radius = std::max(cluster.sphere.radius, glm::distance(vertex.position, cluster.sphere.center));
+    }
+
+    auto axisSum = glm::vec3(0.0F);
+    for (auto i = std::size_t{0U}; i + 3U <= vertices.size(); i += 3U) {
+        if (auto normal = FaceNormal(vertices.subspan(i).first<3>())) axisSum += *normal;
+    }
+
+    const auto axisLength = glm::length(axisSum);
+    if (axisLength <= std::numeric_limits<float>::epsilon()) return cluster;
+    cluster.coneAxis = axisSum / axisLength;
+
+    auto minDot = 1.0F;
+    for (auto i = std::size_t{0U}; i + 3U <= vertices.size(); i += 3U) {
+        if (auto normal = FaceNormal(vertices.subspan(i).first<3>())) minDot = std::min(minDot, glm::dot(*normal, cluster.coneAxis));
+    }
+
+    // Normals spread over a hemisphere or more leave no direction from which every face is backfacing
+    if (minDot > 0.0F) cluster.coneCutoff = std::sqrt(1.0F - minDot * minDot);
+    return cluster;
+}
+
+}
+
+auto Mesh::BuildClusters(std::size_t maxTriangles) -> void {
+    auto zone = ProfileZone{"Mesh::BuildClusters"};
+    clusters.clear();
+
+    const auto numTriangles = NumTriangles();
+    if (numTriangles == 0U || maxTriangles == 0U) return;
+
+    const auto extent = glm::max(bounds.max - bounds.min, glm::vec3(std::numeric_limits<float>::epsilon()));
+
+    auto order = std::vector<std::pair<std::uint32_t, std::uint32_t>>{};
+    order.reserve(numTriangles);
+    for (auto triangle = std::uint32_t{0U}; triangle < numTriangles; ++triangle) {
+        const auto* corners = &vertices[triangle * 3U];
+        const auto centroid = (corners[0].position + corners[1].position + corners[2].position) / 3.0F;
+        order.emplace_back(MortonCode((centroid - bounds.min) / extent), triangle);
+    }
+    std::ranges::sort(order);
+
+    auto sorted = VertexBuffer{};
+    sorted.reserve(vertices.size());
+    for (auto [code, triangle] : order) {
+        std::ranges::copy_n(vertices.begin() + triangle * 3U, 3, std::back_inserter(sorted));
+    }
+    std::ranges::copy(vertices | std::views::drop(numTriangles * 3U), std::back_inserter(sorted));
+    vertices = std::move(sorted);
+
+    clusters.reserve((numTriangles + maxTriangles - 1U) / maxTriangles);
+    for (auto first = std::size_t{0U}; first < numTriangles; first += maxTriangles) {
+        const auto count = std::min(maxTriangles, numTriangles - first);
+        clusters.push_back(MakeCluster(std::span(vertices).subspan(first * 3U, count * 3U), static_cast<std::uint32_t>(first * 3U)));
+    }
+
+    // Triangle ids in an existing BVH refer to the old order
+    if (bvh) BuildBvh();
 }
 
-auto MeshComponent::operator=(MeshComponent&& other) noexcept -> MeshComponent& {
-    if (vao != 0U) { glDeleteVertexArrays(1U, &vao); }
-    if (vbo != 0U) { glDeleteVertexArrays(1U, &vbo); }
+auto Mesh::BuildBvh() -> void {
+    auto zone = ProfileZone{"Mesh::BuildBvh"};
+    auto positions = std::vector<glm::vec3>{};
+    positions.reserve(NumTriangles() * 3U);
+    for (const auto& vertex : vertices | std::views::take(NumTriangles() * 3U)) positions.push_back(vertex.position);
 
-    vao = std::exchange(other.vao, 0U);
-    vbo = std::exchange(other.vbo, 0U);
-    numVertices = other.numVertices;
-    return *this;
+    bvh = std::make_shared<const MeshBvh>(MeshBvh::Build(positions));
 }
 
-MeshComponent::MeshComponent(MeshComponent&& other) noexcept
-    : vao{other.vao}, vbo{other.vbo}, numVertices{other.numVertices}
-{
-    other.vao = 0U;
-    other.vbo = 0U;
+GpuMesh::GpuMesh(const Mesh& mesh, GeometryArena& arena)
+    : arena{&arena}, allocation{arena.Allocate(mesh.vertices)}, numVertices{static_cast<unsigned int>(mesh.vertices.size())},
+      bounds{mesh.bounds}, sphere{mesh.sphere}, clusters{mesh.clusters}, bvh{mesh.bvh}
+{}
+
+GpuMesh::~GpuMesh() noexcept {
+    arena->Free(allocation);
 }
 
-MeshComponent::~MeshComponent() noexcept {
-    if (vao != 0U) { glDeleteVertexArrays(1U, &vao); }
-    if (vbo != 0U) { glDeleteVertexArrays(1U, &vbo); }
-}
\ No newline at end of file
+MeshComponent::MeshComponent(const Mesh& mesh, GeometryArena& arena)
+    : gpuMesh{std::make_shared<const GpuMesh>(mesh, arena)}
+{}
+
+MeshComponent::MeshComponent(std::shared_ptr<const GpuMesh> gpuMesh) noexcept
+    : gpuMesh{std::move(gpuMesh)}
+{}
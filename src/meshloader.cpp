@@ -0,0 +1,106 @@
+#include "meshloader.h"
+
+#include "debugutils.h"
+#include "framearena.h"
+#include "jobsystem.h"
+#include "meshcache.h"
+#include "meshcomponent.h"
+
+#include <exception>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Parses can run on any thread helping out with jobs, so they keep away from that thread's frame arena
+auto ParseScratch() -> FrameArena& {
+    thread_local auto arena = FrameArena{};
+    return arena;
+}
+
+}
+
+MeshLoader::MeshLoader(MeshCache& cache, Mesh placeholder, JobSystem& jobs)
+    : cache{cache}, jobs{jobs}, placeholder{std::move(placeholder)}
+{}
+
+MeshLoader::~MeshLoader() noexcept {
+    auto pending = [&] {
+        auto lock = std::scoped_lock{requestMutex};
+        return std::exchange(parseJobs, {});
+    }();
+    jobs.WaitAll(pending);
+}
+
+auto MeshLoader::Parse(const std::string& key) -> void {
+    // Each parse is a frame as far as the scratch arena is concerned, nothing of the last one survives it
+    auto& scratch = ParseScratch();
+    scratch.Reset();
+    auto mesh = Mesh{};
+    // A failed parse still hands back an empty mesh like a missing file does, so its waiters resolve and it stops pending
+    try {
+        mesh = Mesh::ReadObj(key.c_str(), &scratch);
+        if (mesh.NumTriangles() >= clusterThreshold.load()) mesh.BuildClusters();
+        if (buildBvh.load()) mesh.BuildBvh();
+    } catch (const std::exception& exception) {
+        DebugMessage("ERROR", "Failed to load mesh \"{}\": {}", key, exception.what());
+        mesh = Mesh{};
+    }
+
+    auto lock = std::scoped_lock{loadedMutex};
+    loaded.emplace_back(key, std::move(mesh));
+}
+
+auto MeshLoader::Request(EntityId entity, std::string filePath) -> void {
+    auto key = MeshCache::MakeKey(filePath);
+    auto lock = std::scoped_lock{requestMutex};
+    const auto ticket = nextTicket++;
+    latestTickets.insert_or_assign(entity, ticket);
+
+    auto [iter, inserted] = inFlight.try_emplace(key);
+    iter->second.emplace_back(entity, ticket);
+    if (!inserted) return;
+
+    ++numPending;
+    std::erase_if(parseJobs, [](const JobHandle& job) { return job.IsDone(); });
+    parseJobs.push_back(jobs.Submit([this, key = std::move(key)] { Parse(key); }));
+}
+
+auto MeshLoader::Cancel(EntityId entity) -> void {
+    auto lock = std::scoped_lock{requestMutex};
+    latestTickets.erase(entity);
+}
+
+auto MeshLoader::TryPopLoaded() -> std::optional<LoadedMesh> {
+    auto lock = std::scoped_lock{loadedMutex};
+    if (loaded.empty()) return std::nullopt;
+
+    auto loadedMesh = std::move(loaded.front());
+    loaded.pop_front();
+    --numPending;
+    return loadedMesh;
+}
+
+auto MeshLoader::TakeWaiters(const std::string& key) -> std::vector<EntityId> {
+    auto lock = std::scoped_lock{requestMutex};
+    auto entities = std::vector<EntityId>{};
+
+    auto node = inFlight.extract(key);
+    if (node.empty()) return entities;
+
+    for (const auto& waiter : node.mapped()) {
+        auto iter = latestTickets.find(waiter.entity);
+        if (iter == latestTickets.end() || iter->second != waiter.ticket) continue;
+
+        latestTickets.erase(iter);
+        entities.emplace_back(waiter.entity);
+    }
+
+    return entities;
+}
+
+auto MeshLoader::NumPending() const noexcept -> std::size_t {
+    return numPending.load();
+}
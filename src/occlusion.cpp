@@ -0,0 +1,296 @@
+#include "occlusion.h"
+
+#include "bounds.h"
+#include "cpuprofiler.h"
+#include "jobsystem.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64)
+#define OCCLUSION_USE_SSE 1
+#include <xmmintrin.h>
+#endif
+
+namespace {
+
+constexpr auto BATCH_SIZE = 4;
+
+auto ToWindow(const glm::vec4& clip, int width, int height) noexcept -> glm::vec3 {
+    const auto ndc = glm::vec3(clip) / clip.w;
+    return glm::vec3(
+        (ndc.x * 0.5F + 0.5F) * static_cast<float>(width),
+        (ndc.y * 0.5F + 0.5F) * static_cast<float>(height),
+        ndc.z * 0.5F + 0.5F
+    );
+}
+
+// Pixel centers sit at +0.5, clamped first so far off-screen vertices can't overflow the conversion
+auto FirstPixel(float minCoord, int size) noexcept -> int {
+    return std::max(static_cast<int>(std::ceil(std::clamp(minCoord - 0.5F, -1.0F, static_cast<float>(size)))), 0);
+}
+
+auto LastPixel(float maxCoord, int size) noexcept -> int {
+    return std::min(static_cast<int>(std::floor(std::clamp(maxCoord - 0.5F, -1.0F, static_cast<float>(size)))), size - 1);
+}
+
+}
+
+OcclusionCuller::OcclusionCuller(int width, int height, JobSystem& jobs)
+    : width{(std::max(width, BATCH_SIZE) + BATCH_SIZE - 1) / BATCH_SIZE * BATCH_SIZE},
+      height{std::max(height, 1)},
+      tilesX{(this->width + TILE_WIDTH - 1) / TILE_WIDTH},
+      tilesY{(this->height + TILE_HEIGHT - 1) / TILE_HEIGHT},
+      jobs{jobs}
+{
+    auto levelWidth = this->width;
+    auto levelHeight = this->height;
+    auto offset = std::size_t{0U};
+    while (true) {
+        levels.push_back(Level{.width = levelWidth, .height = levelHeight, .offset = offset});
+        offset += static_cast<std::size_t>(levelWidth * levelHeight);
+        if (levelWidth == 1 && levelHeight == 1) break;
+        levelWidth = (levelWidth + 1) / 2;
+        levelHeight = (levelHeight + 1) / 2;
+    }
+    pyramid.resize(offset, 1.0F);
+    tileBins.resize(static_cast<std::size_t>(tilesX * tilesY));
+}
+
+auto OcclusionCuller::Begin(const glm::mat4& viewProj) -> void {
+    this->viewProj = viewProj;
+    triangles.clear();
+    for (auto& bin : tileBins) bin.clear();
+    std::fill_n(pyramid.begin(), width * height, 1.0F);
+}
+
+auto OcclusionCuller::AddOccluder(std::span<const glm::vec3> occluderTriangles, const glm::mat4& model) -> void {
+    const auto modelViewProj = viewProj * model;
+
+    for (auto i = std::size_t{0U}; i + 2U < occluderTriangles.size(); i += 3U) {
+        const auto clip = std::array<glm::vec4, 3>{
+            modelViewProj * glm::vec4(occluderTriangles[i], 1.0F),
+            modelViewProj * glm::vec4(occluderTriangles[i + 1U], 1.0F),
+            modelViewProj * glm::vec4(occluderTriangles[i + 2U], 1.0F)
+        };
+
+        // Distance in front of the near plane, z >= -w
+        const auto distance = std::array<float, 3>{clip[0].z + clip[0].w, clip[1].z + clip[1].w, clip[2].z + clip[2].w};
+        const auto numInFront = std::ranges::count_if(distance, [](float d) { return d >= 0.0F; });
+
+        if (numInFront == 3) {
+            AddTriangle(clip[0], clip[1], clip[2]);
+            continue;
+        }
+        if (numInFront == 0) continue;
+
+        // Clipping one corner off a triangle leaves at most a quad
+        auto polygon = std::array<glm::vec4, 4>{};
+        auto numVertices = std::size_t{0U};
+        for (auto k = std::size_t{0U}; k < 3U; ++k) {
+            const auto next = (k + 1U) % 3U;
+            if (distance[k] >= 0.0F) polygon[numVertices++] = clip[k];
+            if ((distance[k] >= 0.0F) != (distance[next] >= 0.0F)) {
+                const auto t = distance[k] / (distance[k] - distance[next]);
+                polygon[numVertices++] = clip[k] + (clip[next] - clip[k]) * t;
+            }
+        }
+
+        for (auto k = std::size_t{1U}; k + 1U < numVertices; ++k) {
+            AddTriangle(polygon[0], polygon[k], polygon[k + 1U]);
+        }
+    }
+}
+
+auto OcclusionCuller::AddTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c) -> void {
+    const auto v = std::array<glm::vec3, 3>{ToWindow(a, width, height), ToWindow(b, width, height), ToWindow(c, width, height)};
+
+    const auto area = (v[1].x - v[0].x) * (v[2].y - v[0].y) - (v[2].x - v[0].x) * (v[1].y - v[0].y);
+    if (!(area > 0.0F)) return;
+
+    auto triangle = ScreenTriangle{
+        .edgeA = {}, .edgeB = {}, .edgeC = {},
+        .depthA = 0.0F, .depthB = 0.0F, .depthC = 0.0F,
+        .minX = FirstPixel(std::min({v[0].x, v[1].x, v[2].x}), width),
+        .minY = FirstPixel(std::min({v[0].y, v[1].y, v[2].y}), height),
+        .maxX = LastPixel(std::max({v[0].x, v[1].x, v[2].x}), width),
+        .maxY = LastPixel(std::max({v[0].y, v[1].y, v[2].y}), height)
+    };
+    if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY) return;
+
+    // Edge k runs from vertex k to k + 1, its value over the area is the weight of the opposite vertex
+    for (auto k = 0; k < 3; ++k) {
+        const auto& from = v[k];
+        const auto& to = v[(k + 1) % 3];
+        triangle.edgeA[k] = from.y - to.y;
+        triangle.edgeB[k] = to.x - from.x;
+        triangle.edgeC[k] = from.x * to.y - from.y * to.x;
+
+        const auto opposite = v[(k + 2) % 3].z / area;
+        triangle.depthA += triangle.edgeA[k] * opposite;
+        triangle.depthB += triangle.edgeB[k] * opposite;
+        triangle.depthC += triangle.edgeC[k] * opposite;
+    }
+
+    const auto index = static_cast<std::uint32_t>(triangles.size());
+    triangles.push_back(triangle);
+    ++stats.occluderTriangles;
+
+    for (auto ty = triangle.minY / TILE_HEIGHT; ty <= triangle.maxY / TILE_HEIGHT; ++ty) {
+        for (auto tx = triangle.minX / TILE_WIDTH; tx <= triangle.maxX / TILE_WIDTH; ++tx) {
+            tileBins[static_cast<std::size_t>(ty * tilesX + tx)].push_back(index);
+        }
+    }
+}
+
+auto OcclusionCuller::Rasterize() -> void {
+    auto zone = ProfileZone{"OcclusionCuller::Rasterize"};
+    // Without occluders every bin is empty and Begin already cleared the buffer, so the workers are left asleep
+    if (!triangles.empty()) {
+        jobs.ParallelFor(tileBins.size(), TILES_PER_JOB, [this](std::size_t begin, std::size_t end) {
+            auto tilesZone = ProfileZone{"OcclusionCuller::RasterizeTiles"};
+            for (auto tile = begin; tile < end; ++tile) RasterizeTile(tile);
+        });
+    }
+
+    BuildPyramid();
+}
+
+auto OcclusionCuller::RasterizeTile(std::size_t tile) noexcept -> void {
+    const auto tileX = static_cast<int>(tile) % tilesX * TILE_WIDTH;
+    const auto tileY = static_cast<int>(tile) / tilesX * TILE_HEIGHT;
+    const auto tileMaxX = std::min(tileX + TILE_WIDTH, width) - 1;
+    const auto tileMaxY = std::min(tileY + TILE_HEIGHT, height) - 1;
+
+    for (const auto index : tileBins[tile]) {
+        const auto& triangle = triangles[index];
+        // Rows start on a SIMD boundary, lanes outside the triangle fail the edge tests
+        const auto minX = std::max(triangle.minX, tileX) / BATCH_SIZE * BATCH_SIZE;
+        const auto maxX = std::min(triangle.maxX, tileMaxX);
+        const auto minY = std::max(triangle.minY, tileY);
+        const auto maxY = std::min(triangle.maxY, tileMaxY);
+
+        for (auto y = minY; y <= maxY; ++y) {
+            const auto py = static_cast<float>(y) + 0.5F;
+            auto* row = pyramid.data() + static_cast<std::size_t>(y * width);
+
+#ifdef OCCLUSION_USE_SSE
+            const auto laneOffsets = _mm_setr_ps(0.5F, 1.5F, 2.5F, 3.5F);
+            const auto zero = _mm_setzero_ps();
+            __m128 edgeA[3];
+            __m128 edgeRow[3];
+            for (auto k = 0; k < 3; ++k) {
+                edgeA[k] = _mm_set1_ps(triangle.edgeA[k]);
+                edgeRow[k] = _mm_set1_ps(triangle.edgeB[k] * py + triangle.edgeC[k]);
+            }
+            const auto depthA = _mm_set1_ps(triangle.depthA);
+            const auto depthRow = _mm_set1_ps(triangle.depthB * py + triangle.depthC);
+
+            for (auto x = minX; x <= maxX; x += BATCH_SIZE) {
+                const auto px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), laneOffsets);
+
+                auto inside = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA[0], px), edgeRow[0]), zero);
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA[1], px), edgeRow[1]), zero));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA[2], px), edgeRow[2]), zero));
+
+                const auto depth = _mm_add_ps(_mm_mul_ps(depthA, px), depthRow);
+                const auto current = _mm_loadu_ps(row + x);
+                const auto nearest = _mm_min_ps(current, depth);
+                _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, current)));
+            }
+#else
+            for (auto x = minX; x <= maxX; ++x) {
+                const auto px = static_cast<float>(x) + 0.5F;
+                auto inside = true;
+                for (auto k = 0; k < 3; ++k) {
+                    inside = inside && triangle.edgeA[k] * px + triangle.edgeB[k] * py + triangle.edgeC[k] >= 0.0F;
+                }
+                if (inside) row[x] = std::min(row[x], triangle.depthA * px + triangle.depthB * py + triangle.depthC);
+            }
+#endif
+        }
+    }
+}
+
+auto OcclusionCuller::BuildPyramid() noexcept -> void {
+    for (auto l = std::size_t{1U}; l < levels.size(); ++l) {
+        const auto& below = levels[l - 1U];
+        const auto& level = levels[l];
+        const auto* src = pyramid.data() + below.offset;
+        auto* dst = pyramid.data() + level.offset;
+
+        for (auto y = 0; y < level.height; ++y) {
+            const auto y0 = 2 * y;
+            const auto y1 = std::min(y0 + 1, below.height - 1);
+            for (auto x = 0; x < level.width; ++x) {
+                const auto x0 = 2 * x;
+                const auto x1 = std::min(x0 + 1, below.width - 1);
+                dst[y * level.width + x] = std::max({
+                    src[y0 * below.width + x0], src[y0 * below.width + x1],
+                    src[y1 * below.width + x0], src[y1 * below.width + x1]
+                });
+            }
+        }
+    }
+}
+
+auto OcclusionCuller::IsVisible(const BoundingBox& worldBox) noexcept -> bool {
+    ++stats.tested;
+    if (!HasOccluders()) return true;
+
+    auto minWindow = glm::vec2(std::numeric_limits<float>::max());
+    auto maxWindow = glm::vec2(std::numeric_limits<float>::lowest());
+    auto minDepth = std::numeric_limits<float>::max();
+
+    for (auto corner = 0; corner < 8; ++corner) {
+        const auto point = glm::vec3(
+            (corner & 1) != 0 ? worldBox.max.x : worldBox.min.x,
+            (corner & 2) != 0 ? worldBox.max.y : worldBox.min.y,
+            (corner & 4) != 0 ? worldBox.max.z : worldBox.min.z
+        );
+        const auto clip = viewProj * glm::vec4(point, 1.0F);
+        if (clip.w <= 0.0F || clip.z < -clip.w) return true;
+
+        const auto window = ToWindow(clip, width, height);
+        minWindow = glm::min(minWindow, glm::vec2(window.x, window.y));
+        maxWindow = glm::max(maxWindow, glm::vec2(window.x, window.y));
+        minDepth = std::min(minDepth, window.z);
+    }
+
+    if (maxWindow.x < 0.0F || maxWindow.y < 0.0F || minWindow.x >= static_cast<float>(width) || minWindow.y >= static_cast<float>(height)) return true;
+
+    // Every pixel the box touches, not only those whose centers it covers
+    const auto maxX = static_cast<float>(width - 1);
+    const auto maxY = static_cast<float>(height - 1);
+    const auto x0 = static_cast<int>(std::clamp(minWindow.x, 0.0F, maxX));
+    const auto y0 = static_cast<int>(std::clamp(minWindow.y, 0.0F, maxY));
+    const auto x1 = static_cast<int>(std::clamp(maxWindow.x, 0.0F, maxX));
+    const auto y1 = static_cast<int>(std::clamp(maxWindow.y, 0.0F, maxY));
+
+    // The coarsest level where the box spans at most two texels each way
+    auto l = std::size_t{0U};
+    while (l + 1U < levels.size() && ((x1 >> l) - (x0 >> l) > 1 || (y1 >> l) - (y0 >> l) > 1)) ++l;
+
+    const auto& level = levels[l];
+    const auto* texels = pyramid.data() + level.offset;
+    auto farthest = 0.0F;
+    for (auto y = y0 >> l; y <= y1 >> l; ++y) {
+        for (auto x = x0 >> l; x <= x1 >> l; ++x) {
+            farthest = std::max(farthest, texels[y * level.width + x]);
+        }
+    }
+
+    if (minDepth > farthest) {
+        ++stats.culled;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,287 @@
+#include "programcache.h"
+
+#include "debugutils.h"
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr auto BINARY_MAGIC = std::uint32_t{0x53505243U};
+constexpr auto FNV_OFFSET_BASIS = std::uint64_t{0xCBF29CE484222325U};
+constexpr auto FNV_PRIME = std::uint64_t{0x100000001B3U};
+// Lets the driver pick how many compiler threads to use
+constexpr auto MAX_COMPILER_THREADS = GLuint{0xFFFFFFFFU};
+
+struct BinaryHeader {
+    std::uint32_t magic;
+    std::uint32_t format;
+    std::uint64_t key;
+    std::uint64_t size;
+};
+
+auto HashBytes(std::uint64_t hash, std::string_view bytes) noexcept -> std::uint64_t {
+    for (const auto c : bytes) {
+        hash ^= static_cast<std::uint8_t>(c);
+        hash *= FNV_PRIME;
+    }
+    // Terminating each field keeps "ab" + "c" apart from "a" + "bc"
+    hash ^= 0xFFU;
+    hash *= FNV_PRIME;
+    return hash;
+}
+
+auto ReadFile(const std::filesystem::path& fileName) -> std::string {
+    auto file = std::ifstream(fileName, std::ifstream::ate | std::ifstream::binary);
+    if (!file.is_open()) ThrowMessage("ERROR", "Couldn't open file \"{}\"", fileName.string());
+
+    const auto length = file.tellg();
+    file.seekg(0);
+    auto contents = std::string(static_cast<std::size_t>(length), '\0');
+    file.read(contents.data(), length);
+    return contents;
+}
+
+auto GetString(GLenum name) -> std::string_view {
+    const auto* value = reinterpret_cast<const char*>(glGetString(name)); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    return value != nullptr ? std::string_view(value) : std::string_view{};
+}
+
+auto GetShaderLog(GLuint shader) -> std::string {
+    auto infoLogLength = GLint{};
+    glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &infoLogLength);
+    auto infoLog = std::string(static_cast<std::size_t>(infoLogLength), '\0');
+    glGetShaderInfoLog(shader, infoLogLength, nullptr, infoLog.data());
+    return infoLog;
+}
+
+auto GetProgramLog(GLuint program) -> std::string {
+    auto infoLogLength = GLint{};
+    glGetProgramiv(program, GL_INFO_LOG_LENGTH, &infoLogLength);
+    auto infoLog = std::string(static_cast<std::size_t>(infoLogLength), '\0');
+    glGetProgramInfoLog(program, infoLogLength, nullptr, infoLog.data());
+    return infoLog;
+}
+
+auto IsLinked(GLuint program) -> bool {
+    auto success = GLint{};
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    return static_cast<bool>(success);
+}
+
+}
+
+auto HashProgram(std::string_view driver, const ProgramDesc& desc, std::span<const std::string> sources) noexcept -> std::uint64_t {
+    auto hash = HashBytes(FNV_OFFSET_BASIS, driver);
+
+    for (const auto& define : desc.defines) hash = HashBytes(hash, define);
+    for (auto i = std::size_t{0U}; i < desc.stages.size() && i < sources.size(); ++i) {
+        hash = HashBytes(hash, std::format("{}", desc.stages[i].type));
+        hash = HashBytes(hash, sources[i]);
+    }
+
+    return hash;
+}
+
+auto InjectDefines(std::string_view source, std::span<const std::string> defines) -> std::string {
+    auto block = std::string{};
+    for (const auto& define : defines) block += std::format("#define {}\n", define);
+    if (block.empty()) return std::string(source);
+
+    // GLSL requires #version to come first, so defines go on the line after it
+    auto insertAt = std::size_t{0U};
+    if (const auto version = source.find("#version"); version != std::string_view::npos) {
+        const auto lineEnd = source.find('\n', version);
+        insertAt = lineEnd != std::string_view::npos ? lineEnd + 1U : source.size();
+    }
+
+    auto result = std::string(source.substr(0U, insertAt));
+    if (!result.empty() && result.back() != '\n') result += '\n';
+    result += block;
+    result += source.substr(insertAt);
+    return result;
+}
+
+ProgramCache::ProgramCache(std::filesystem::path directory)
+    : directory{std::move(directory)}
+{
+    driver = std::format("{}\n{}\n{}", GetString(GL_VENDOR), GetString(GL_RENDERER), GetString(GL_VERSION));
+
+    auto numFormats = GLint{};
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+    binariesSupported = numFormats > 0;
+
+    auto error = std::error_code{};
+    std::filesystem::create_directories(this->directory, error);
+    if (error) {
+        DebugMessage("WARN", "Couldn't create program cache directory \"{}\", binaries won't be saved", this->directory.string());
+        binariesSupported = false;
+    }
+
+    if (GLAD_GL_KHR_parallel_shader_compile) {
+        glMaxShaderCompilerThreadsKHR(MAX_COMPILER_THREADS);
+    } else if (GLAD_GL_ARB_parallel_shader_compile) {
+        glMaxShaderCompilerThreadsARB(MAX_COMPILER_THREADS);
+    }
+}
+
+auto ProgramCache::CachePath(std::uint64_t key) const -> std::filesystem::path {
+    return directory / std::format("{:016x}.bin", key);
+}
+
+auto ProgramCache::LoadBinary(std::uint64_t key) -> GLuint {
+    const auto path = CachePath(key);
+    auto file = std::ifstream(path, std::ifstream::binary);
+    if (!file.is_open()) return 0U;
+
+    auto sizeError = std::error_code{};
+    const auto fileSize = std::filesystem::file_size(path, sizeError);
+    if (sizeError || fileSize < sizeof(BinaryHeader)) return 0U;
+
+    auto header = BinaryHeader{};
+    file.read(reinterpret_cast<char*>(&header), sizeof(header)); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    if (!file || header.magic != BINARY_MAGIC || header.key != key) return 0U;
+
+    // A size the file can't hold means it was truncated or corrupted, recompiling beats allocating whatever it claims
+    if (header.size > fileSize - sizeof(header)) {
+        DebugMessage("WARN", "Discarding program binary \"{}\" claiming {} bytes it doesn't have", path.string(), header.size);
+        return 0U;
+    }
+
+    auto binary = std::vector<char>(header.size);
+    file.read(binary.data(), static_cast<std::streamsize>(binary.size()));
+    if (!file) return 0U;
+
+    const auto program = glCreateProgram();
+    glProgramBinary(program, header.format, binary.data(), static_cast<GLsizei>(binary.size()));
+
+    // Drivers reject binaries from other versions even when the strings match, which just means a recompile
+    if (!IsLinked(program)) {
+        DebugMessage("WARN", "Discarding program binary \"{}\" rejected by the driver", path.string());
+        glDeleteProgram(program);
+        ++stats.numRejected;
+        return 0U;
+    }
+
+    return program;
+}
+
+auto ProgramCache::SaveBinary(std::uint64_t key, GLuint program) const -> void {
+    auto length = GLint{};
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+
+    auto binary = std::vector<char>(static_cast<std::size_t>(length));
+    auto format = GLenum{};
+    glGetProgramBinary(program, length, nullptr, &format, binary.data());
+
+    const auto header = BinaryHeader{
+        .magic = BINARY_MAGIC,
+        .format = format,
+        .key = key,
+        .size = binary.size()
+    };
+
+    // Written aside and renamed so a crash never leaves a truncated binary under the real name
+    const auto path = CachePath(key);
+    auto tempPath = path;
+    tempPath += ".tmp";
+    {
+        auto file = std::ofstream(tempPath, std::ofstream::binary | std::ofstream::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header)); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+        file.write(binary.data(), static_cast<std::streamsize>(binary.size()));
+        if (!file) {
+            DebugMessage("WARN", "Couldn't write program binary \"{}\"", tempPath.string());
+            return;
+        }
+    }
+
+    auto error = std::error_code{};
+    std::filesystem::rename(tempPath, path, error);
+    if (error) DebugMessage("WARN", "Couldn't write program binary \"{}\"", path.string());
+}
+
+auto ProgramCache::Load(std::span<const ProgramDesc> descs) -> std::vector<GLuint> {
+    struct Pending {
+        std::size_t index;
+        std::uint64_t key;
+        GLuint program;
+        std::vector<GLuint> shaders;
+    };
+
+    auto programs = std::vector<GLuint>(descs.size(), 0U);
+    auto pending = std::vector<Pending>{};
+
+    for (auto i = std::size_t{0U}; i < descs.size(); ++i) {
+        const auto& desc = descs[i];
+        auto sources = std::vector<std::string>{};
+        for (const auto& stage : desc.stages) sources.push_back(ReadFile(stage.fileName));
+
+        const auto key = HashProgram(driver, desc, sources);
+        if (binariesSupported) {
+            programs[i] = LoadBinary(key);
+            if (programs[i] != 0U) {
+                ++stats.numHits;
+                continue;
+            }
+        }
+
+        auto& compile = pending.emplace_back(i, key, glCreateProgram(), std::vector<GLuint>{});
+        if (binariesSupported) glProgramParameteri(compile.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
+        for (auto stage = std::size_t{0U}; stage < desc.stages.size(); ++stage) {
+            const auto shader = glCreateShader(desc.stages[stage].type);
+            const auto source = InjectDefines(sources[stage], desc.defines);
+            const auto* sourceCStr = source.c_str();
+
+            glShaderSource(shader, 1, &sourceCStr, nullptr);
+            glCompileShader(shader);
+            glAttachShader(compile.program, shader);
+            compile.shaders.push_back(shader);
+        }
+
+        glLinkProgram(compile.program);
+    }
+
+    // Querying link status is what waits on the compiler, so it is left until every program is in flight
+    for (auto next = std::size_t{0U}; next < pending.size(); ++next) {
+        auto& compile = pending[next];
+        const auto linked = IsLinked(compile.program);
+
+        auto log = std::string{};
+        for (const auto shader : compile.shaders) {
+            if (!linked) log += GetShaderLog(shader);
+            glDetachShader(compile.program, shader);
+            glDeleteShader(shader);
+        }
+
+        if (!linked) {
+            log += GetProgramLog(compile.program);
+            for (auto remaining = next; remaining < pending.size(); ++remaining) glDeleteProgram(pending[remaining].program);
+            for (const auto program : programs) glDeleteProgram(program);
+            ThrowMessage("ERROR", "Shader linking error:\n{}", log);
+        }
+
+        if (binariesSupported) SaveBinary(compile.key, compile.program);
+        programs[compile.index] = compile.program;
+        ++stats.numMisses;
+    }
+
+    DebugMessage("INFO", "Loaded {} programs, {} from the binary cache", descs.size(), descs.size() - pending.size());
+    return programs;
+}
+
+auto ProgramCache::Load(const ProgramDesc& desc) -> GLuint {
+    return Load(std::span<const ProgramDesc>(&desc, 1U)).front();
+}
@@ -0,0 +1,43 @@
+#include "renderdevice.h"
+
+#include "commandlist.h"
+#include "glstate.h"
+#include "renderqueue.h"
+#include "streambuffer.h"
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <bit>
+#include <cstddef>
+#include <span>
+
+auto RenderDevice::Replay(const CommandList& commands) -> void {
+    auto& glState = GLState::GetInstance();
+    if (commands.viewportWidth > 0 && commands.viewportHeight > 0) glState.Viewport(0, 0, commands.viewportWidth, commands.viewportHeight);
+
+    if (commands.batches.empty()) return;
+
+    const auto instanceBytes = std::span(commands.instanceData).size_bytes();
+    const auto commandBytes = std::span(commands.indirectCommands).size_bytes();
+    frameStream.BeginFrame(frameStream.AlignedSize(sizeof(CameraUniforms)) + frameStream.AlignedSize(instanceBytes) + frameStream.AlignedSize(commandBytes));
+
+    const auto cameraRange = frameStream.Write(std::span(&commands.camera, 1U));
+    const auto instanceRange = frameStream.Write(std::span(commands.instanceData));
+    const auto commandRange = frameStream.Write(std::span(commands.indirectCommands));
+
+    const auto streamBuffer = frameStream.Buffer();
+    glState.BindBufferRange(GL_UNIFORM_BUFFER, CAMERA_BINDING, streamBuffer, cameraRange.offset, cameraRange.size);
+    glState.BindBufferRange(GL_SHADER_STORAGE_BUFFER, INSTANCE_BINDING, streamBuffer, instanceRange.offset, instanceRange.size);
+    glState.BindBuffer(GL_DRAW_INDIRECT_BUFFER, streamBuffer);
+
+    for (const auto& batch : commands.batches) {
+        glState.UseProgram(batch.program);
+        glState.BindVertexArray(batch.vao);
+
+        const auto commandOffset = static_cast<std::size_t>(commandRange.offset) + batch.firstCommand * sizeof(DrawArraysIndirectCommand);
+        glMultiDrawArraysIndirect(GL_TRIANGLES, std::bit_cast<const void*>(commandOffset), static_cast<GLsizei>(batch.numCommands), 0);
+    }
+
+    frameStream.EndFrame();
+}
@@ -0,0 +1,67 @@
+#include "renderqueue.h"
+
+#include "cpuprofiler.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr auto RADIX_BITS = 8U;
+constexpr auto RADIX_SIZE = std::size_t{1U} << RADIX_BITS;
+constexpr auto NUM_PASSES = 64U / RADIX_BITS;
+
+constexpr auto Mask(unsigned int bits) noexcept -> std::uint64_t {
+    return (std::uint64_t{1U} << bits) - 1U;
+}
+
+}
+
+auto SortKey::Make(RenderPass pass, std::uint32_t program, std::uint32_t vao, std::uint32_t mesh, float depth) noexcept -> std::uint64_t {
+    const auto maxDepth = static_cast<float>(Mask(DEPTH_BITS));
+    auto quantisedDepth = static_cast<std::uint64_t>(std::clamp(depth, 0.0F, 1.0F) * maxDepth);
+    if (pass == RenderPass::Transparent) quantisedDepth = Mask(DEPTH_BITS) - quantisedDepth;
+
+    return ((static_cast<std::uint64_t>(pass) & Mask(PASS_BITS)) << PASS_SHIFT)
+        | ((static_cast<std::uint64_t>(program) & Mask(PROGRAM_BITS)) << PROGRAM_SHIFT)
+        | ((static_cast<std::uint64_t>(vao) & Mask(VAO_BITS)) << VAO_SHIFT)
+        | ((static_cast<std::uint64_t>(mesh) & Mask(MESH_BITS)) << MESH_SHIFT)
+        | (quantisedDepth << DEPTH_SHIFT);
+}
+
+auto RenderQueue::Sort() -> void {
+    auto zone = ProfileZone{"RenderQueue::Sort"};
+    if (packets.size() < 2U) return;
+
+    auto histograms = std::array<std::array<std::size_t, RADIX_SIZE>, NUM_PASSES>{};
+    for (const auto& packet : packets) {
+        for (auto pass = 0U; pass < NUM_PASSES; ++pass) {
+            ++histograms[pass][(packet.sortKey >> (pass * RADIX_BITS)) & Mask(RADIX_BITS)];
+        }
+    }
+
+    scratch.resize(packets.size());
+
+    for (auto pass = 0U; pass < NUM_PASSES; ++pass) {
+        auto& histogram = histograms[pass];
+        const auto shift = pass * RADIX_BITS;
+
+        const auto sharedByte = (packets.front().sortKey >> shift) & Mask(RADIX_BITS);
+        if (histogram[sharedByte] == packets.size()) continue;
+
+        auto offset = std::size_t{0U};
+        for (auto& count : histogram) {
+            offset += std::exchange(count, offset);
+        }
+
+        for (const auto& packet : packets) {
+            scratch[histogram[(packet.sortKey >> shift) & Mask(RADIX_BITS)]++] = packet;
+        }
+
+        std::swap(packets, scratch);
+    }
+}
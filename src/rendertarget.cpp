@@ -0,0 +1,51 @@
+#include "rendertarget.h"
+
+#include "debugutils.h"
+#include "glstate.h"
+#include "memorytracker.h"
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <format>
+
+namespace {
+
+// RGBA8 colour plus packed depth and stencil
+constexpr auto BYTES_PER_PIXEL = std::size_t{8U};
+
+using GpuMemory = NamedMemoryTag<"GPU/Render targets">;
+
+}
+
+RenderTarget::RenderTarget(GLsizei width, GLsizei height)
+    : width{width}, height{height}
+{
+    glCreateRenderbuffers(1, &colour);
+    glNamedRenderbufferStorage(colour, GL_RGBA8, width, height);
+
+    glCreateRenderbuffers(1, &depth);
+    glNamedRenderbufferStorage(depth, GL_DEPTH24_STENCIL8, width, height);
+
+    glCreateFramebuffers(1, &framebuffer);
+    glNamedFramebufferRenderbuffer(framebuffer, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colour);
+    glNamedFramebufferRenderbuffer(framebuffer, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depth);
+
+    const auto status = glCheckNamedFramebufferStatus(framebuffer, GL_DRAW_FRAMEBUFFER);
+    if (status != GL_FRAMEBUFFER_COMPLETE) ThrowMessage("ERROR", "Render target {}x{} is incomplete (status {:#x})", width, height, status);
+    GpuMemory::Counter().Add(static_cast<std::size_t>(width) * static_cast<std::size_t>(height) * BYTES_PER_PIXEL);
+}
+
+RenderTarget::~RenderTarget() noexcept {
+    GLState::GetInstance().FramebufferDeleted(framebuffer);
+    glDeleteFramebuffers(1, &framebuffer);
+    glDeleteRenderbuffers(1, &colour);
+    glDeleteRenderbuffers(1, &depth);
+    GpuMemory::Counter().Remove(static_cast<std::size_t>(width) * static_cast<std::size_t>(height) * BYTES_PER_PIXEL);
+}
+
+auto RenderTarget::Bind() const noexcept -> void {
+    auto& glState = GLState::GetInstance();
+    glState.BindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffer);
+    glState.Viewport(0, 0, width, height);
+}
@@ -0,0 +1,110 @@
+#include "renderthread.h"
+
+#include "commandlist.h"
+#include "cpuprofiler.h"
+#include "debugutils.h"
+#include "gltask.h"
+
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+
+#include <future>
+#include <iterator>
+#include <mutex>
+#include <stop_token>
+#include <utility>
+#include <vector>
+
+RenderThread::RenderThread(GLFWwindow* window, ReplayFn replay, bool present)
+    : window{window}, replay{std::move(replay)}, present{present}
+{
+    DebugMessage("INFO", "Starting render thread");
+    glfwMakeContextCurrent(nullptr);
+    thread = std::jthread([this](std::stop_token stopToken) { ThreadLoop(stopToken); });
+}
+
+RenderThread::~RenderThread() noexcept {
+    thread.request_stop();
+    wake.notify_all();
+    thread.join();
+    glfwMakeContextCurrent(window);
+}
+
+auto RenderThread::Submit(CommandList& commands) -> void {
+    std::ranges::move(deferred, std::back_inserter(commands.tasks));
+    deferred.clear();
+
+    {
+        auto lock = std::unique_lock{mutex};
+        frameTaken.wait(lock, [&] { return !hasPending; });
+        std::swap(pending, commands);
+        hasPending = true;
+    }
+
+    wake.notify_one();
+}
+
+auto RenderThread::Defer(GLTask task) -> void {
+    deferred.push_back(std::move(task));
+}
+
+auto RenderThread::RunSync(GLTask task) -> void {
+    auto done = std::promise<void>{};
+    auto future = done.get_future();
+
+    {
+        auto lock = std::scoped_lock{mutex};
+        syncTasks.emplace_back([&] {
+            task();
+            done.set_value();
+        });
+    }
+
+    wake.notify_one();
+    future.wait();
+}
+
+auto RenderThread::RunSyncTasks(std::unique_lock<std::mutex>& lock) -> void {
+    while (!syncTasks.empty()) {
+        auto tasks = std::exchange(syncTasks, {});
+        lock.unlock();
+        for (auto& task : tasks) { task(); }
+        lock.lock();
+    }
+}
+
+auto RenderThread::ThreadLoop(std::stop_token stopToken) -> void {
+    glfwMakeContextCurrent(window);
+    CpuProfiler::GetInstance().SetThreadName("Render");
+
+    // Swapped with pending, so the three lists rotate and keep their capacity
+    auto replaying = CommandList{};
+
+    while (true) {
+        {
+            auto lock = std::unique_lock{mutex};
+            wake.wait(lock, stopToken, [&] { return hasPending || !syncTasks.empty(); });
+            RunSyncTasks(lock);
+
+            if (stopToken.stop_requested()) break;
+            if (!hasPending) continue;
+
+            std::swap(pending, replaying);
+            hasPending = false;
+        }
+
+        frameTaken.notify_one();
+
+        {
+            auto zone = ProfileZone{"RenderThread::Replay"};
+            for (auto& task : replaying.tasks) { task(); }
+            replay(replaying);
+        }
+        if (present) {
+            auto zone = ProfileZone{"RenderThread::Present"};
+            glfwSwapBuffers(window);
+        }
+    }
+
+    glfwMakeContextCurrent(nullptr);
+}
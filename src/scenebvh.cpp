@@ -0,0 +1,393 @@
+#include "scenebvh.h"
+
+#include "bounds.h"
+#include "componentmanagers.h"
+#include "cpuprofiler.h"
+#include "culling.h"
+#include "framearena.h"
+#include "jobsystem.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr auto NUM_BINS = 12;
+
+auto Fatten(const BoundingBox& box) noexcept -> BoundingBox {
+    const auto margin = (box.max - box.min) * SceneBvh::FAT_MARGIN;
+    return BoundingBox{ .min = box.min - margin, .max = box.max + margin };
+}
+
+auto Index(std::int32_t node) noexcept -> std::size_t { return static_cast<std::size_t>(node); }
+
+}
+
+auto SceneBvh::Tree::Cost() const noexcept -> float {
+    if (root == NULL_NODE) return 0.0F;
+
+    const auto rootArea = nodes[Index(root)].bounds.SurfaceArea();
+    return rootArea > 0.0F ? internalArea / rootArea : 0.0F;
+}
+
+auto SceneBvh::Tree::AllocateNode() -> std::int32_t {
+    if (freeNodes.empty()) {
+        nodes.emplace_back();
+        return static_cast<std::int32_t>(nodes.size() - 1U);
+    }
+
+    const auto index = freeNodes.back();
+    freeNodes.pop_back();
+    nodes[Index(index)] = Node{};
+    return index;
+}
+
+auto SceneBvh::Tree::FreeNode(std::int32_t index) -> void {
+    auto& node = nodes[Index(index)];
+    if (!node.IsLeaf()) internalArea -= node.bounds.SurfaceArea();
+    node = Node{};
+    freeNodes.push_back(index);
+}
+
+auto SceneBvh::Tree::SetBounds(std::int32_t index, const BoundingBox& bounds) -> void {
+    auto& node = nodes[Index(index)];
+    if (!node.IsLeaf()) internalArea += bounds.SurfaceArea() - node.bounds.SurfaceArea();
+    node.bounds = bounds;
+}
+
+auto SceneBvh::Tree::Refit(std::int32_t index) -> void {
+    while (index != NULL_NODE) {
+        const auto& node = nodes[Index(index)];
+        SetBounds(index, nodes[Index(node.left)].bounds.Merged(nodes[Index(node.right)].bounds));
+        index = nodes[Index(index)].parent;
+    }
+}
+
+auto SceneBvh::Tree::InsertLeaf(EntityId entity, const BoundingBox& bounds) -> void {
+    const auto leaf = AllocateNode();
+    nodes[Index(leaf)].bounds = bounds;
+    nodes[Index(leaf)].entity = entity;
+    leaves.insert_or_assign(entity, leaf);
+
+    if (root == NULL_NODE) {
+        root = leaf;
+        return;
+    }
+
+    // Walks down while pairing with the current node costs more than pushing the leaf into a child
+    auto sibling = root;
+    while (!nodes[Index(sibling)].IsLeaf()) {
+        const auto& node = nodes[Index(sibling)];
+        const auto area = node.bounds.SurfaceArea();
+        const auto combinedArea = node.bounds.Merged(bounds).SurfaceArea();
+        const auto cost = 2.0F * combinedArea;
+        const auto inheritedCost = 2.0F * (combinedArea - area);
+
+        auto ChildCost = [&](std::int32_t child) {
+            const auto& childNode = nodes[Index(child)];
+            const auto merged = childNode.bounds.Merged(bounds).SurfaceArea();
+            return (childNode.IsLeaf() ? merged : merged - childNode.bounds.SurfaceArea()) + inheritedCost;
+        };
+
+        const auto leftCost = ChildCost(node.left);
+        const auto rightCost = ChildCost(node.right);
+        if (cost < leftCost && cost < rightCost) break;
+
+        sibling = leftCost < rightCost ? node.left : node.right;
+    }
+
+    const auto oldParent = nodes[Index(sibling)].parent;
+    const auto parent = AllocateNode();
+    nodes[Index(parent)].parent = oldParent;
+    nodes[Index(parent)].left = sibling;
+    nodes[Index(parent)].right = leaf;
+    SetBounds(parent, nodes[Index(sibling)].bounds.Merged(bounds));
+    nodes[Index(sibling)].parent = parent;
+    nodes[Index(leaf)].parent = parent;
+
+    if (oldParent == NULL_NODE) {
+        root = parent;
+    } else {
+        auto& grandparent = nodes[Index(oldParent)];
+        (grandparent.left == sibling ? grandparent.left : grandparent.right) = parent;
+        Refit(oldParent);
+    }
+}
+
+auto SceneBvh::Tree::RemoveLeaf(EntityId entity) -> void {
+    const auto found = leaves.find(entity);
+    if (found == leaves.end()) return;
+
+    const auto leaf = found->second;
+    leaves.erase(found);
+
+    const auto parent = nodes[Index(leaf)].parent;
+    FreeNode(leaf);
+    if (parent == NULL_NODE) {
+        root = NULL_NODE;
+        return;
+    }
+
+    const auto& parentNode = nodes[Index(parent)];
+    const auto sibling = parentNode.left == leaf ? parentNode.right : parentNode.left;
+    const auto grandparent = parentNode.parent;
+    FreeNode(parent);
+
+    nodes[Index(sibling)].parent = grandparent;
+    if (grandparent == NULL_NODE) {
+        root = sibling;
+        return;
+    }
+
+    auto& grandparentNode = nodes[Index(grandparent)];
+    (grandparentNode.left == parent ? grandparentNode.left : grandparentNode.right) = sibling;
+    Refit(grandparent);
+}
+
+auto SceneBvh::Tree::SetLeafBounds(EntityId entity, const BoundingBox& bounds) -> void {
+    const auto leaf = leaves.at(entity);
+    SetBounds(leaf, bounds);
+    Refit(nodes[Index(leaf)].parent);
+}
+
+auto SceneBvh::Tree::Build(std::vector<std::pair<EntityId, BoundingBox>> items) -> Tree {
+    auto zone = ProfileZone{"SceneBvh::Build"};
+    auto tree = Tree{};
+    if (items.empty()) return tree;
+
+    tree.nodes.reserve(items.size() * 2U - 1U);
+    tree.leaves.reserve(items.size());
+    tree.root = tree.BuildRange(items, NULL_NODE);
+    return tree;
+}
+
+auto SceneBvh::Tree::BuildRange(std::span<std::pair<EntityId, BoundingBox>> items, std::int32_t parent) -> std::int32_t {
+    const auto index = AllocateNode();
+    nodes[Index(index)].parent = parent;
+
+    if (items.size() == 1U) {
+        nodes[Index(index)].bounds = items.front().second;
+        nodes[Index(index)].entity = items.front().first;
+        leaves.insert_or_assign(items.front().first, index);
+        return index;
+    }
+
+    auto centroidBounds = BoundingBox{ .min = items.front().second.Center(), .max = items.front().second.Center() };
+    for (const auto& [entity, box] : items) {
+        centroidBounds.min = glm::min(centroidBounds.min, box.Center());
+        centroidBounds.max = glm::max(centroidBounds.max, box.Center());
+    }
+
+    const auto size = centroidBounds.max - centroidBounds.min;
+    const auto axis = size.x > size.y ? (size.x > size.z ? 0 : 2) : (size.y > size.z ? 1 : 2);
+    auto middle = items.size() / 2U;
+
+    if (size[axis] > 0.0F) {
+        // Binned SAH, the split minimising count times surface area on both sides
+        struct Bin {
+            std::size_t count = 0U;
+            std::optional<BoundingBox> bounds;
+        };
+        auto bins = std::array<Bin, NUM_BINS>{};
+        auto BinOf = [&](const BoundingBox& box) {
+            const auto offset = (box.Center()[axis] - centroidBounds.min[axis]) / size[axis];
+            return std::min(static_cast<int>(offset * static_cast<float>(NUM_BINS)), NUM_BINS - 1);
+        };
+
+        for (const auto& [entity, box] : items) {
+            auto& bin = bins[static_cast<std::size_t>(BinOf(box))];
+            ++bin.count;
+            bin.bounds = bin.bounds ? bin.bounds->Merged(box) : box;
+        }
+
+        auto rightAreas = std::array<float, NUM_BINS>{};
+        auto rightCounts = std::array<std::size_t, NUM_BINS>{};
+        auto accumulated = std::optional<BoundingBox>{};
+        auto count = std::size_t{0U};
+        for (auto i = NUM_BINS - 1; i > 0; --i) {
+            const auto& bin = bins[static_cast<std::size_t>(i)];
+            if (bin.bounds) accumulated = accumulated ? accumulated->Merged(*bin.bounds) : *bin.bounds;
+            count += bin.count;
+            rightAreas[static_cast<std::size_t>(i)] = accumulated ? accumulated->SurfaceArea() : 0.0F;
+            rightCounts[static_cast<std::size_t>(i)] = count;
+        }
+
+        auto bestSplit = 0;
+        auto bestCost = std::numeric_limits<float>::max();
+        accumulated.reset();
+        count = 0U;
+        for (auto i = 1; i < NUM_BINS; ++i) {
+            const auto& bin = bins[static_cast<std::size_t>(i - 1)];
+            if (bin.bounds) accumulated = accumulated ? accumulated->Merged(*bin.bounds) : *bin.bounds;
+            count += bin.count;
+            if (count == 0U || rightCounts[static_cast<std::size_t>(i)] == 0U) continue;
+
+            const auto cost = static_cast<float>(count) * accumulated->SurfaceArea()
+                + static_cast<float>(rightCounts[static_cast<std::size_t>(i)]) * rightAreas[static_cast<std::size_t>(i)];
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestSplit = i;
+            }
+        }
+
+        if (bestSplit > 0) {
+            const auto split = std::ranges::partition(items, [&](const auto& item) { return BinOf(item.second) < bestSplit; });
+            middle = static_cast<std::size_t>(split.begin() - items.begin());
+        }
+    }
+
+    // Identical centroids or a one-sided split fall back to halving by count
+    if (middle == 0U || middle == items.size()) {
+        middle = items.size() / 2U;
+        std::ranges::nth_element(items, items.begin() + static_cast<std::ptrdiff_t>(middle), {}, [axis](const auto& item) { return item.second.Center()[axis]; });
+    }
+
+    const auto left = BuildRange(items.first(middle), index);
+    const auto right = BuildRange(items.subspan(middle), index);
+    nodes[Index(index)].left = left;
+    nodes[Index(index)].right = right;
+    SetBounds(index, nodes[Index(left)].bounds.Merged(nodes[Index(right)].bounds));
+    return index;
+}
+
+SceneBvh::~SceneBvh() noexcept {
+    if (pendingBuild) JobSystem::GetInstance().Wait(*pendingBuild);
+}
+
+auto SceneBvh::MarkChanged(EntityId entity) -> void {
+    if (pendingBuild) changedDuringBuild.insert(entity);
+}
+
+auto SceneBvh::Update(EntityId entity, const BoundingBox& worldBounds) -> void {
+    const auto found = entries.find(entity);
+    if (found == entries.end()) {
+        const auto fatBounds = Fatten(worldBounds);
+        entries.emplace(entity, Entry{.fatBounds = fatBounds, .lastSeen = syncStamp});
+        tree.InsertLeaf(entity, fatBounds);
+        MarkChanged(entity);
+        return;
+    }
+
+    auto& entry = found->second;
+    entry.lastSeen = syncStamp;
+    if (entry.fatBounds.Contains(worldBounds)) return;
+
+    entry.fatBounds = Fatten(worldBounds);
+    tree.SetLeafBounds(entity, entry.fatBounds);
+    MarkChanged(entity);
+    ++stats.numRefits;
+}
+
+auto SceneBvh::Remove(EntityId entity) -> void {
+    if (entries.erase(entity) == 0U) return;
+
+    tree.RemoveLeaf(entity);
+    MarkChanged(entity);
+}
+
+auto SceneBvh::EndSync() -> void {
+    auto zone = ProfileZone{"SceneBvh::EndSync"};
+    auto stale = std::pmr::vector<EntityId>{&FrameArena::ForThread()};
+    for (const auto& [entity, entry] : entries) {
+        if (entry.lastSeen != syncStamp) stale.push_back(entity);
+    }
+    for (const auto entity : stale) Remove(entity);
+
+    Maintain();
+}
+
+auto SceneBvh::Maintain() -> void {
+    if (pendingBuild) {
+        if (!pendingBuild->IsDone()) return;
+        AdoptRebuild(TakeRebuild());
+    }
+
+    if (tree.Cost() > builtCost * REBUILD_THRESHOLD) StartRebuild();
+}
+
+auto SceneBvh::Rebuild() -> void {
+    if (pendingBuild) AdoptRebuild(TakeRebuild());
+
+    auto items = std::vector<std::pair<EntityId, BoundingBox>>{};
+    items.reserve(entries.size());
+    for (const auto& [entity, entry] : entries) items.emplace_back(entity, entry.fatBounds);
+
+    AdoptRebuild(Tree::Build(std::move(items)));
+}
+
+auto SceneBvh::StartRebuild() -> void {
+    auto items = std::vector<std::pair<EntityId, BoundingBox>>{};
+    items.reserve(entries.size());
+    for (const auto& [entity, entry] : entries) items.emplace_back(entity, entry.fatBounds);
+
+    if (items.size() < MIN_BACKGROUND_ENTITIES) {
+        AdoptRebuild(Tree::Build(std::move(items)));
+        return;
+    }
+
+    changedDuringBuild.clear();
+    pendingBuild = JobSystem::GetInstance().Submit([this, items = std::move(items)]() mutable { builtTree = Tree::Build(std::move(items)); });
+}
+
+auto SceneBvh::TakeRebuild() -> Tree {
+    JobSystem::GetInstance().Wait(*pendingBuild);
+    pendingBuild.reset();
+    return std::exchange(builtTree, Tree{});
+}
+
+auto SceneBvh::AdoptRebuild(Tree built) -> void {
+    // The build saw the entries as they were when it started, anything touched since is brought up to date
+    for (const auto entity : changedDuringBuild) {
+        built.RemoveLeaf(entity);
+        if (const auto found = entries.find(entity); found != entries.end()) built.InsertLeaf(entity, found->second.fatBounds);
+    }
+    changedDuringBuild.clear();
+
+    tree = std::move(built);
+    builtCost = tree.Cost();
+    ++stats.numRebuilds;
+}
+
+auto SceneBvh::QueryFrustum(const Frustum& frustum, std::vector<EntityId>& entities) const -> void {
+    Traverse(
+        [&](const BoundingBox& bounds) { return frustum.Intersects(bounds); },
+        [&](const Node& leaf) { entities.push_back(leaf.entity); }
+    );
+}
+
+auto SceneBvh::QueryBox(const BoundingBox& box, std::vector<EntityId>& entities) const -> void {
+    Traverse(
+        [&](const BoundingBox& bounds) { return bounds.Overlaps(box); },
+        [&](const Node& leaf) { entities.push_back(leaf.entity); }
+    );
+}
+
+auto SceneBvh::QuerySphere(const BoundingSphere& sphere, std::vector<EntityId>& entities) const -> void {
+    const auto radiusSquared = sphere.radius * sphere.radius;
+    Traverse(
+        [&](const BoundingBox& bounds) {
+            const auto offset = sphere.center - glm::clamp(sphere.center, bounds.min, bounds.max);
+            return glm::dot(offset, offset) <= radiusSquared;
+        },
+        [&](const Node& leaf) { entities.push_back(leaf.entity); }
+    );
+}
+
+auto SceneBvh::QueryRay(const Ray& ray, float maxDistance, std::vector<RayHit>& hits) const -> void {
+    const auto firstHit = hits.size();
+    Traverse(
+        [&](const BoundingBox& bounds) { return ray.Intersect(bounds, maxDistance).has_value(); },
+        [&](const Node& leaf) { hits.push_back(RayHit{.entity = leaf.entity, .distance = ray.Intersect(leaf.bounds, maxDistance).value_or(0.0F)}); }
+    );
+    std::ranges::sort(hits.begin() + static_cast<std::ptrdiff_t>(firstHit), hits.end(), {}, &RayHit::distance);
+}
@@ -1,6 +1,7 @@
 #include "shader.h"
 
 #include "debugutils.h"
+#include "glstate.h"
 
 #include <glad/glad.h>
 
@@ -58,5 +59,8 @@ Shader::~Shader() noexcept {
 }
 
 ShaderProgram::~ShaderProgram() noexcept {
+    if (programHandle == 0u) return;
+
+    GLState::GetInstance().ProgramDeleted(programHandle);
     glDeleteProgram(programHandle);
 }
\ No newline at end of file
@@ -0,0 +1,124 @@
+#include "streambuffer.h"
+
+#include "debugutils.h"
+#include "glstate.h"
+#include "memorytracker.h"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+
+namespace {
+
+constexpr auto MAP_FLAGS = GLbitfield{GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT};
+constexpr auto WAIT_TIMEOUT = GLuint64{1'000'000U};
+constexpr auto MIN_ALIGNMENT = std::size_t{16U};
+
+using GpuMemory = NamedMemoryTag<"GPU/Stream buffers">;
+
+auto QueryAlignment() noexcept -> std::size_t {
+    auto uniformAlignment = GLint{0};
+    auto storageAlignment = GLint{0};
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniformAlignment);
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &storageAlignment);
+    return std::max({MIN_ALIGNMENT, static_cast<std::size_t>(uniformAlignment), static_cast<std::size_t>(storageAlignment)});
+}
+
+}
+
+StreamBuffer::StreamBuffer(std::size_t regionSize)
+    : alignment{QueryAlignment()}
+{
+    Create(AlignUp(std::max(regionSize, alignment), alignment));
+}
+
+StreamBuffer::~StreamBuffer() noexcept {
+    Destroy();
+}
+
+auto StreamBuffer::Create(std::size_t newRegionSize) -> void {
+    regionSize = newRegionSize;
+    const auto totalSize = static_cast<GLsizeiptr>(regionSize * NUM_REGIONS);
+
+    glCreateBuffers(1, &buffer);
+    glNamedBufferStorage(buffer, totalSize, nullptr, MAP_FLAGS);
+    GpuMemory::Counter().Add(static_cast<std::size_t>(totalSize));
+    mapped = static_cast<std::byte*>(glMapNamedBufferRange(buffer, 0, totalSize, MAP_FLAGS));
+
+    if (mapped == nullptr) [[unlikely]] {
+        ThrowMessage("ERROR", "Failed to persistently map a {} byte stream buffer", totalSize);
+    }
+}
+
+auto StreamBuffer::Destroy() noexcept -> void {
+    for (auto index = std::size_t{0U}; index < NUM_REGIONS; ++index) { WaitForRegion(index); }
+
+    if (buffer == 0U) return;
+    glUnmapNamedBuffer(buffer);
+    GLState::GetInstance().BufferDeleted(buffer);
+    glDeleteBuffers(1, &buffer);
+    GpuMemory::Counter().Remove(regionSize * NUM_REGIONS);
+    buffer = 0U;
+    mapped = nullptr;
+}
+
+auto StreamBuffer::WaitForRegion(std::size_t index) noexcept -> void {
+    auto& fence = fences[index];
+    if (fence == nullptr) return;
+
+    auto status = glClientWaitSync(fence, 0, 0);
+    if (status == GL_TIMEOUT_EXPIRED) {
+        ++numStalls;
+        do {
+            status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, WAIT_TIMEOUT);
+        } while (status == GL_TIMEOUT_EXPIRED);
+    }
+
+    if (status == GL_WAIT_FAILED) [[unlikely]] {
+        DebugMessage("ERROR", "Waiting on stream buffer region {} failed", index);
+    }
+
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+auto StreamBuffer::BeginFrame(std::size_t requiredSize) -> void {
+    head = 0U;
+
+    if (requiredSize > regionSize) {
+        const auto newRegionSize = AlignUp(std::max(requiredSize, regionSize * 2U), alignment);
+        DebugMessage("INFO", "Growing stream buffer regions to {} bytes", newRegionSize);
+
+        Destroy();
+        Create(newRegionSize);
+        region = 0U;
+        return;
+    }
+
+    WaitForRegion(region);
+}
+
+auto StreamBuffer::EndFrame() noexcept -> void {
+    fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    region = (region + 1U) % NUM_REGIONS;
+    head = 0U;
+}
+
+auto StreamBuffer::Allocate(std::size_t size) -> Allocation {
+    const auto alignedSize = AlignUp(size, alignment);
+    if (head + alignedSize > regionSize) [[unlikely]] {
+        ThrowMessage("ERROR", "Stream buffer region overflowed by {} bytes, pass the frame's size to BeginFrame", head + alignedSize - regionSize);
+    }
+
+    const auto offset = region * regionSize + head;
+    head += alignedSize;
+
+    return Allocation{
+        .data = mapped + offset,
+        .offset = static_cast<GLintptr>(offset),
+        .size = static_cast<GLsizeiptr>(size)
+    };
+}
@@ -0,0 +1,225 @@
+#include "transformbatch.h"
+
+#include "cpuprofiler.h"
+#include "transformcomponent.h"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64)
+#define TRANSFORM_USE_SSE 1
+#include <xmmintrin.h>
+#endif
+
+#if defined(__AVX__)
+#define TRANSFORM_USE_AVX 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+struct Streams {
+    const float* scale[3];
+    const float* rotation[4];
+    const float* translation[3];
+};
+
+// Lane types share one kernel, each stores a column for every transform it holds
+struct ScalarLanes {
+    using V = float;
+    static constexpr auto WIDTH = std::size_t{1U};
+
+    static auto Load(const float* p) noexcept -> V { return *p; }
+    static auto Set(float f) noexcept -> V { return f; }
+    static auto Add(V a, V b) noexcept -> V { return a + b; }
+    static auto Sub(V a, V b) noexcept -> V { return a - b; }
+    static auto Mul(V a, V b) noexcept -> V { return a * b; }
+    static auto Div(V a, V b) noexcept -> V { return a / b; }
+
+    static auto Store(glm::mat4* out, int column, V x, V y, V z, V w) noexcept -> void {
+        out[0][column] = glm::vec4(x, y, z, w);
+    }
+};
+
+#ifdef TRANSFORM_USE_SSE
+struct SseLanes {
+    using V = __m128;
+    static constexpr auto WIDTH = std::size_t{4U};
+
+    static auto Load(const float* p) noexcept -> V { return _mm_loadu_ps(p); }
+    static auto Set(float f) noexcept -> V { return _mm_set1_ps(f); }
+    static auto Add(V a, V b) noexcept -> V { return _mm_add_ps(a, b); }
+    static auto Sub(V a, V b) noexcept -> V { return _mm_sub_ps(a, b); }
+    static auto Mul(V a, V b) noexcept -> V { return _mm_mul_ps(a, b); }
+    static auto Div(V a, V b) noexcept -> V { return _mm_div_ps(a, b); }
+
+    // Lanes hold one component for four transforms, transposing turns them into four columns
+    static auto Store(glm::mat4* out, int column, V x, V y, V z, V w) noexcept -> void {
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+        _mm_storeu_ps(&out[0][column].x, x);
+        _mm_storeu_ps(&out[1][column].x, y);
+        _mm_storeu_ps(&out[2][column].x, z);
+        _mm_storeu_ps(&out[3][column].x, w);
+    }
+};
+#endif
+
+#ifdef TRANSFORM_USE_AVX
+struct AvxLanes {
+    using V = __m256;
+    static constexpr auto WIDTH = std::size_t{8U};
+
+    static auto Load(const float* p) noexcept -> V { return _mm256_loadu_ps(p); }
+    static auto Set(float f) noexcept -> V { return _mm256_set1_ps(f); }
+    static auto Add(V a, V b) noexcept -> V { return _mm256_add_ps(a, b); }
+    static auto Sub(V a, V b) noexcept -> V { return _mm256_sub_ps(a, b); }
+    static auto Mul(V a, V b) noexcept -> V { return _mm256_mul_ps(a, b); }
+    static auto Div(V a, V b) noexcept -> V { return _mm256_div_ps(a, b); }
+
+    static auto Store(glm::mat4* out, int column, V x, V y, V z, V w) noexcept -> void {
+        SseLanes::Store(out, column, _mm256_castps256_ps128(x), _mm256_castps256_ps128(y), _mm256_castps256_ps128(z), _mm256_castps256_ps128(w));
+        SseLanes::Store(out + 4, column, _mm256_extractf128_ps(x, 1), _mm256_extractf128_ps(y, 1), _mm256_extractf128_ps(z, 1), _mm256_extractf128_ps(w, 1));
+    }
+};
+#endif
+
+// Indexed [column][row], matching glm::mat3_cast
+template <typename L>
+struct RotationLanes {
+    typename L::V m[3][3];
+};
+
+template <typename L>
+auto LoadRotation(const Streams& streams, std::size_t i) noexcept -> RotationLanes<L> {
+    const auto x = L::Load(streams.rotation[0] + i);
+    const auto y = L::Load(streams.rotation[1] + i);
+    const auto z = L::Load(streams.rotation[2] + i);
+    const auto w = L::Load(streams.rotation[3] + i);
+
+    const auto one = L::Set(1.0F);
+    const auto two = L::Set(2.0F);
+
+    const auto xx = L::Mul(x, x);
+    const auto yy = L::Mul(y, y);
+    const auto zz = L::Mul(z, z);
+    const auto xy = L::Mul(x, y);
+    const auto xz = L::Mul(x, z);
+    const auto yz = L::Mul(y, z);
+    const auto wx = L::Mul(w, x);
+    const auto wy = L::Mul(w, y);
+    const auto wz = L::Mul(w, z);
+
+    auto r = RotationLanes<L>{};
+    r.m[0][0] = L::Sub(one, L::Mul(two, L::Add(yy, zz)));
+    r.m[0][1] = L::Mul(two, L::Add(xy, wz));
+    r.m[0][2] = L::Mul(two, L::Sub(xz, wy));
+    r.m[1][0] = L::Mul(two, L::Sub(xy, wz));
+    r.m[1][1] = L::Sub(one, L::Mul(two, L::Add(xx, zz)));
+    r.m[1][2] = L::Mul(two, L::Add(yz, wx));
+    r.m[2][0] = L::Mul(two, L::Add(xz, wy));
+    r.m[2][1] = L::Mul(two, L::Sub(yz, wx));
+    r.m[2][2] = L::Sub(one, L::Mul(two, L::Add(xx, yy)));
+    return r;
+}
+
+template <bool INVERSE, typename L>
+auto Kernel(const Streams& streams, std::size_t i, glm::mat4* out) noexcept -> void {
+    const auto r = LoadRotation<L>(streams, i);
+    const auto zero = L::Set(0.0F);
+    const auto one = L::Set(1.0F);
+
+    typename L::V scale[3];
+    typename L::V translation[3];
+    for (auto axis = 0; axis < 3; ++axis) {
+        scale[axis] = L::Load(streams.scale[axis] + i);
+        translation[axis] = L::Load(streams.translation[axis] + i);
+    }
+
+    if constexpr (!INVERSE) {
+        for (auto c = 0; c < 3; ++c) {
+            L::Store(out, c, L::Mul(r.m[c][0], scale[c]), L::Mul(r.m[c][1], scale[c]), L::Mul(r.m[c][2], scale[c]), zero);
+        }
+        L::Store(out, 3, translation[0], translation[1], translation[2], one);
+    } else {
+        // Transposed rotation divided by scale, then the translation carried through it
+        typename L::V invScale[3];
+        typename L::V invTranslation[3];
+        for (auto axis = 0; axis < 3; ++axis) {
+            invScale[axis] = L::Div(one, scale[axis]);
+            const auto dot = L::Add(L::Add(L::Mul(r.m[axis][0], translation[0]), L::Mul(r.m[axis][1], translation[1])), L::Mul(r.m[axis][2], translation[2]));
+            invTranslation[axis] = L::Mul(L::Sub(zero, dot), invScale[axis]);
+        }
+
+        for (auto c = 0; c < 3; ++c) {
+            L::Store(out, c, L::Mul(r.m[0][c], invScale[0]), L::Mul(r.m[1][c], invScale[1]), L::Mul(r.m[2][c], invScale[2]), zero);
+        }
+        L::Store(out, 3, invTranslation[0], invTranslation[1], invTranslation[2], one);
+    }
+}
+
+template <bool INVERSE>
+auto RunKernel(const Streams& streams, std::size_t size, glm::mat4* out) noexcept -> void {
+    auto i = std::size_t{0U};
+
+#ifdef TRANSFORM_USE_AVX
+    for (; i + AvxLanes::WIDTH <= size; i += AvxLanes::WIDTH) { Kernel<INVERSE, AvxLanes>(streams, i, out + i); }
+#endif
+#ifdef TRANSFORM_USE_SSE
+    for (; i + SseLanes::WIDTH <= size; i += SseLanes::WIDTH) { Kernel<INVERSE, SseLanes>(streams, i, out + i); }
+#endif
+    for (; i < size; ++i) { Kernel<INVERSE, ScalarLanes>(streams, i, out + i); }
+}
+
+}
+
+auto TransformBatch::Clear() noexcept -> void {
+    for (auto* stream : {&scaleX, &scaleY, &scaleZ, &rotationX, &rotationY, &rotationZ, &rotationW, &translationX, &translationY, &translationZ}) {
+        stream->clear();
+    }
+}
+
+auto TransformBatch::Reserve(std::size_t size) -> void {
+    for (auto* stream : {&scaleX, &scaleY, &scaleZ, &rotationX, &rotationY, &rotationZ, &rotationW, &translationX, &translationY, &translationZ}) {
+        stream->reserve(size);
+    }
+    matrices.reserve(size);
+}
+
+auto TransformBatch::Add(const TransformComponent& transform) -> void {
+    scaleX.push_back(transform.scale.x);
+    scaleY.push_back(transform.scale.y);
+    scaleZ.push_back(transform.scale.z);
+    rotationX.push_back(transform.rotation.x);
+    rotationY.push_back(transform.rotation.y);
+    rotationZ.push_back(transform.rotation.z);
+    rotationW.push_back(transform.rotation.w);
+    translationX.push_back(transform.translation.x);
+    translationY.push_back(transform.translation.y);
+    translationZ.push_back(transform.translation.z);
+}
+
+auto TransformBatch::ComputeWorld() -> std::span<const glm::mat4> {
+    auto zone = ProfileZone{"TransformBatch::ComputeWorld"};
+    matrices.resize(Size());
+    const auto streams = Streams{
+        .scale = {scaleX.data(), scaleY.data(), scaleZ.data()},
+        .rotation = {rotationX.data(), rotationY.data(), rotationZ.data(), rotationW.data()},
+        .translation = {translationX.data(), translationY.data(), translationZ.data()}
+    };
+    RunKernel<false>(streams, Size(), matrices.data());
+    return matrices;
+}
+
+auto TransformBatch::ComputeInverseWorld() -> std::span<const glm::mat4> {
+    matrices.resize(Size());
+    const auto streams = Streams{
+        .scale = {scaleX.data(), scaleY.data(), scaleZ.data()},
+        .rotation = {rotationX.data(), rotationY.data(), rotationZ.data(), rotationW.data()},
+        .translation = {translationX.data(), translationY.data(), translationZ.data()}
+    };
+    RunKernel<true>(streams, Size(), matrices.data());
+    return matrices;
+}
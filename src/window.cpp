@@ -22,10 +22,6 @@ auto GlobalCleanup() noexcept -> void {
     glfwTerminate();
 }
 
-auto FrameBufferSizeCallback([[maybe_unused]] GLFWwindow* window, int width, int height) noexcept -> void {
-    glViewport(0, 0, width, height);
-}
-
 Window::Window()
     : window{glfwCreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "Project", nullptr, nullptr)}
 {
@@ -37,7 +33,7 @@ auto Window::GetInstance() noexcept -> Window& {
     return window;
 }
 
-void Window::Initialize() {
+void Window::Initialize(const WindowSettings& settings) {
     DebugMessage("INFO", "Initializing GLFW");
 
     if (glfwInit() != GLFW_TRUE) { ThrowMessage("ERROR", "Failed to initialize GLFW"); }
@@ -46,6 +42,7 @@ void Window::Initialize() {
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, OPENGL_MAJOR_VERSION);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, OPENGL_MINOR_VERSION);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, settings.visible ? GLFW_TRUE : GLFW_FALSE);
 
     auto& window = GetInstance();
 
@@ -55,8 +52,7 @@ void Window::Initialize() {
 
     if (!static_cast<bool>(gladLoadGL())) { ThrowMessage("ERROR", "Failed to initialise GLAD"); }
 
-    glfwSetFramebufferSizeCallback(GetWindow(), &FrameBufferSizeCallback);
-    glfwSwapInterval(1);
+    glfwSwapInterval(settings.vsync ? 1 : 0);
 }
 
 void Window::Terminate() noexcept {
@@ -72,3 +68,9 @@ auto Window::GetAspectRatio() noexcept -> float {
     glfwGetWindowSize(GetWindow(), &width, &height);
     return static_cast<float>(width) / static_cast<float>(height);
 }
+
+auto Window::GetFramebufferSize() noexcept -> std::pair<int, int> {
+    int width{}; int height{};
+    glfwGetFramebufferSize(GetWindow(), &width, &height);
+    return {width, height};
+}
@@ -0,0 +1,88 @@
+#include "benchmark.h"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <numeric>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+TEST(BenchmarkOptions, DefaultsToInteractive) {
+    const auto options = BenchmarkOptions::Parse({});
+    EXPECT_FALSE(options.headless);
+    EXPECT_FALSE(options.IsBenchmark());
+    EXPECT_EQ(options.numWarmupFrames, DEFAULT_WARMUP_FRAMES);
+    EXPECT_FALSE(options.outputPath.has_value());
+}
+
+TEST(BenchmarkOptions, ParsesFlags) {
+    const auto args = std::array<std::string_view, 7>{"--headless", "--benchmark", "500", "--warmup", "10", "--output", "out.json"};
+    const auto options = BenchmarkOptions::Parse(args);
+
+    EXPECT_TRUE(options.headless);
+    EXPECT_EQ(options.numFrames, 500U);
+    EXPECT_EQ(options.numWarmupFrames, 10U);
+    EXPECT_EQ(options.outputPath, "out.json");
+}
+
+TEST(BenchmarkOptions, ParsesInputPaths) {
+    const auto options = BenchmarkOptions::Parse(std::array<std::string_view, 2>{"--replay-input", "session.bin"});
+    EXPECT_EQ(options.replayInputPath, "session.bin");
+    EXPECT_FALSE(options.recordInputPath.has_value());
+    EXPECT_EQ(BenchmarkOptions::Parse(std::array<std::string_view, 2>{"--trace", "trace.json"}).tracePath, "trace.json");
+    EXPECT_EQ(BenchmarkOptions::Parse(std::array<std::string_view, 2>{"--memory-report", "memory.txt"}).memoryReportPath, "memory.txt");
+
+    EXPECT_THROW((void) BenchmarkOptions::Parse(std::array<std::string_view, 4>{"--record-input", "a.bin", "--replay-input", "b.bin"}), std::runtime_error);
+    EXPECT_THROW((void) BenchmarkOptions::Parse(std::array<std::string_view, 1>{"--record-input"}), std::runtime_error);
+}
+
+TEST(BenchmarkOptions, ParsesPresentMode) {
+    EXPECT_FALSE(BenchmarkOptions::Parse({}).presentMode.has_value());
+    EXPECT_EQ(BenchmarkOptions::Parse(std::array<std::string_view, 2>{"--present", "uncapped"}).presentMode, PresentMode::Uncapped);
+
+    const auto capped = BenchmarkOptions::Parse(std::array<std::string_view, 2>{"--fps", "60"});
+    EXPECT_EQ(capped.presentMode, PresentMode::Capped);
+    EXPECT_EQ(capped.targetFps, 60.0);
+
+    EXPECT_THROW((void) BenchmarkOptions::Parse(std::array<std::string_view, 2>{"--present", "fast"}), std::runtime_error);
+    EXPECT_THROW((void) BenchmarkOptions::Parse(std::array<std::string_view, 2>{"--fps", "0"}), std::runtime_error);
+    EXPECT_THROW((void) BenchmarkOptions::Parse(std::array<std::string_view, 4>{"--present", "vsync", "--fps", "60"}), std::runtime_error);
+}
+
+TEST(BenchmarkOptions, RejectsBadArguments) {
+    EXPECT_THROW((void) BenchmarkOptions::Parse(std::array<std::string_view, 1>{"--fast"}), std::runtime_error);
+    EXPECT_THROW((void) BenchmarkOptions::Parse(std::array<std::string_view, 2>{"--benchmark", "ten"}), std::runtime_error);
+    EXPECT_THROW((void) BenchmarkOptions::Parse(std::array<std::string_view, 1>{"--benchmark"}), std::runtime_error);
+    EXPECT_THROW((void) BenchmarkOptions::Parse(std::array<std::string_view, 1>{"--headless"}), std::runtime_error) << "Nothing would end the run";
+    EXPECT_TRUE(BenchmarkOptions::Parse(std::array<std::string_view, 3>{"--headless", "--replay-input", "session.bin"}).headless);
+}
+
+TEST(FrameTimeSummary, NearestRankPercentiles) {
+    auto samples = std::vector<double>(100U);
+    std::iota(samples.rbegin(), samples.rend(), 1.0);
+
+    const auto summary = FrameTimeSummary::FromSamples(samples);
+    EXPECT_DOUBLE_EQ(summary.minMs, 1.0);
+    EXPECT_DOUBLE_EQ(summary.avgMs, 50.5);
+    EXPECT_DOUBLE_EQ(summary.p50Ms, 50.0);
+    EXPECT_DOUBLE_EQ(summary.p95Ms, 95.0);
+    EXPECT_DOUBLE_EQ(summary.p99Ms, 99.0);
+}
+
+TEST(FrameTimeSummary, EmptyIsZero) {
+    const auto summary = FrameTimeSummary::FromSamples({});
+    EXPECT_EQ(summary.p99Ms, 0.0);
+}
+
+TEST(BenchmarkRecorder, JsonReportsPerFrameCounts) {
+    auto recorder = BenchmarkRecorder{};
+    recorder.AddFrame(2.0, 4U, 100U);
+    recorder.AddFrame(4.0, 2U, 300U);
+
+    const auto json = recorder.ToJson();
+    EXPECT_NE(json.find("\"frames\": 2"), std::string::npos);
+    EXPECT_NE(json.find("\"avg\": 3.0000"), std::string::npos);
+    EXPECT_NE(json.find("\"drawCallsPerFrame\": 3.00"), std::string::npos);
+    EXPECT_NE(json.find("\"trianglesPerFrame\": 200.00"), std::string::npos);
+}
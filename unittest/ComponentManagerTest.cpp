@@ -1,4 +1,5 @@
 #include "ecsmanager.h"
+#include "memorytracker.h"
 
 #include <glm/glm.hpp>
 
@@ -6,6 +7,7 @@
 #include <gtest/gtest.h>
 
 #include <concepts>
+#include <cstdint>
 #include <utility>
 
 template <typename CompManagerType>
@@ -90,4 +92,23 @@ TEST(DynamicCompManager, CanDoPolymorphism) {
     
     EXPECT_TRUE(compManager.Get(5U).IsBase());
     EXPECT_FALSE(compManager.Get(9U).IsBase());
-}
\ No newline at end of file
+}
+
+TYPED_TEST(CompManagerFixture, ReportsMemory) {
+    const auto before = TypeParam{}.GetMemoryStats().bytes;
+    {
+        TypeParam compManager{};
+        for (auto id = 0U; id < 100U; ++id) compManager.New(id, static_cast<int>(id));
+
+        const auto stats = compManager.GetMemoryStats();
+        EXPECT_EQ(stats.name, "int");
+        EXPECT_EQ(stats.numComponents, 100U);
+        EXPECT_GE(stats.numBuckets, 100U);
+        EXPECT_GT(stats.loadFactor, 0.0F);
+        EXPECT_GT(stats.bytes, before + static_cast<std::int64_t>(100U * sizeof(int)));
+        EXPECT_GE(stats.highWater, stats.bytes);
+        // Both managers count under the component type, so the tracker's report uses the same name
+        EXPECT_EQ(MemoryTracker::GetInstance().GetCounter("ECS/" + stats.name).Bytes(), stats.bytes);
+    }
+    EXPECT_EQ(TypeParam{}.GetMemoryStats().bytes, before) << "Everything is given back when the manager goes";
+}
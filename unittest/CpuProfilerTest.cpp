@@ -0,0 +1,68 @@
+#include "cpuprofiler.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace {
+
+auto CountZones(std::string_view name) -> std::size_t {
+    const auto& captured = CpuProfiler::GetInstance().GetCaptured();
+    return static_cast<std::size_t>(std::ranges::count_if(captured, [&](const auto& captured) { return captured.event.name == name; }));
+}
+
+}
+
+TEST(CpuProfiler, RecordsNestedZonesOnlyWhileCapturing) {
+    if constexpr (!ProfilingEnabled) GTEST_SKIP() << "Profiling zones are compiled out";
+
+    auto& profiler = CpuProfiler::GetInstance();
+    { auto zone = ProfileZone{"Before"}; }
+
+    profiler.BeginCapture();
+    {
+        auto outer = ProfileZone{"Outer"};
+        auto inner = ProfileZone{"Inner"};
+    }
+    profiler.EndCapture();
+
+    { auto zone = ProfileZone{"After"}; }
+    profiler.Collect();
+
+    EXPECT_EQ(CountZones("Before"), 0U);
+    EXPECT_EQ(CountZones("After"), 0U);
+    ASSERT_EQ(CountZones("Outer"), 1U);
+    ASSERT_EQ(CountZones("Inner"), 1U);
+
+    const auto& captured = profiler.GetCaptured();
+    const auto outer = std::ranges::find(captured, std::string_view("Outer"), [](const auto& zone) { return std::string_view(zone.event.name); });
+    const auto inner = std::ranges::find(captured, std::string_view("Inner"), [](const auto& zone) { return std::string_view(zone.event.name); });
+    EXPECT_LE(outer->event.startNs, inner->event.startNs);
+    EXPECT_GE(outer->event.endNs, inner->event.endNs);
+    EXPECT_EQ(outer->threadId, inner->threadId);
+}
+
+TEST(CpuProfiler, CollectsZonesFromOtherThreads) {
+    if constexpr (!ProfilingEnabled) GTEST_SKIP() << "Profiling zones are compiled out";
+
+    auto& profiler = CpuProfiler::GetInstance();
+    profiler.BeginCapture();
+    std::jthread([] {
+        CpuProfiler::GetInstance().SetThreadName("Worker \"A\"");
+        for (auto i = 0; i < 100; ++i) { auto zone = ProfileZone{"Work"}; }
+    }).join();
+    { auto zone = ProfileZone{"Main"}; }
+    profiler.EndCapture();
+
+    EXPECT_EQ(CountZones("Work"), 100U);
+    EXPECT_EQ(CountZones("Main"), 1U);
+    EXPECT_EQ(profiler.NumDropped(), 0U);
+
+    const auto trace = profiler.ToChromeTrace();
+    EXPECT_TRUE(trace.starts_with("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["));
+    EXPECT_NE(trace.find(R"("args":{"name":"Worker \"A\""})"), std::string::npos);
+    EXPECT_NE(trace.find(R"({"name":"Work","ph":"X","pid":1,"tid":)"), std::string::npos);
+}
@@ -0,0 +1,106 @@
+#include "bounds.h"
+#include "culling.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+auto MakeTestFrustum() -> Frustum {
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
+    const auto proj = glm::perspective(glm::radians(90.0F), 1.0F, 0.1F, 100.0F);
+    const auto view = glm::lookAt(glm::vec3(0.0F), glm::vec3(0.0F, 0.0F, -1.0F), glm::vec3(0.0F, 1.0F, 0.0F));
+    return Frustum::FromMatrix(proj * view);
+}
+
+}
+
+TEST(Culling, SphereAgainstFrustum) {
+    const auto frustum = MakeTestFrustum();
+
+    EXPECT_TRUE(frustum.Intersects(BoundingSphere{ .center = glm::vec3(0.0F, 0.0F, -10.0F), .radius = 1.0F }));
+    EXPECT_FALSE(frustum.Intersects(BoundingSphere{ .center = glm::vec3(0.0F, 0.0F, 10.0F), .radius = 1.0F }));
+    EXPECT_FALSE(frustum.Intersects(BoundingSphere{ .center = glm::vec3(0.0F, 0.0F, -200.0F), .radius = 1.0F }));
+    EXPECT_FALSE(frustum.Intersects(BoundingSphere{ .center = glm::vec3(20.0F, 0.0F, -10.0F), .radius = 1.0F }));
+    EXPECT_TRUE(frustum.Intersects(BoundingSphere{ .center = glm::vec3(10.5F, 0.0F, -10.0F), .radius = 1.0F })) << "Sphere straddling a plane is kept";
+}
+
+TEST(Culling, BoxAgainstFrustum) {
+    const auto frustum = MakeTestFrustum();
+
+    EXPECT_TRUE(frustum.Intersects(BoundingBox{ .min = glm::vec3(-1.0F, -1.0F, -11.0F), .max = glm::vec3(1.0F, 1.0F, -9.0F) }));
+    EXPECT_FALSE(frustum.Intersects(BoundingBox{ .min = glm::vec3(-1.0F, -1.0F, 9.0F), .max = glm::vec3(1.0F, 1.0F, 11.0F) }));
+}
+
+TEST(Culling, BatchMatchesScalar) {
+    const auto frustum = MakeTestFrustum();
+    auto culler = FrustumCuller{};
+
+    auto expected = std::vector<std::uint32_t>{};
+    for (auto i = 0; i < 103; ++i) {
+        const auto sphere = BoundingSphere{
+            .center = glm::vec3(static_cast<float>(i % 13) * 3.0F - 18.0F, 0.0F, static_cast<float>(i % 7) * 8.0F - 24.0F),
+            .radius = 0.5F
+        };
+        const auto index = culler.Add(sphere);
+        if (frustum.Intersects(sphere)) expected.push_back(index);
+    }
+
+    const auto& visible = culler.Cull(frustum);
+    EXPECT_EQ(visible, expected);
+    EXPECT_EQ(culler.GetStats().tested, 103U);
+    EXPECT_EQ(culler.GetStats().culled, 103U - expected.size());
+    EXPECT_EQ(culler.Size(), 103U) << "Padding is removed after culling";
+}
+
+TEST(Culling, TransformedBounds) {
+    const auto transform = glm::scale(glm::translate(glm::mat4(1.0F), glm::vec3(5.0F, 0.0F, 0.0F)), glm::vec3(2.0F));
+
+    const auto sphere = BoundingSphere{ .center = glm::vec3(1.0F, 0.0F, 0.0F), .radius = 1.0F }.Transformed(transform);
+    EXPECT_NEAR(sphere.center.x, 7.0F, 1e-5F);
+    EXPECT_NEAR(sphere.radius, 2.0F, 1e-5F);
+
+    const auto box = BoundingBox{ .min = glm::vec3(-1.0F), .max = glm::vec3(1.0F) }.Transformed(transform);
+    EXPECT_NEAR(box.min.x, 3.0F, 1e-5F);
+    EXPECT_NEAR(box.max.x, 7.0F, 1e-5F);
+    EXPECT_NEAR(box.max.y, 2.0F, 1e-5F);
+}
+
+TEST(Culling, ClusterRangesMerge) {
+    const auto frustum = MakeTestFrustum();
+    const auto up = glm::vec3(0.0F, 1.0F, 0.0F);
+
+    auto clusters = std::vector<MeshCluster>{};
+    for (auto i = 0U; i < 4U; ++i) {
+        clusters.push_back(MeshCluster{
+            .firstVertex = i * 6U,
+            .numVertices = 6U,
+            .sphere = BoundingSphere{ .center = glm::vec3(static_cast<float>(i) * 4.0F, -2.0F, -10.0F), .radius = 1.0F },
+            .coneAxis = up,
+            .coneCutoff = 0.0F
+        });
+    }
+    clusters[3].sphere.center.x = 100.0F;
+
+    auto ranges = DrawRanges{};
+    auto stats = ClusterCullStats{};
+    CullClusters(clusters, frustum, glm::vec3(0.0F), ranges, stats);
+
+    ASSERT_EQ(ranges.Size(), 1U);
+    EXPECT_EQ(ranges.firsts[0], 0);
+    EXPECT_EQ(ranges.counts[0], 18);
+    EXPECT_EQ(stats.tested, 4U);
+    EXPECT_EQ(stats.frustumCulled, 1U);
+    EXPECT_EQ(stats.backfaceCulled, 0U);
+
+    ranges.Clear();
+    stats = ClusterCullStats{};
+    CullClusters(clusters, frustum, glm::vec3(0.0F, -20.0F, 0.0F), ranges, stats);
+    EXPECT_EQ(ranges.Size(), 0U);
+    EXPECT_EQ(stats.backfaceCulled, 3U);
+}
@@ -1,11 +1,13 @@
 #include "ecsmanager.h"
 
 #include "componentmanagers.h"
+#include "framearena.h"
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
 #include <format>
+#include <memory_resource>
 #include <set>
 #include <string>
 #include <tuple>
@@ -336,3 +338,53 @@ TEST(ECS, RangedComponentAccess) {
     }
 }
 
+
+TEST(ECS, CollectAllIntoArena) {
+    auto ecs = ECSManager<
+        BasicCompManager<int>,
+        BasicCompManager<double>
+    >{};
+
+    for (auto i = 0; i < 6; ++i) {
+        auto id = ecs.NewEntity().value();
+        ecs.NewComponent<int>(id, i);
+        if (i % 2 == 0) ecs.NewComponent<double>(id, 0.5 * i);
+    }
+
+    auto arena = FrameArena{};
+    auto collected = ecs.CollectAll<int, double>(&arena);
+    EXPECT_TRUE((std::same_as<decltype(collected), std::pmr::vector<std::tuple<EntityId, int&, double&>>>));
+    EXPECT_EQ(collected.get_allocator().resource(), &arena);
+    ASSERT_EQ(collected.size(), 3U);
+
+    // Entries still refer to the components themselves
+    std::get<1>(collected[1]) = 42;
+    EXPECT_EQ(ecs.GetComponent<int>(std::get<0>(collected[1])), 42);
+}
+
+TEST(ECS, ReportsMemoryPerManager) {
+    auto ecs = ECSManager<
+        BasicCompManager<int>,
+        DynamicCompManager<double>
+    >{};
+
+    for (auto i = 0; i < 4; ++i) {
+        auto id = ecs.NewEntity().value();
+        ecs.NewComponent<int>(id, i);
+        if (i < 3) ecs.NewComponent<double>(id, 1.0);
+    }
+    ecs.DeleteEntity(3U);
+
+    const auto stats = ecs.GetMemoryStats();
+    EXPECT_EQ(stats.numEntitySlots, 4U);
+    EXPECT_EQ(stats.numLiveEntities, 3U);
+    EXPECT_GT(stats.entitySlotBytes, 0U);
+
+    ASSERT_EQ(stats.components.size(), 2U);
+    EXPECT_EQ(stats.components[0].name, "int");
+    EXPECT_EQ(stats.components[0].numComponents, 3U);
+    EXPECT_EQ(stats.components[1].name, "double");
+    EXPECT_EQ(stats.components[1].numComponents, 3U);
+    EXPECT_GE(stats.components[1].bytes, static_cast<std::int64_t>(3U * sizeof(double)));
+    EXPECT_NE(stats.Report().find("double"), std::string::npos);
+}
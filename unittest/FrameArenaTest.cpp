@@ -0,0 +1,96 @@
+#include "framearena.h"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Counts what reaches the heap so tests can check steady state frames never do
+class CountingResource : public std::pmr::memory_resource {
+    auto do_allocate(std::size_t bytes, std::size_t alignment) -> void* override {
+        ++numAllocations;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    auto do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) -> void override {
+        ++numDeallocations;
+        std::pmr::new_delete_resource()->deallocate(pointer, bytes, alignment);
+    }
+
+    [[nodiscard]] auto do_is_equal(const std::pmr::memory_resource& other) const noexcept -> bool override { return this == &other; }
+
+public:
+    std::size_t numAllocations = 0U;
+    std::size_t numDeallocations = 0U;
+};
+
+}
+
+TEST(FrameArena, AllocatesAligned) {
+    auto arena = FrameArena{1'024U};
+
+    (void) arena.allocate(3U, 1U);
+    auto* aligned = arena.allocate(16U, 64U);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(aligned) % 64U, 0U);
+    EXPECT_GE(arena.BytesUsed(), 19U);
+
+    arena.Reset();
+    EXPECT_EQ(arena.BytesUsed(), 0U);
+    EXPECT_GE(arena.HighWater(), 19U);
+}
+
+TEST(FrameArena, SteadyStateFramesNeverReachUpstream) {
+    auto upstream = CountingResource{};
+    auto arena = FrameArena{256U, &upstream};
+
+    auto RunFrame = [&] {
+        arena.Reset();
+        auto values = std::pmr::vector<int>{&arena};
+        for (auto i = 0; i < 1'000; ++i) values.push_back(i);
+        auto text = std::pmr::string{"a string well past the small string buffer", &arena};
+        EXPECT_EQ(values.back(), 999);
+    };
+
+    // The first frame overflows and grows the arena, the reset after it merges the chunks
+    RunFrame();
+    RunFrame();
+    const auto numAllocations = upstream.numAllocations;
+
+    for (auto frame = 0; frame < 10; ++frame) RunFrame();
+    EXPECT_EQ(upstream.numAllocations, numAllocations);
+    EXPECT_EQ(arena.NumUpstreamAllocations(), numAllocations);
+}
+
+TEST(FrameArena, ReleasesEverythingOnDestruction) {
+    auto upstream = CountingResource{};
+    {
+        auto arena = FrameArena{64U, &upstream};
+        for (auto i = 0; i < 8; ++i) (void) arena.allocate(100U, 8U);
+    }
+    EXPECT_GT(upstream.numAllocations, 1U);
+    EXPECT_EQ(upstream.numAllocations, upstream.numDeallocations);
+}
+
+TEST(FrameArena, EachThreadHasItsOwnArena) {
+    auto& mainArena = FrameArena::ForThread();
+    EXPECT_EQ(&mainArena, &FrameArena::ForThread());
+
+    FrameArena* workerArena = nullptr;
+    std::thread([&] { workerArena = &FrameArena::ForThread(); }).join();
+    EXPECT_NE(workerArena, &mainArena);
+}
+
+TEST(FrameArena, BeginFrameResetsLazily) {
+    auto& arena = FrameArena::ForThread();
+    (void) arena.allocate(128U, 8U);
+    EXPECT_GE(arena.BytesUsed(), 128U);
+
+    FrameArena::BeginFrame();
+    EXPECT_EQ(FrameArena::ForThread().BytesUsed(), 0U);
+}
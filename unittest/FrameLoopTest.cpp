@@ -0,0 +1,115 @@
+#include "frameloop.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstddef>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+constexpr auto STEP_SECONDS = 1.0 / 100.0;
+
+auto MakeLoop(std::size_t maxStepsPerFrame = 8U) -> FrameLoop {
+    return FrameLoop{FrameLoopSettings{.simulationHz = 100.0, .presentMode = PresentMode::Uncapped, .maxStepsPerFrame = maxStepsPerFrame}};
+}
+
+}
+
+TEST(FrameLoop, AccumulatesFixedSteps) {
+    auto loop = MakeLoop();
+    EXPECT_DOUBLE_EQ(loop.StepDuration().count(), STEP_SECONDS);
+
+    EXPECT_EQ(loop.Advance(FrameLoop::Duration{0.5 * STEP_SECONDS}), 0U);
+    EXPECT_NEAR(loop.Alpha(), 0.5F, 1e-5F);
+
+    EXPECT_EQ(loop.Advance(FrameLoop::Duration{0.75 * STEP_SECONDS}), 1U);
+    EXPECT_NEAR(loop.Alpha(), 0.25F, 1e-5F);
+
+    EXPECT_EQ(loop.Advance(FrameLoop::Duration{3.0 * STEP_SECONDS}), 3U);
+    EXPECT_NEAR(loop.Alpha(), 0.25F, 1e-5F);
+
+    const auto& stats = loop.GetStats();
+    EXPECT_EQ(stats.numSteps, 4U);
+    EXPECT_EQ(stats.lastSteps, 3U);
+    EXPECT_EQ(stats.numFrames, 0U) << "Stepping on a given frame time is not timing a frame";
+}
+
+TEST(FrameLoop, DropsStepsBeyondTheLimit) {
+    auto loop = MakeLoop(4U);
+
+    EXPECT_EQ(loop.Advance(FrameLoop::Duration{10.5 * STEP_SECONDS}), 4U);
+    EXPECT_EQ(loop.GetStats().numDroppedSteps, 6U);
+    EXPECT_NEAR(loop.Alpha(), 0.5F, 1e-5F);
+
+    // The stall doesn't leave a backlog behind
+    EXPECT_EQ(loop.Advance(FrameLoop::Duration{0.25 * STEP_SECONDS}), 0U);
+}
+
+TEST(FrameLoop, FixedFrameTimeIsDeterministic) {
+    auto loop = MakeLoop();
+    auto numSteps = std::size_t{0U};
+    for (auto frame = 0; frame < 1'000; ++frame) numSteps += loop.Advance(loop.StepDuration());
+
+    EXPECT_EQ(numSteps, 1'000U);
+    EXPECT_EQ(loop.GetStats().numDroppedSteps, 0U);
+}
+
+TEST(FrameLoop, CappedModeHoldsTheFrameRate) {
+    auto loop = FrameLoop{FrameLoopSettings{.presentMode = PresentMode::Capped, .targetFps = 200.0}};
+    EXPECT_EQ(loop.GetSettings().SwapInterval(), 0);
+
+    static_cast<void>(loop.BeginFrame());
+    const auto start = FrameLoop::Clock::now();
+    for (auto frame = 0; frame < 10; ++frame) static_cast<void>(loop.BeginFrame());
+    const auto elapsed = std::chrono::duration<double, std::milli>(FrameLoop::Clock::now() - start).count();
+
+    // Ten 5 ms frames, the limiter never returns early and sleep overshoot is bounded by the spin
+    EXPECT_GE(elapsed, 50.0);
+    EXPECT_LT(elapsed, 100.0);
+    EXPECT_GT(loop.GetStats().lastWaitMs, 0.0);
+}
+
+TEST(FrameLoop, WaitingLeavesTheAccumulatorAlone) {
+    auto loop = FrameLoop{FrameLoopSettings{.presentMode = PresentMode::Capped, .targetFps = 200.0}};
+    EXPECT_FALSE(loop.WaitForFrame().has_value()) << "The first frame only starts the clock";
+
+    const auto frameTime = loop.WaitForFrame();
+    ASSERT_TRUE(frameTime.has_value());
+    EXPECT_GE(frameTime->count(), 0.005);
+    EXPECT_EQ(loop.GetStats().numFrames, 0U);
+    EXPECT_EQ(loop.Alpha(), 0.0F);
+}
+
+TEST(FrameLoop, EndFrameTimesTheFrameWithoutTheWait) {
+    auto loop = FrameLoop{FrameLoopSettings{.presentMode = PresentMode::Capped, .targetFps = 50.0}};
+    loop.EndFrame();
+    EXPECT_EQ(loop.GetStats().numFrames, 0U) << "No frame has started yet";
+
+    for (auto frame = 0; frame < 2; ++frame) {
+        static_cast<void>(loop.WaitForFrame());
+        std::this_thread::sleep_for(std::chrono::milliseconds{2});
+        loop.EndFrame();
+    }
+
+    // Each frame took about 2 ms of its 20 ms slot, the rest was spent waiting for the second one
+    const auto& stats = loop.GetStats();
+    EXPECT_EQ(stats.numFrames, 2U);
+    EXPECT_GE(stats.minFrameMs, 2.0);
+    EXPECT_LT(stats.maxFrameMs, 15.0);
+    EXPECT_GT(stats.lastWaitMs, 5.0);
+}
+
+TEST(FrameLoop, RejectsBadRates) {
+    EXPECT_THROW(FrameLoop{FrameLoopSettings{.simulationHz = 0.0}}, std::runtime_error);
+    EXPECT_THROW((FrameLoop{FrameLoopSettings{.presentMode = PresentMode::Capped, .targetFps = -1.0}}), std::runtime_error);
+}
+
+TEST(FrameLoop, ParsesPresentModes) {
+    EXPECT_EQ(ParsePresentMode("vsync"), PresentMode::Vsync);
+    EXPECT_EQ(ParsePresentMode("uncapped"), PresentMode::Uncapped);
+    EXPECT_EQ(ParsePresentMode("capped"), PresentMode::Capped);
+    EXPECT_FALSE(ParsePresentMode("fast").has_value());
+    EXPECT_EQ(FrameLoopSettings{}.SwapInterval(), 1);
+}
@@ -0,0 +1,98 @@
+#include "freelistallocator.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+TEST(FreeListAllocator, AllocatesSequentially) {
+    auto allocator = FreeListAllocator{100U};
+
+    auto a = allocator.Allocate(10U);
+    auto b = allocator.Allocate(20U);
+    ASSERT_TRUE(a.has_value());
+    ASSERT_TRUE(b.has_value());
+
+    EXPECT_EQ(allocator.Offset(*a), 0U);
+    EXPECT_EQ(allocator.Offset(*b), 10U);
+    EXPECT_EQ(allocator.UsedSize(), 30U);
+    EXPECT_EQ(allocator.FreeSize(), 70U);
+    EXPECT_FALSE(allocator.Allocate(71U).has_value());
+}
+
+TEST(FreeListAllocator, FreeCoalesces) {
+    auto allocator = FreeListAllocator{30U};
+
+    auto a = allocator.Allocate(10U).value();
+    auto b = allocator.Allocate(10U).value();
+    auto c = allocator.Allocate(10U).value();
+    EXPECT_EQ(allocator.NumFreeBlocks(), 0U);
+
+    allocator.Free(a);
+    allocator.Free(c);
+    EXPECT_EQ(allocator.NumFreeBlocks(), 2U);
+    EXPECT_FALSE(allocator.Allocate(20U).has_value()) << "Free space is fragmented";
+
+    allocator.Free(b);
+    EXPECT_EQ(allocator.NumFreeBlocks(), 1U);
+    EXPECT_EQ(allocator.LargestFreeBlock(), 30U);
+}
+
+TEST(FreeListAllocator, BestFit) {
+    auto allocator = FreeListAllocator{100U};
+
+    auto a = allocator.Allocate(30U).value();
+    [[maybe_unused]] auto b = allocator.Allocate(10U).value();
+    auto c = allocator.Allocate(5U).value();
+    [[maybe_unused]] auto d = allocator.Allocate(10U).value();
+
+    allocator.Free(a);
+    allocator.Free(c);
+
+    auto e = allocator.Allocate(5U).value();
+    EXPECT_EQ(allocator.Offset(e), 40U) << "Smallest block that fits is chosen";
+}
+
+TEST(FreeListAllocator, CompactKeepsHandles) {
+    auto allocator = FreeListAllocator{100U};
+
+    auto a = allocator.Allocate(10U).value();
+    auto b = allocator.Allocate(20U).value();
+    auto c = allocator.Allocate(30U).value();
+    allocator.Free(a);
+
+    const auto relocations = allocator.Compact();
+    ASSERT_EQ(relocations.size(), 2U);
+    EXPECT_EQ(relocations[0].handle, b);
+    EXPECT_EQ(relocations[0].from, 10U);
+    EXPECT_EQ(relocations[0].to, 0U);
+    EXPECT_EQ(relocations[1].handle, c);
+    EXPECT_EQ(relocations[1].from, 30U);
+    EXPECT_EQ(relocations[1].to, 20U);
+
+    EXPECT_EQ(allocator.Offset(b), 0U);
+    EXPECT_EQ(allocator.Offset(c), 20U);
+    EXPECT_EQ(allocator.NumFreeBlocks(), 1U);
+    EXPECT_EQ(allocator.LargestFreeBlock(), 50U);
+}
+
+TEST(FreeListAllocator, GrowExtendsTrailingBlock) {
+    auto allocator = FreeListAllocator{20U};
+
+    [[maybe_unused]] auto a = allocator.Allocate(15U).value();
+    allocator.Grow(40U);
+
+    EXPECT_EQ(allocator.Capacity(), 40U);
+    EXPECT_EQ(allocator.NumFreeBlocks(), 1U);
+    EXPECT_EQ(allocator.LargestFreeBlock(), 25U);
+}
+
+TEST(FreeListAllocator, EmptyAllocations) {
+    auto allocator = FreeListAllocator{0U};
+
+    auto a = allocator.Allocate(0U);
+    ASSERT_TRUE(a.has_value());
+    EXPECT_EQ(allocator.Size(*a), 0U);
+    allocator.Free(*a);
+    EXPECT_EQ(allocator.UsedSize(), 0U);
+}
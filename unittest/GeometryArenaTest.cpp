@@ -0,0 +1,57 @@
+#include "geometryarena.h"
+#include "meshcomponent.h"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace {
+
+// Holds GL work instead of running it, so the arena can be exercised without a context
+struct RecordingExecutor final : GLExecutor {
+    std::vector<GLTask> deferred;
+    std::size_t numSync = 0U;
+
+    auto Defer(GLTask task) -> void override { deferred.push_back(std::move(task)); }
+    auto RunSync([[maybe_unused]] GLTask task) -> void override { ++numSync; }
+};
+
+}
+
+TEST(GeometryArena, UploadsAreDeferred) {
+    auto executor = RecordingExecutor{};
+    auto arena = GeometryArena{16U};
+    arena.SetExecutor(executor);
+
+    const auto vertices = std::vector<Vertex>(6U);
+    const auto first = arena.Allocate(vertices);
+    const auto second = arena.Allocate(vertices);
+
+    EXPECT_EQ(executor.deferred.size(), 2U);
+    EXPECT_GE(executor.numSync, 1U);
+    EXPECT_EQ(arena.FirstVertex(first), 0);
+    EXPECT_EQ(arena.FirstVertex(second), 6);
+}
+
+TEST(GeometryArena, GrowthIsDeferredBeforeUpload) {
+    auto executor = RecordingExecutor{};
+    auto arena = GeometryArena{8U};
+    arena.SetExecutor(executor);
+
+    (void) arena.Allocate(std::vector<Vertex>(6U));
+    (void) arena.Allocate(std::vector<Vertex>(6U));
+
+    // Upload, reallocation, then the upload into the grown buffer
+    EXPECT_EQ(executor.deferred.size(), 3U);
+    EXPECT_GE(arena.GetAllocator().Capacity(), 12U);
+}
+
+TEST(GeometryArena, EmptyMeshesSkipUpload) {
+    auto executor = RecordingExecutor{};
+    auto arena = GeometryArena{8U};
+    arena.SetExecutor(executor);
+
+    (void) arena.Allocate(std::vector<Vertex>{});
+    EXPECT_TRUE(executor.deferred.empty());
+}
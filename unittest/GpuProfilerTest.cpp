@@ -0,0 +1,31 @@
+#include "gpuprofiler.h"
+
+#include <gtest/gtest.h>
+
+TEST(PassStats, AveragesCpuAndGpuSeparately) {
+    auto stats = PassStats{.name = "Meshes"};
+    EXPECT_EQ(stats.AverageCpuMs(), 0.0);
+    EXPECT_EQ(stats.AverageGpuMs(), 0.0);
+
+    stats.AddCpu(1.0);
+    stats.AddCpu(3.0);
+    stats.AddGpu(4.0);
+
+    EXPECT_DOUBLE_EQ(stats.AverageCpuMs(), 2.0);
+    EXPECT_DOUBLE_EQ(stats.AverageGpuMs(), 4.0);
+    EXPECT_DOUBLE_EQ(stats.lastCpuMs, 3.0);
+    EXPECT_DOUBLE_EQ(stats.lastGpuMs, 4.0);
+}
+
+TEST(PassStats, ResetKeepsLastSample) {
+    auto stats = PassStats{.name = "Frame"};
+    stats.AddCpu(2.0);
+    stats.AddGpu(5.0);
+    stats.ResetTotals();
+
+    EXPECT_EQ(stats.numCpuSamples, 0U);
+    EXPECT_EQ(stats.numGpuSamples, 0U);
+    EXPECT_EQ(stats.AverageCpuMs(), 0.0);
+    EXPECT_DOUBLE_EQ(stats.lastCpuMs, 2.0);
+    EXPECT_DOUBLE_EQ(stats.lastGpuMs, 5.0);
+}
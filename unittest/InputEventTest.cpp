@@ -0,0 +1,66 @@
+#include "inputevent.h"
+#include "spscring.h"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+TEST(SpscRing, PopsInOrderAndDropsWhenFull) {
+    auto ring = SpscRing<int, 4U>{};
+    for (auto i = 0; i < 4; ++i) EXPECT_TRUE(ring.TryPush(i));
+    EXPECT_FALSE(ring.TryPush(4));
+    EXPECT_EQ(ring.NumDropped(), 1U);
+    EXPECT_EQ(ring.Size(), 4U);
+
+    EXPECT_EQ(ring.TryPop(), 0);
+    EXPECT_TRUE(ring.TryPush(5));
+
+    auto drained = std::vector<int>{};
+    EXPECT_EQ(ring.Drain([&](int value) { drained.push_back(value); }), 4U);
+    EXPECT_EQ(drained, (std::vector<int>{1, 2, 3, 5}));
+    EXPECT_FALSE(ring.TryPop().has_value());
+}
+
+TEST(SpscRing, ProducerThreadKeepsOrder) {
+    constexpr auto numValues = std::size_t{100'000U};
+    auto ring = SpscRing<std::size_t, 256U>{};
+
+    auto producer = std::jthread{[&] {
+        for (auto i = std::size_t{0U}; i < numValues; ++i) {
+            while (!ring.TryPush(i)) std::this_thread::yield();
+        }
+    }};
+
+    auto expected = std::size_t{0U};
+    auto inOrder = true;
+    while (expected < numValues) {
+        ring.Drain([&](std::size_t value) { inOrder = inOrder && value == expected++; });
+    }
+    EXPECT_TRUE(inOrder);
+}
+
+TEST(InputEvent, CoalescesMovesAndScrollsBetweenOtherEvents) {
+    auto events = std::vector<InputEvent>{
+        InputEvent::MouseMove(1.0, 1.0),
+        InputEvent::MouseMove(2.0, 3.0),
+        InputEvent::MouseButton(0, 1, 0),
+        InputEvent::MouseMove(4.0, 5.0),
+        InputEvent::Scroll(0.0, 1.0),
+        InputEvent::Scroll(0.5, 2.0),
+        InputEvent::Key(65, 30, 1, 0)
+    };
+    CoalesceInputEvents(events);
+
+    ASSERT_EQ(events.size(), 5U);
+    EXPECT_EQ(events[0].type, InputEventType::MouseMove);
+    EXPECT_EQ(events[0].mouseMove.x, 2.0);
+    EXPECT_EQ(events[0].mouseMove.y, 3.0);
+    EXPECT_EQ(events[1].type, InputEventType::MouseButton);
+    EXPECT_EQ(events[2].mouseMove.x, 4.0);
+    EXPECT_EQ(events[3].type, InputEventType::Scroll);
+    EXPECT_EQ(events[3].scroll.x, 0.5);
+    EXPECT_EQ(events[3].scroll.y, 3.0);
+    EXPECT_EQ(events[4].key.key, 65);
+}
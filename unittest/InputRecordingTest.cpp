@@ -0,0 +1,92 @@
+#include "inputcomponent.h"
+#include "inputevent.h"
+#include "inputrecording.h"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+struct CountingComponent : public InputComponent {
+    std::vector<std::size_t> batchSizes;
+    std::vector<double> mouseX;
+
+    inline void OnEvents(std::span<const InputEvent> events) noexcept override {
+        batchSizes.push_back(events.size());
+        InputComponent::OnEvents(events);
+    }
+
+    inline void MousePosCallback(double xPos, [[maybe_unused]] double yPos) noexcept override { mouseX.push_back(xPos); }
+};
+
+auto MakeRecording() -> InputRecording {
+    auto recorder = InputRecorder{};
+    recorder.RecordFrame(std::vector{InputEvent::MouseMove(1.0, 2.0), InputEvent::Key(65, 30, 1, 0)});
+    recorder.RecordFrame({});
+    recorder.RecordFrame(std::vector{InputEvent::Char(0x263AU), InputEvent::MouseButton(1, 0, 2), InputEvent::Scroll(0.5, -1.0)});
+    recorder.RecordFrame({});
+    return recorder.GetRecording();
+}
+
+}
+
+TEST(InputRecording, RoundTripsThroughBinary) {
+    const auto recording = MakeRecording();
+    EXPECT_EQ(recording.numFrames, 4U);
+    ASSERT_EQ(recording.frames.size(), 2U);
+
+    auto stream = std::stringstream{};
+    recording.Write(stream);
+    const auto loaded = InputRecording::Read(stream);
+
+    EXPECT_EQ(loaded.numFrames, 4U);
+    ASSERT_EQ(loaded.frames.size(), 2U);
+    EXPECT_EQ(loaded.frames[0].frame, 0U);
+    EXPECT_EQ(loaded.frames[1].frame, 2U);
+    EXPECT_EQ(loaded.frames[1].time, recording.frames[1].time);
+
+    const auto& events = loaded.frames[1].events;
+    ASSERT_EQ(events.size(), 3U);
+    EXPECT_EQ(events[0].character.codePoint, 0x263AU);
+    EXPECT_EQ(events[1].mouseButton.mods, 2);
+    EXPECT_EQ(events[2].scroll.y, -1.0);
+    EXPECT_EQ(loaded.frames[0].events[1].key.scancode, 30);
+}
+
+TEST(InputRecording, RejectsBadStreams) {
+    auto garbage = std::stringstream{"not a recording"};
+    EXPECT_THROW((void) InputRecording::Read(garbage), std::runtime_error);
+
+    auto stream = std::stringstream{};
+    MakeRecording().Write(stream);
+    auto truncated = std::stringstream{stream.str().substr(0U, stream.str().size() - 4U)};
+    EXPECT_THROW((void) InputRecording::Read(truncated), std::runtime_error);
+
+    // The first frame's event count follows the 12 byte header, the frame index and its time
+    auto corrupt = stream.str();
+    corrupt.replace(24U, 4U, 4U, '\xFF');
+    auto hugeCount = std::stringstream{corrupt};
+    EXPECT_THROW((void) InputRecording::Read(hugeCount), std::runtime_error);
+}
+
+TEST(ReplayInputAdapter, DispatchesOnRecordedFrames) {
+    auto adapter = ReplayInputAdapter{MakeRecording()};
+    auto component = CountingComponent{};
+    auto input = InputSystem{adapter};
+    input.RegisterInputComponent(component);
+
+    auto eventsPerFrame = std::vector<std::size_t>{};
+    while (!adapter.Finished()) {
+        input.Update();
+        eventsPerFrame.push_back(input.Events().size());
+    }
+
+    EXPECT_EQ(eventsPerFrame, (std::vector<std::size_t>{2U, 0U, 3U, 0U}));
+    EXPECT_EQ(component.batchSizes, (std::vector<std::size_t>{2U, 3U}));
+    EXPECT_EQ(component.mouseX, std::vector<double>{1.0});
+}
@@ -0,0 +1,155 @@
+#include "jobsystem.h"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+TEST(JobSystem, RunsEverySubmittedJob) {
+    auto jobs = JobSystem{4U};
+    auto count = std::atomic<int>{0};
+
+    auto handles = std::vector<JobHandle>{};
+    for (auto i = 0; i < 1'000; ++i) handles.push_back(jobs.Submit([&count] { ++count; }));
+    jobs.WaitAll(handles);
+
+    EXPECT_EQ(count.load(), 1'000);
+    for (const auto& handle : handles) EXPECT_TRUE(handle.IsDone());
+}
+
+TEST(JobSystem, DependenciesRunFirst) {
+    auto jobs = JobSystem{4U};
+    auto orderMutex = std::mutex{};
+    auto order = std::vector<int>{};
+    auto record = [&](int step) {
+        auto lock = std::scoped_lock{orderMutex};
+        order.push_back(step);
+    };
+
+    const auto first = jobs.Submit([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds{5});
+        record(0);
+    });
+    const auto second = jobs.Submit([&] { record(1); }, std::array{first});
+    const auto third = jobs.Submit([&] { record(2); }, std::array{first, second, JobHandle{}});
+    jobs.Wait(third);
+
+    EXPECT_EQ(order, (std::vector<int>{0, 1, 2}));
+
+    // Depending on finished work schedules straight away
+    const auto late = jobs.Submit([&] { record(3); }, std::array{third});
+    jobs.Wait(late);
+    EXPECT_EQ(order.size(), 4U);
+}
+
+TEST(JobSystem, WaitHelpsWithoutWorkers) {
+    auto jobs = JobSystem{0U};
+    auto ran = false;
+    const auto handle = jobs.Submit([&ran] { ran = true; });
+
+    EXPECT_FALSE(handle.IsDone()) << "Nothing runs until someone waits";
+    jobs.Wait(handle);
+    EXPECT_TRUE(ran);
+}
+
+TEST(JobSystem, ParallelForCoversEveryIndexOnce) {
+    for (const auto numWorkers : {0U, 3U}) {
+        auto jobs = JobSystem{numWorkers};
+        auto hits = std::vector<std::atomic<int>>(10'001U);
+        jobs.ParallelFor(hits.size(), 64U, [&hits](std::size_t begin, std::size_t end) {
+            for (auto i = begin; i < end; ++i) ++hits[i];
+        });
+
+        for (auto i = std::size_t{0U}; i < hits.size(); ++i) ASSERT_EQ(hits[i].load(), 1) << i << " with " << numWorkers << " workers";
+    }
+}
+
+TEST(JobSystem, NestedParallelForFromWorker) {
+    auto jobs = JobSystem{2U};
+    auto total = std::atomic<std::size_t>{0U};
+
+    const auto outer = jobs.Submit([&] {
+        jobs.ParallelFor(1'000U, 10U, [&total](std::size_t begin, std::size_t end) { total += end - begin; });
+    });
+    jobs.Wait(outer);
+
+    EXPECT_EQ(total.load(), 1'000U);
+}
+
+TEST(JobSystem, MainThreadJobsWaitToBePumped) {
+    auto jobs = JobSystem{2U};
+    auto mainThreadId = std::thread::id{};
+    const auto onMain = jobs.Submit([&mainThreadId] { mainThreadId = std::this_thread::get_id(); }, {}, JobAffinity::MainThread);
+    const auto after = jobs.Submit([] {}, std::array{onMain});
+
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    EXPECT_FALSE(onMain.IsDone());
+    EXPECT_FALSE(after.IsDone());
+
+    EXPECT_TRUE(jobs.IsMainThread());
+    EXPECT_EQ(jobs.RunMainThreadJobs(std::chrono::microseconds{0}), 1U);
+    EXPECT_EQ(mainThreadId, std::this_thread::get_id());
+
+    jobs.Wait(after);
+    EXPECT_EQ(jobs.RunMainThreadJobs(std::chrono::microseconds{0}), 0U);
+}
+
+TEST(JobSystem, MainThreadJobsOnlyRunWhenPumped) {
+    auto jobs = JobSystem{1U};
+    auto ran = false;
+    const auto handle = jobs.Submit([&ran] { ran = true; }, {}, JobAffinity::MainThread);
+
+    jobs.ParallelFor(100U, 1U, [](std::size_t, std::size_t) {});
+    EXPECT_FALSE(ran) << "Waiting for a batch must not run main-thread work";
+    EXPECT_THROW(jobs.Wait(handle), std::runtime_error);
+
+    EXPECT_EQ(jobs.RunMainThreadJobs(std::chrono::microseconds{0}), 1U);
+    EXPECT_TRUE(ran);
+}
+
+TEST(JobSystem, ParallelForOnlyHelpsWithItsOwnChunks) {
+    auto jobs = JobSystem{1U};
+    auto release = std::atomic<bool>{false};
+    const auto blocker = jobs.Submit([&release] { while (!release.load()) std::this_thread::yield(); });
+    auto unrelatedThread = std::thread::id{};
+    const auto unrelated = jobs.Submit([&unrelatedThread] { unrelatedThread = std::this_thread::get_id(); });
+
+    // The only worker is stuck on the blocker, so the caller runs every chunk itself and leaves the unrelated job alone
+    auto total = std::atomic<std::size_t>{0U};
+    jobs.ParallelFor(1'000U, 10U, [&total](std::size_t begin, std::size_t end) { total += end - begin; });
+    EXPECT_EQ(total.load(), 1'000U);
+    EXPECT_FALSE(unrelated.IsDone());
+
+    release = true;
+    while (!unrelated.IsDone()) std::this_thread::yield();
+    EXPECT_TRUE(blocker.IsDone());
+    EXPECT_NE(unrelatedThread, std::this_thread::get_id());
+}
+
+TEST(JobSystem, ParallelForRethrowsOnceEveryChunkIsDone) {
+    auto jobs = JobSystem{3U};
+    auto numRun = std::atomic<int>{0};
+    const auto body = [&numRun](std::size_t begin, std::size_t) {
+        std::this_thread::sleep_for(std::chrono::microseconds{100});
+        ++numRun;
+        if (begin == 0U) throw std::runtime_error("first chunk");
+    };
+
+    EXPECT_THROW(jobs.ParallelFor(64U, 1U, body), std::runtime_error);
+    EXPECT_EQ(numRun.load(), 64);
+}
+
+TEST(JobSystem, QueuedJobsFinishBeforeShutdown) {
+    auto count = std::atomic<int>{0};
+    {
+        auto jobs = JobSystem{2U};
+        for (auto i = 0; i < 100; ++i) jobs.Submit([&count] { ++count; });
+    }
+    EXPECT_EQ(count.load(), 100);
+}
@@ -0,0 +1,124 @@
+#include "debugutils.h"
+#include "logger.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <format>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Captures everything the logger writes for the lifetime of a test
+class CapturedLog {
+    std::mutex mutex;
+    std::vector<std::string> lines;
+
+public:
+    CapturedLog() {
+        Logger::GetInstance().Flush();
+        Logger::GetInstance().SetSink([this](LogLevel, std::string_view line) {
+            auto lock = std::scoped_lock{mutex};
+            lines.emplace_back(line);
+        });
+    }
+
+    ~CapturedLog() {
+        auto& logger = Logger::GetInstance();
+        logger.Flush();
+        logger.SetSink({});
+        logger.SetLevel(Logger::DEFAULT_LEVEL);
+        logger.SetRateLimiting(true);
+    }
+
+    CapturedLog(const CapturedLog&) = delete;
+    auto operator=(const CapturedLog&) -> CapturedLog& = delete;
+    CapturedLog(CapturedLog&&) = delete;
+    auto operator=(CapturedLog&&) -> CapturedLog& = delete;
+
+    auto Lines() -> std::vector<std::string> {
+        Logger::GetInstance().Flush();
+        auto lock = std::scoped_lock{mutex};
+        return lines;
+    }
+};
+
+}
+
+TEST(Logger, FormatsCapturedArguments) {
+    auto log = CapturedLog{};
+    auto built = std::string("built");
+    DebugMessage("WARN", "{} {:.2f} {:>4} {} {}", 42, 3.14159, 'x', built, "literal");
+    DebugMessage("ERROR", built);
+
+    const auto lines = log.Lines();
+    ASSERT_EQ(lines.size(), 2U);
+    EXPECT_EQ(lines[0], "[WARN   ]: 42 3.14    x built literal");
+    EXPECT_EQ(lines[1], "[ERROR  ]: built");
+}
+
+TEST(Logger, FiltersByLevel) {
+    auto log = CapturedLog{};
+    Logger::GetInstance().SetLevel(LogLevel::Error);
+    DebugMessage("INFO", "hidden {}", 1);
+    DebugMessage("WARN", "hidden");
+    DebugMessage("ERROR", "shown {}", 2);
+
+    EXPECT_EQ(log.Lines(), std::vector<std::string>{"[ERROR  ]: shown 2"});
+}
+
+TEST(Logger, RateLimitsRepeatedMessages) {
+    auto log = CapturedLog{};
+    for (auto i = 0; i < 100; ++i) DebugMessage("ERROR", "No active camera found");
+
+    const auto lines = log.Lines();
+    EXPECT_EQ(lines.size(), Logger::RATE_LIMIT_MESSAGES);
+
+    Logger::GetInstance().SetRateLimiting(false);
+    for (auto i = 0; i < 100; ++i) DebugMessage("ERROR", "No active camera found");
+    EXPECT_EQ(log.Lines().size(), Logger::RATE_LIMIT_MESSAGES + 100U);
+}
+
+TEST(Logger, TruncatesLongStrings) {
+    auto log = CapturedLog{};
+    const auto longString = std::string(1'000U, 'a');
+    DebugMessage("WARN", "{} {}", longString, 7);
+
+    const auto lines = log.Lines();
+    ASSERT_EQ(lines.size(), 1U);
+    EXPECT_LT(lines[0].size(), LogRecord::PAYLOAD_SIZE + 16U);
+    EXPECT_TRUE(lines[0].starts_with("[WARN   ]: aaaa"));
+}
+
+TEST(Logger, KeepsEachThreadInOrder) {
+    auto log = CapturedLog{};
+    constexpr auto numThreads = 4;
+    constexpr auto numMessages = 200;
+    {
+        auto threads = std::vector<std::jthread>{};
+        for (auto thread = 0; thread < numThreads; ++thread) {
+            threads.emplace_back([thread] {
+                for (auto i = 0; i < numMessages; ++i) {
+                    // Built per thread so rate limiting leaves them alone
+                    DebugMessage("WARN", std::format("{} {}", thread, i));
+                    if (i % 64 == 0) std::this_thread::yield();
+                }
+            });
+        }
+    }
+
+    auto next = std::vector<int>(numThreads, 0);
+    for (const auto& line : log.Lines()) {
+        auto thread = 0;
+        auto index = 0;
+        ASSERT_EQ(std::sscanf(line.c_str(), "[WARN   ]: %d %d", &thread, &index), 2); // NOLINT(cert-err34-c)
+        EXPECT_EQ(index, next[static_cast<std::size_t>(thread)]++);
+    }
+    EXPECT_TRUE(std::ranges::all_of(next, [](int count) { return count == numMessages; }));
+}
@@ -0,0 +1,98 @@
+#include "memorytracker.h"
+#include "meshcomponent.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+using TestMemoryTag = NamedMemoryTag<"Test/Tracking allocator">;
+
+}
+
+TEST(MemoryCounter, TracksHighWater) {
+    auto counter = MemoryCounter{};
+    counter.Add(100U);
+    counter.Add(50U);
+    counter.Remove(120U);
+
+    EXPECT_EQ(counter.Bytes(), 30);
+    EXPECT_EQ(counter.HighWater(), 150);
+    EXPECT_EQ(counter.NumAllocations(), 2U);
+}
+
+TEST(MemoryCounter, CountsFromManyThreads) {
+    auto counter = MemoryCounter{};
+    auto threads = std::vector<std::thread>{};
+    for (auto i = 0; i < 4; ++i) {
+        threads.emplace_back([&] {
+            for (auto j = 0; j < 1'000; ++j) {
+                counter.Add(8U);
+                counter.Remove(8U);
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    EXPECT_EQ(counter.Bytes(), 0);
+    EXPECT_GE(counter.HighWater(), 8);
+    EXPECT_LE(counter.HighWater(), 32);
+}
+
+TEST(MemoryTracker, NamedCountersAreShared) {
+    auto& tracker = MemoryTracker::GetInstance();
+    auto& counter = tracker.GetCounter("Test/Shared");
+    EXPECT_EQ(&counter, &tracker.GetCounter("Test/Shared"));
+
+    counter.Add(2'048U);
+    const auto snapshot = tracker.Snapshot();
+    const auto found = std::ranges::find(snapshot, std::string("Test/Shared"), &MemoryCounterSnapshot::name);
+    ASSERT_NE(found, snapshot.end());
+    EXPECT_EQ(found->bytes, 2'048);
+    EXPECT_NE(tracker.Report().find("Test/Shared"), std::string::npos);
+    counter.Remove(2'048U);
+
+    EXPECT_EQ(&NamedMemoryTag<"Test/Shared">::Counter(), &counter) << "A named tag is the counter of the same name";
+}
+
+TEST(TrackingAllocator, CountsContainerStorage) {
+    const auto& counter = TestMemoryTag::Counter();
+    const auto before = counter.Bytes();
+    {
+        auto values = std::vector<std::uint64_t, TrackingAllocator<std::uint64_t, TestMemoryTag>>{};
+        values.reserve(64U);
+        EXPECT_EQ(counter.Bytes() - before, static_cast<std::int64_t>(64U * sizeof(std::uint64_t)));
+
+        // Rebound for nodes and buckets, all still under the same tag
+        auto map = std::unordered_map<int, int, std::hash<int>, std::equal_to<int>, TrackingAllocator<std::pair<const int, int>, TestMemoryTag>>{};
+        for (auto i = 0; i < 32; ++i) map.emplace(i, i);
+        EXPECT_GT(counter.Bytes() - before, static_cast<std::int64_t>(64U * sizeof(std::uint64_t) + 32U * sizeof(std::pair<const int, int>)));
+    }
+    EXPECT_EQ(counter.Bytes(), before);
+}
+
+TEST(TrackingAllocator, CountsMeshVertices) {
+    const auto before = MeshVertexMemoryTag::Counter().Bytes();
+    {
+        auto mesh = Mesh{};
+        mesh.vertices.resize(300U);
+        EXPECT_GE(MeshVertexMemoryTag::Counter().Bytes() - before, static_cast<std::int64_t>(300U * sizeof(Vertex)));
+    }
+    EXPECT_EQ(MeshVertexMemoryTag::Counter().Bytes(), before);
+}
+
+TEST(MemoryTracker, FormatsBytes) {
+    EXPECT_EQ(FormatBytes(512), "512 B");
+    EXPECT_EQ(FormatBytes(1'536), "1.50 KiB");
+    EXPECT_EQ(FormatBytes(3 * 1'024 * 1'024), "3.00 MiB");
+}
+
+TEST(MemoryTracker, DemanglesTypeNames) {
+    EXPECT_EQ(TypeName<int>(), "int");
+}
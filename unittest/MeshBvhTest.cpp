@@ -0,0 +1,138 @@
+#include "bounds.h"
+#include "meshbvh.h"
+#include "meshcomponent.h"
+#include "picking.h"
+#include "transformcomponent.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <vector>
+
+namespace {
+
+auto RandomSoup(std::mt19937& rng, std::size_t numTriangles) -> std::vector<glm::vec3> {
+    auto position = std::uniform_real_distribution<float>(-20.0F, 20.0F);
+    auto offset = std::uniform_real_distribution<float>(-1.5F, 1.5F);
+    auto corners = std::vector<glm::vec3>{};
+    for (auto i = std::size_t{0U}; i < numTriangles; ++i) {
+        const auto center = glm::vec3(position(rng), position(rng), position(rng));
+        for (auto corner = 0; corner < 3; ++corner) corners.push_back(center + glm::vec3(offset(rng), offset(rng), offset(rng)));
+    }
+    return corners;
+}
+
+// Reference Möller-Trumbore over every triangle
+auto BruteForce(const std::vector<glm::vec3>& corners, const Ray& ray, float maxDistance) -> std::optional<float> {
+    auto best = std::optional<float>{};
+    for (auto i = std::size_t{0U}; i + 2U < corners.size(); i += 3U) {
+        const auto edge1 = corners[i + 1U] - corners[i];
+        const auto edge2 = corners[i + 2U] - corners[i];
+        const auto p = glm::cross(ray.direction, edge2);
+        const auto det = glm::dot(edge1, p);
+        if (std::abs(det) < 1e-12F) continue;
+
+        const auto s = ray.origin - corners[i];
+        const auto u = glm::dot(s, p) / det;
+        const auto q = glm::cross(s, edge1);
+        const auto v = glm::dot(ray.direction, q) / det;
+        const auto t = glm::dot(edge2, q) / det;
+        if (u < 0.0F || v < 0.0F || u + v > 1.0F || t < 0.0F || t >= maxDistance) continue;
+        if (!best || t < *best) best = t;
+    }
+    return best;
+}
+
+}
+
+TEST(MeshBvh, NodesArePacked) {
+    EXPECT_EQ(sizeof(MeshBvh::Node), 32U);
+}
+
+TEST(MeshBvh, MatchesBruteForce) {
+    auto rng = std::mt19937{5U};
+    const auto corners = RandomSoup(rng, 2'000U);
+    const auto bvh = MeshBvh::Build(corners);
+
+    EXPECT_EQ(bvh.NumTriangles(), 2'000U);
+    for (const auto& node : bvh.GetNodes()) {
+        if (node.IsLeaf()) EXPECT_LE(node.count, MeshBvh::MAX_LEAF_TRIANGLES);
+    }
+
+    auto direction = std::uniform_real_distribution<float>(-1.0F, 1.0F);
+    auto numHits = 0;
+    for (auto i = 0; i < 500; ++i) {
+        const auto ray = Ray{ .origin = glm::vec3(0.0F, 0.0F, 40.0F), .direction = glm::vec3(direction(rng) * 0.5F, direction(rng) * 0.5F, -1.0F) };
+        const auto expected = BruteForce(corners, ray, 100.0F);
+        const auto hit = bvh.Intersect(ray, 100.0F);
+
+        ASSERT_EQ(hit.has_value(), expected.has_value());
+        if (!hit) continue;
+        ++numHits;
+        EXPECT_NEAR(hit->distance, *expected, 1e-4F);
+
+        const auto& a = corners[hit->triangle * 3U];
+        const auto point = a + hit->barycentric.x * (corners[hit->triangle * 3U + 1U] - a) + hit->barycentric.y * (corners[hit->triangle * 3U + 2U] - a);
+        EXPECT_LT(glm::length(point - ray.At(hit->distance)), 1e-3F);
+    }
+    EXPECT_GT(numHits, 0);
+}
+
+TEST(MeshBvh, EmptyMeshNeverHits) {
+    const auto bvh = MeshBvh::Build({});
+    EXPECT_EQ(bvh.NumNodes(), 0U);
+    EXPECT_FALSE(bvh.Intersect(Ray{}, 100.0F).has_value());
+}
+
+TEST(MeshBvh, PickThroughTransform) {
+    // Unit quad in the XY plane facing +Z
+    const auto corners = std::vector<glm::vec3>{
+        glm::vec3(-1.0F, -1.0F, 0.0F), glm::vec3(1.0F, -1.0F, 0.0F), glm::vec3(1.0F, 1.0F, 0.0F),
+        glm::vec3(-1.0F, -1.0F, 0.0F), glm::vec3(1.0F, 1.0F, 0.0F), glm::vec3(-1.0F, 1.0F, 0.0F)
+    };
+    const auto bvh = MeshBvh::Build(corners);
+
+    // Stretched and turned to face +X, then moved so its plane sits at x = 4
+    const auto transform = TransformComponent{
+        .scale = glm::vec3(3.0F, 3.0F, 1.0F),
+        .rotation = glm::angleAxis(glm::radians(90.0F), glm::vec3(0.0F, 1.0F, 0.0F)),
+        .translation = glm::vec3(4.0F, 0.0F, 0.0F)
+    };
+
+    const auto ray = Ray{ .origin = glm::vec3(10.0F, 2.5F, 0.0F), .direction = glm::vec3(-2.0F, 0.0F, 0.0F) };
+    const auto hit = PickMesh(bvh, transform, ray, 100.0F);
+    ASSERT_TRUE(hit.has_value());
+    EXPECT_NEAR(hit->distance, 3.0F, 1e-4F);
+
+    // Outside the scaled quad
+    const auto miss = Ray{ .origin = glm::vec3(10.0F, 3.5F, 0.0F), .direction = glm::vec3(-1.0F, 0.0F, 0.0F) };
+    EXPECT_FALSE(PickMesh(bvh, transform, miss, 100.0F).has_value());
+
+    // Beyond maxDistance
+    EXPECT_FALSE(PickMesh(bvh, transform, ray, 2.0F).has_value());
+}
+
+TEST(MeshBvh, ClusteringKeepsTriangleIdsValid) {
+    auto rng = std::mt19937{9U};
+    auto mesh = Mesh{};
+    for (const auto& corner : RandomSoup(rng, 300U)) mesh.vertices.push_back(Vertex{ .position = corner, .normal = glm::vec3(0.0F, 0.0F, 1.0F) });
+    mesh.ComputeBounds();
+    mesh.BuildBvh();
+    mesh.BuildClusters(32U);
+
+    ASSERT_TRUE(mesh.bvh);
+    const auto ray = Ray{ .origin = glm::vec3(0.0F, 0.0F, 40.0F), .direction = glm::vec3(0.0F, 0.0F, -1.0F) };
+    if (const auto hit = mesh.bvh->Intersect(ray, 100.0F)) {
+        const auto& a = mesh.vertices[hit->triangle * 3U].position;
+        const auto& b = mesh.vertices[hit->triangle * 3U + 1U].position;
+        const auto& c = mesh.vertices[hit->triangle * 3U + 2U].position;
+        const auto point = a + hit->barycentric.x * (b - a) + hit->barycentric.y * (c - a);
+        EXPECT_LT(glm::length(point - ray.At(hit->distance)), 1e-3F);
+    }
+}
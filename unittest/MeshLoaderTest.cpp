@@ -0,0 +1,121 @@
+#include "meshloader.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr auto TRIANGLE_OBJ = R"(v -1.000000 0.000000 1.000000
+v 1.000000 0.000000 1.000000
+v -1.000000 0.000000 -1.000000
+vn -0.0000 1.0000 -0.0000
+f 1//1 2//1 3//1
+)";
+
+auto WriteTempObj(const char* name, const char* contents) -> std::string {
+    auto path = std::filesystem::temp_directory_path() / name;
+    auto file = std::ofstream(path);
+    file << contents;
+    return path.string();
+}
+
+auto WaitForLoaded(MeshLoader& loader) -> std::optional<MeshLoader::LoadedMesh> {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{5};
+    while (std::chrono::steady_clock::now() < deadline) {
+        if (auto loaded = loader.TryPopLoaded()) return loaded;
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+    return std::nullopt;
+}
+
+}
+
+TEST(MeshLoader, LoadsInBackground) {
+    const auto path = WriteTempObj("meshloader_triangle.obj", TRIANGLE_OBJ);
+
+    auto arena = GeometryArena{};
+    auto cache = MeshCache{arena};
+    auto loader = MeshLoader{cache};
+    loader.Request(3U, path);
+    EXPECT_EQ(loader.NumPending(), 1U);
+
+    auto loaded = WaitForLoaded(loader);
+    ASSERT_TRUE(loaded.has_value());
+    EXPECT_EQ(loaded->key, MeshCache::MakeKey(path));
+    EXPECT_EQ(loaded->mesh.vertices.size(), 3U);
+    EXPECT_EQ(loader.TakeWaiters(loaded->key), std::vector<EntityId>{3U});
+    EXPECT_EQ(loader.NumPending(), 0U);
+}
+
+TEST(MeshLoader, MissingFileGivesEmptyMesh) {
+    auto arena = GeometryArena{};
+    auto cache = MeshCache{arena};
+    auto loader = MeshLoader{cache};
+    loader.Request(0U, (std::filesystem::temp_directory_path() / "meshloader_missing.obj").string());
+
+    auto loaded = WaitForLoaded(loader);
+    ASSERT_TRUE(loaded.has_value());
+    EXPECT_TRUE(loaded->mesh.vertices.empty());
+}
+
+TEST(MeshLoader, SharedPathParsedOnce) {
+    const auto path = WriteTempObj("meshloader_triangle.obj", TRIANGLE_OBJ);
+
+    auto arena = GeometryArena{};
+    auto cache = MeshCache{arena};
+    auto loader = MeshLoader{cache};
+    for (auto entity = 0U; entity < 100U; ++entity) {
+        loader.Request(entity, path);
+    }
+    EXPECT_EQ(loader.NumPending(), 1U);
+
+    auto loaded = WaitForLoaded(loader);
+    ASSERT_TRUE(loaded.has_value());
+    EXPECT_EQ(loader.TakeWaiters(loaded->key).size(), 100U);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    EXPECT_FALSE(loader.TryPopLoaded().has_value());
+}
+
+TEST(MeshLoader, LaterRequestSupersedesEarlier) {
+    const auto firstPath = WriteTempObj("meshloader_first.obj", TRIANGLE_OBJ);
+    const auto secondPath = WriteTempObj("meshloader_second.obj", TRIANGLE_OBJ);
+
+    auto arena = GeometryArena{};
+    auto cache = MeshCache{arena};
+    auto loader = MeshLoader{cache};
+    loader.Request(7U, firstPath);
+    loader.Request(8U, firstPath);
+    loader.Request(7U, secondPath);
+
+    EXPECT_EQ(loader.TakeWaiters(MeshCache::MakeKey(firstPath)), std::vector<EntityId>{8U});
+    EXPECT_EQ(loader.TakeWaiters(MeshCache::MakeKey(secondPath)), std::vector<EntityId>{7U});
+}
+
+TEST(MeshLoader, CancelledRequestHasNoWaiters) {
+    const auto path = WriteTempObj("meshloader_triangle.obj", TRIANGLE_OBJ);
+
+    auto arena = GeometryArena{};
+    auto cache = MeshCache{arena};
+    auto loader = MeshLoader{cache};
+    loader.Request(2U, path);
+    loader.Cancel(2U);
+
+    EXPECT_TRUE(loader.TakeWaiters(MeshCache::MakeKey(path)).empty());
+}
+
+TEST(MeshCache, KeysAreNormalised) {
+    EXPECT_EQ(MeshCache::MakeKey("data/../data/./tris.obj"), MeshCache::MakeKey("data/tris.obj"));
+
+    auto arena = GeometryArena{};
+    auto cache = MeshCache{arena};
+    EXPECT_EQ(cache.Find(MeshCache::MakeKey("data/tris.obj")), nullptr);
+    EXPECT_EQ(cache.Prune(), 0U);
+}
@@ -1,5 +1,6 @@
 #include "meshcomponent.h"
 #include "GLMTestHelpers.h"
+#include "framearena.h"
 
 #include <gtest/gtest.h>
 
@@ -65,3 +66,101 @@ f 3//1 2//1 4//2
     GLM_EXPECT_NEAR(mesh.vertices[4].normal, glm::vec3(-0.0710, 0.9949, 0.0710), 1e-5);
     GLM_EXPECT_NEAR(mesh.vertices[5].normal, glm::vec3( 0.0000, 1.0000, 0.0000), 1e-5);
 }
+
+TEST(MeshTest, BoundsComputedOnLoad) {
+
+    auto mesh = Mesh::ReadObj(std::string_view{
+R"(v -1.000000 0.000000 1.000000
+v 3.000000 2.000000 1.000000
+v -1.000000 -2.000000 -1.000000
+vn -0.0000 1.0000 -0.0000
+f 1//1 2//1 3//1
+)"});
+
+    GLM_EXPECT_NEAR(mesh.bounds.min, glm::vec3(-1.0, -2.0, -1.0), 1e-5);
+    GLM_EXPECT_NEAR(mesh.bounds.max, glm::vec3( 3.0,  2.0,  1.0), 1e-5);
+
+    GLM_EXPECT_NEAR(mesh.sphere.center, glm::vec3(1.0, 0.0, 0.0), 1e-5);
+    EXPECT_NEAR(mesh.sphere.radius, 3.0, 1e-5);
+}
+
+TEST(MeshTest, ParsesIntoScratchArena) {
+    auto arena = FrameArena{};
+    const auto numUpstream = arena.NumUpstreamAllocations();
+
+    auto mesh = Mesh::ReadObj(std::string_view{
+"v 0 0 0\r\nv\t1 0 0\r\nv 0 1 0\r\nvn 0 0 1\r\n\r\nf 1/7/1 2/7/1 3/7/1\r\nf 1//x 2//1 3//1\r\n"}, &arena);
+
+    ASSERT_EQ(mesh.vertices.size(), 3U);
+    GLM_EXPECT_NEAR(mesh.vertices[1].position, glm::vec3(1.0, 0.0, 0.0), 1e-5);
+    // The texture coordinate index is skipped, and the face with a bad index is dropped
+    GLM_EXPECT_NEAR(mesh.vertices[2].normal, glm::vec3(0.0, 0.0, 1.0), 1e-5);
+    EXPECT_GT(arena.BytesUsed(), 0U);
+    EXPECT_EQ(arena.NumUpstreamAllocations(), numUpstream);
+}
+
+TEST(MeshTest, OutOfRangeFacesAreSkipped) {
+    auto mesh = Mesh::ReadObj(std::string_view{
+"v 0 0 0\nv 1 0 0\nv 0 1 0\nvn 0 0 1\nf 1//1 2//1 4//1\nf 1//1 2//2 3//1\nf 0//1 2//1 3//1\nf 1//1 2//1\nf 1//1\nf 1//1 2//1 3//1\n"});
+
+    ASSERT_EQ(mesh.vertices.size(), 3U) << "Only the last face indexes data that exists and has three corners";
+    GLM_EXPECT_NEAR(mesh.vertices[0].position, glm::vec3(0.0, 0.0, 0.0), 1e-5);
+    GLM_EXPECT_NEAR(mesh.vertices[2].position, glm::vec3(0.0, 1.0, 0.0), 1e-5);
+}
+
+namespace {
+
+// Flat grid in the xz plane with counter-clockwise triangles facing +y
+auto MakeGridMesh(int size) -> Mesh {
+    auto mesh = Mesh{};
+    const auto up = glm::vec3(0.0F, 1.0F, 0.0F);
+    for (auto x = 0; x < size; ++x) {
+        for (auto z = 0; z < size; ++z) {
+            const auto p00 = glm::vec3(static_cast<float>(x), 0.0F, static_cast<float>(z));
+            const auto p10 = p00 + glm::vec3(1.0F, 0.0F, 0.0F);
+            const auto p01 = p00 + glm::vec3(0.0F, 0.0F, 1.0F);
+            const auto p11 = p00 + glm::vec3(1.0F, 0.0F, 1.0F);
+            mesh.vertices.insert(mesh.vertices.end(), { Vertex{p00, up}, Vertex{p01, up}, Vertex{p10, up} });
+            mesh.vertices.insert(mesh.vertices.end(), { Vertex{p10, up}, Vertex{p01, up}, Vertex{p11, up} });
+        }
+    }
+    mesh.ComputeBounds();
+    return mesh;
+}
+
+}
+
+TEST(MeshTest, ClustersCoverAllTriangles) {
+    auto mesh = MakeGridMesh(32);
+    const auto numVertices = mesh.vertices.size();
+
+    mesh.BuildClusters(128U);
+
+    EXPECT_EQ(mesh.vertices.size(), numVertices);
+    ASSERT_EQ(mesh.clusters.size(), 16U);
+
+    auto nextVertex = 0U;
+    for (const auto& cluster : mesh.clusters) {
+        EXPECT_EQ(cluster.firstVertex, nextVertex);
+        EXPECT_EQ(cluster.numVertices % 3U, 0U);
+        nextVertex += cluster.numVertices;
+
+        for (auto i = cluster.firstVertex; i < cluster.firstVertex + cluster.numVertices; ++i) {
+            EXPECT_LE(glm::distance(mesh.vertices[i].position, cluster.sphere.center), cluster.sphere.radius + 1e-4F);
+        }
+
+        GLM_EXPECT_NEAR(cluster.coneAxis, glm::vec3(0.0, 1.0, 0.0), 1e-5);
+        EXPECT_NEAR(cluster.coneCutoff, 0.0F, 1e-3F);
+    }
+    EXPECT_EQ(nextVertex, numVertices);
+}
+
+TEST(MeshTest, ClusterBackfacing) {
+    auto mesh = MakeGridMesh(8);
+    mesh.BuildClusters(32U);
+
+    for (const auto& cluster : mesh.clusters) {
+        EXPECT_FALSE(cluster.IsBackfacing(cluster.sphere.center + glm::vec3(0.0F, 10.0F, 0.0F)));
+        EXPECT_TRUE(cluster.IsBackfacing(cluster.sphere.center - glm::vec3(0.0F, 10.0F, 0.0F)));
+    }
+}
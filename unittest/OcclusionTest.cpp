@@ -0,0 +1,114 @@
+#include "bounds.h"
+#include "jobsystem.h"
+#include "occlusion.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <gtest/gtest.h>
+
+#include <utility>
+#include <vector>
+
+namespace {
+
+auto MakeTestViewProj() -> glm::mat4 {
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
+    const auto proj = glm::perspective(glm::radians(90.0F), 2.0F, 0.1F, 100.0F);
+    const auto view = glm::lookAt(glm::vec3(0.0F), glm::vec3(0.0F, 0.0F, -1.0F), glm::vec3(0.0F, 1.0F, 0.0F));
+    return proj * view;
+}
+
+// Wall facing the camera at z = -5, counter-clockwise seen from the origin
+auto MakeWall() -> std::vector<glm::vec3> {
+    return {
+        {-2.0F, -2.0F, -5.0F}, {2.0F, -2.0F, -5.0F}, {2.0F, 2.0F, -5.0F},
+        {-2.0F, -2.0F, -5.0F}, {2.0F, 2.0F, -5.0F}, {-2.0F, 2.0F, -5.0F}
+    };
+}
+
+auto MakeBox(const glm::vec3& center, float halfSize) -> BoundingBox {
+    return BoundingBox{ .min = center - glm::vec3(halfSize), .max = center + glm::vec3(halfSize) };
+}
+
+}
+
+TEST(Occlusion, NothingHiddenWithoutOccluders) {
+    auto culler = OcclusionCuller{64, 32};
+    culler.Begin(MakeTestViewProj());
+    culler.Rasterize();
+
+    EXPECT_FALSE(culler.HasOccluders());
+    EXPECT_TRUE(culler.IsVisible(MakeBox(glm::vec3(0.0F, 0.0F, -10.0F), 0.5F)));
+}
+
+TEST(Occlusion, WallHidesWhatIsBehindIt) {
+    auto culler = OcclusionCuller{128, 64};
+    culler.Begin(MakeTestViewProj());
+    culler.AddOccluder(MakeWall(), glm::mat4(1.0F));
+    culler.Rasterize();
+
+    EXPECT_FALSE(culler.IsVisible(MakeBox(glm::vec3(0.0F, 0.0F, -10.0F), 0.5F))) << "Behind the wall";
+    EXPECT_TRUE(culler.IsVisible(MakeBox(glm::vec3(0.0F, 0.0F, -3.0F), 0.5F))) << "In front of the wall";
+    EXPECT_TRUE(culler.IsVisible(MakeBox(glm::vec3(8.0F, 0.0F, -10.0F), 0.5F))) << "Beside the wall";
+    EXPECT_TRUE(culler.IsVisible(MakeBox(glm::vec3(0.0F, 0.0F, -10.0F), 6.0F))) << "Larger than the wall";
+    EXPECT_TRUE(culler.IsVisible(MakeBox(glm::vec3(0.0F, 0.0F, 0.0F), 1.0F))) << "Crossing the near plane";
+
+    EXPECT_EQ(culler.GetStats().tested, 5U);
+    EXPECT_EQ(culler.GetStats().culled, 1U);
+    EXPECT_EQ(culler.GetStats().occluderTriangles, 2U);
+}
+
+TEST(Occlusion, BackFacesAreSkipped) {
+    auto wall = MakeWall();
+    std::swap(wall[1], wall[2]);
+    std::swap(wall[4], wall[5]);
+
+    auto culler = OcclusionCuller{64, 32};
+    culler.Begin(MakeTestViewProj());
+    culler.AddOccluder(wall, glm::mat4(1.0F));
+    culler.Rasterize();
+
+    EXPECT_FALSE(culler.HasOccluders());
+    EXPECT_TRUE(culler.IsVisible(MakeBox(glm::vec3(0.0F, 0.0F, -10.0F), 0.5F)));
+}
+
+TEST(Occlusion, ClipsAtNearPlane) {
+    // A floor running from behind the camera into the distance
+    const auto floor = std::vector<glm::vec3>{
+        {-50.0F, -1.0F, 10.0F}, {50.0F, -1.0F, 10.0F}, {50.0F, -1.0F, -50.0F},
+        {-50.0F, -1.0F, 10.0F}, {50.0F, -1.0F, -50.0F}, {-50.0F, -1.0F, -50.0F}
+    };
+
+    auto culler = OcclusionCuller{64, 32};
+    culler.Begin(MakeTestViewProj());
+    culler.AddOccluder(floor, glm::mat4(1.0F));
+    culler.Rasterize();
+
+    EXPECT_TRUE(culler.HasOccluders());
+    EXPECT_FALSE(culler.IsVisible(MakeBox(glm::vec3(0.0F, -5.0F, -10.0F), 0.5F))) << "Under the floor";
+    EXPECT_TRUE(culler.IsVisible(MakeBox(glm::vec3(0.0F, 1.0F, -10.0F), 0.5F))) << "Above the floor";
+}
+
+TEST(Occlusion, TilesMatchAcrossThreadCounts) {
+    auto serialJobs = JobSystem{0U};
+    auto parallelJobs = JobSystem{4U};
+    auto single = OcclusionCuller{200, 100, serialJobs};
+    auto threaded = OcclusionCuller{200, 100, parallelJobs};
+
+    for (auto* culler : {&single, &threaded}) {
+        culler->Begin(MakeTestViewProj());
+        culler->AddOccluder(MakeWall(), glm::rotate(glm::mat4(1.0F), 0.3F, glm::vec3(0.0F, 0.0F, 1.0F)));
+        culler->Rasterize();
+    }
+
+    ASSERT_EQ(single.Width(), threaded.Width());
+    auto numCovered = 0;
+    for (auto y = 0; y < single.Height(); ++y) {
+        for (auto x = 0; x < single.Width(); ++x) {
+            ASSERT_EQ(single.DepthAt(x, y), threaded.DepthAt(x, y)) << x << ", " << y;
+            numCovered += single.DepthAt(x, y) < 1.0F ? 1 : 0;
+        }
+    }
+    EXPECT_GT(numCovered, 0);
+}
@@ -0,0 +1,55 @@
+#include "programcache.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+namespace {
+
+auto MakeTestDesc() -> ProgramDesc {
+    return ProgramDesc{
+        .stages = {{"test.vert", GL_VERTEX_SHADER}, {"test.frag", GL_FRAGMENT_SHADER}},
+        .defines = {"USE_FOG"}
+    };
+}
+
+}
+
+TEST(ProgramCache, HashIsStable) {
+    const auto desc = MakeTestDesc();
+    const auto sources = std::vector<std::string>{"void main() {}", "void main() { }"};
+
+    EXPECT_EQ(HashProgram("vendor", desc, sources), HashProgram("vendor", desc, sources));
+}
+
+TEST(ProgramCache, HashChangesWithAnyInput) {
+    const auto desc = MakeTestDesc();
+    const auto sources = std::vector<std::string>{"void main() {}", "void main() { }"};
+    const auto hash = HashProgram("vendor", desc, sources);
+
+    EXPECT_NE(hash, HashProgram("other vendor", desc, sources)) << "Driver change";
+
+    auto defined = desc;
+    defined.defines.emplace_back("MAX_LIGHTS 4");
+    EXPECT_NE(hash, HashProgram("vendor", defined, sources)) << "Extra define";
+
+    auto swapped = desc;
+    std::swap(swapped.stages[0].type, swapped.stages[1].type);
+    EXPECT_NE(hash, HashProgram("vendor", swapped, sources)) << "Stage types";
+
+    const auto edited = std::vector<std::string>{"void main() {}", "void main() {  }"};
+    EXPECT_NE(hash, HashProgram("vendor", desc, edited)) << "Source edit";
+
+    const auto shifted = std::vector<std::string>{"void main() {}v", "oid main() { }"};
+    EXPECT_NE(hash, HashProgram("vendor", desc, shifted)) << "Boundary between sources";
+}
+
+TEST(ProgramCache, DefinesFollowVersion) {
+    const auto defines = std::vector<std::string>{"USE_FOG", "MAX_LIGHTS 4"};
+
+    EXPECT_EQ(InjectDefines("#version 460 core\nvoid main() {}\n", defines), "#version 460 core\n#define USE_FOG\n#define MAX_LIGHTS 4\nvoid main() {}\n");
+    EXPECT_EQ(InjectDefines("#version 460 core", defines), "#version 460 core\n#define USE_FOG\n#define MAX_LIGHTS 4\n");
+    EXPECT_EQ(InjectDefines("void main() {}\n", defines), "#define USE_FOG\n#define MAX_LIGHTS 4\nvoid main() {}\n");
+    EXPECT_EQ(InjectDefines("#version 460 core\nvoid main() {}\n", {}), "#version 460 core\nvoid main() {}\n");
+}
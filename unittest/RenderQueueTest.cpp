@@ -0,0 +1,60 @@
+#include "renderqueue.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <ranges>
+#include <vector>
+
+TEST(RenderQueue, KeyFieldPriority) {
+    const auto base = SortKey::Make(RenderPass::Opaque, 3U, 2U, 10U, 0.5F);
+
+    EXPECT_LT(base, SortKey::Make(RenderPass::Transparent, 1U, 1U, 1U, 0.0F)) << "Pass dominates";
+    EXPECT_LT(base, SortKey::Make(RenderPass::Opaque, 4U, 1U, 1U, 0.0F)) << "Program dominates vao, mesh and depth";
+    EXPECT_LT(base, SortKey::Make(RenderPass::Opaque, 3U, 3U, 1U, 0.0F)) << "Vao dominates mesh and depth";
+    EXPECT_LT(base, SortKey::Make(RenderPass::Opaque, 3U, 2U, 11U, 0.0F)) << "Mesh dominates depth";
+    EXPECT_LT(base, SortKey::Make(RenderPass::Opaque, 3U, 2U, 10U, 0.6F)) << "Opaque sorts front to back";
+    EXPECT_GT(SortKey::Make(RenderPass::Transparent, 3U, 2U, 10U, 0.5F), SortKey::Make(RenderPass::Transparent, 3U, 2U, 10U, 0.6F)) << "Transparent sorts back to front";
+    EXPECT_EQ(SortKey::Make(RenderPass::Opaque, 3U, 2U, 10U, -1.0F), SortKey::Make(RenderPass::Opaque, 3U, 2U, 10U, 0.0F)) << "Depth is clamped";
+}
+
+TEST(RenderQueue, RadixSortMatchesStableSort) {
+    auto rng = std::mt19937_64{1234U};
+    auto queue = RenderQueue{};
+    auto expected = std::vector<DrawPacket>{};
+
+    for (auto i = 0U; i < 5000U; ++i) {
+        const auto packet = DrawPacket{
+            .sortKey = SortKey::Make(RenderPass::Opaque, static_cast<std::uint32_t>(rng() % 4U), 1U, static_cast<std::uint32_t>(rng() % 64U), std::uniform_real_distribution<float>{}(rng)),
+            .program = 0U,
+            .vao = 0U,
+            .drawIndex = i
+        };
+        queue.Push(packet);
+        expected.push_back(packet);
+    }
+
+    queue.Sort();
+    std::ranges::stable_sort(expected, {}, &DrawPacket::sortKey);
+
+    ASSERT_EQ(queue.Size(), expected.size());
+    for (auto i = 0U; i < expected.size(); ++i) {
+        EXPECT_EQ(queue.Packets()[i].sortKey, expected[i].sortKey);
+        EXPECT_EQ(queue.Packets()[i].drawIndex, expected[i].drawIndex);
+    }
+}
+
+TEST(RenderQueue, IdenticalKeysKeepOrder) {
+    auto queue = RenderQueue{};
+    for (auto i = 0U; i < 10U; ++i) {
+        queue.Push(DrawPacket{ .sortKey = 42U, .program = 0U, .vao = 0U, .drawIndex = i });
+    }
+
+    queue.Sort();
+
+    for (auto i = 0U; i < 10U; ++i) {
+        EXPECT_EQ(queue.Packets()[i].drawIndex, i);
+    }
+}
@@ -0,0 +1,158 @@
+#include "cameracomponent.h"
+#include "commandlist.h"
+#include "componentmanagers.h"
+#include "ecsmanager.h"
+#include "framearena.h"
+#include "geometryarena.h"
+#include "jobsystem.h"
+#include "logger.h"
+#include "meshcomponent.h"
+#include "occludercomponent.h"
+#include "renderer.h"
+#include "transformcomponent.h"
+
+#include <glm/glm.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <latch>
+#include <memory>
+#include <new>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Counted on every thread, so work the renderer hands to job workers is covered too
+std::atomic<bool> countAllocations{false};
+std::atomic<std::size_t> numAllocations{0U};
+
+auto CountedAllocate(std::size_t size, std::size_t alignment) -> void* {
+    if (countAllocations.load(std::memory_order_relaxed)) numAllocations.fetch_add(1U, std::memory_order_relaxed);
+
+    size = std::max(size, std::size_t{1U});
+    auto* pointer = alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__
+        ? std::aligned_alloc(alignment, (size + alignment - 1U) / alignment * alignment)
+        : std::malloc(size);
+    if (pointer == nullptr) throw std::bad_alloc{};
+    return pointer;
+}
+
+}
+
+// Every other form of new and delete forwards to these
+auto operator new(std::size_t size) -> void* { return CountedAllocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+auto operator new(std::size_t size, std::align_val_t alignment) -> void* { return CountedAllocate(size, static_cast<std::size_t>(alignment)); }
+auto operator delete(void* pointer) noexcept -> void { std::free(pointer); }
+auto operator delete(void* pointer, std::size_t) noexcept -> void { std::free(pointer); }
+auto operator delete(void* pointer, std::align_val_t) noexcept -> void { std::free(pointer); }
+auto operator delete(void* pointer, std::size_t, std::align_val_t) noexcept -> void { std::free(pointer); }
+
+namespace {
+
+using TestECS = ECSManager<
+    BasicCompManager<MeshComponent>,
+    BasicCompManager<CameraComponent>,
+    BasicCompManager<TransformComponent>,
+    BasicCompManager<OccluderComponent>
+>;
+
+// Drops GL work, the arena never creates its buffers so nothing needs a context
+struct DiscardingExecutor final : GLExecutor {
+    auto Defer([[maybe_unused]] GLTask task) -> void override {}
+    auto RunSync([[maybe_unused]] GLTask task) -> void override {}
+};
+
+// Flat grid in the xy plane facing +z, large enough to be split into clusters
+auto MakeGridMesh(int size) -> Mesh {
+    auto mesh = Mesh{};
+    const auto normal = glm::vec3(0.0F, 0.0F, 1.0F);
+    for (auto x = 0; x < size; ++x) {
+        for (auto y = 0; y < size; ++y) {
+            const auto p00 = glm::vec3(static_cast<float>(x), static_cast<float>(y), 0.0F);
+            const auto p10 = p00 + glm::vec3(1.0F, 0.0F, 0.0F);
+            const auto p01 = p00 + glm::vec3(0.0F, 1.0F, 0.0F);
+            const auto p11 = p00 + glm::vec3(1.0F, 1.0F, 0.0F);
+            mesh.vertices.insert(mesh.vertices.end(), { Vertex{p00, normal}, Vertex{p10, normal}, Vertex{p01, normal} });
+            mesh.vertices.insert(mesh.vertices.end(), { Vertex{p10, normal}, Vertex{p11, normal}, Vertex{p01, normal} });
+        }
+    }
+    mesh.ComputeBounds();
+    return mesh;
+}
+
+// Workers and the logger allocate as they start up, which belongs to no frame. Each worker is held by a job
+// until all of them have one, so every worker is known to be running before counting starts
+auto SettleBackgroundThreads() -> void {
+    auto& jobs = JobSystem::GetInstance();
+    auto started = std::latch{static_cast<std::ptrdiff_t>(jobs.NumWorkers())};
+    auto handles = std::vector<JobHandle>{};
+    for (auto i = std::size_t{0U}; i < jobs.NumWorkers(); ++i) handles.push_back(jobs.Submit([&started] { started.arrive_and_wait(); }));
+    // Not Wait, that could run one of the jobs here and leave a worker without one
+    for (const auto& handle : handles) {
+        while (!handle.IsDone()) std::this_thread::yield();
+    }
+    Logger::GetInstance().Flush();
+}
+
+auto AddEntity(TestECS& ecs, const glm::vec3& position) -> EntityId {
+    auto entity = ecs.NewEntity().value();
+    ecs.NewComponent<TransformComponent>(entity, glm::vec3(1.0F), glm::quat(1.0F, 0.0F, 0.0F, 0.0F), position);
+    return entity;
+}
+
+}
+
+TEST(Renderer, SteadyStateFramesDoNotAllocate) {
+    auto executor = DiscardingExecutor{};
+    auto arena = GeometryArena{};
+    arena.SetExecutor(executor);
+
+    auto ecs = TestECS{};
+
+    // Instanced copies of one small mesh, a clustered mesh and an occluder hiding part of the scene
+    const auto small = std::make_shared<const GpuMesh>(MakeGridMesh(1), arena);
+    for (auto x = -4; x <= 4; ++x) {
+        for (auto y = -2; y <= 2; ++y) {
+            ecs.NewComponent<MeshComponent>(AddEntity(ecs, glm::vec3(2.0F * static_cast<float>(x), 2.0F * static_cast<float>(y), 0.0F)), small);
+        }
+    }
+
+    auto clustered = MakeGridMesh(32);
+    clustered.BuildClusters(64U);
+    ecs.NewComponent<MeshComponent>(AddEntity(ecs, glm::vec3(-16.0F, -16.0F, -10.0F)), clustered, arena);
+
+    auto wall = MakeGridMesh(4);
+    ecs.NewComponent<OccluderComponent>(AddEntity(ecs, glm::vec3(-2.0F, -2.0F, 5.0F)), OccluderComponent::FromMesh(wall));
+
+    auto camera = AddEntity(ecs, glm::vec3(0.0F, 0.0F, 20.0F));
+    ecs.NewComponent<CameraComponent>(camera, 60.0F, 1.5F, 0.1F, 100.0F);
+
+    auto renderer = Renderer{ecs, GLuint{0U}};
+    renderer.activeCamera = camera;
+    auto commands = CommandList{};
+
+    // Warm-up grows every reused buffer to its final size and lets the first scene BVH build land
+    for (auto frame = 0; frame < 8 || renderer.GetScene().IsRebuilding(); ++frame) {
+        FrameArena::BeginFrame();
+        renderer.Record(commands);
+    }
+    ASSERT_GT(renderer.GetRenderStats().numDrawCalls, 0U);
+    ASSERT_GT(renderer.GetOcclusionStats().occluderTriangles, 0U);
+    ASSERT_GT(renderer.GetClusterCullStats().tested, 0U);
+    SettleBackgroundThreads();
+
+    numAllocations = 0U;
+    countAllocations = true;
+    for (auto frame = 0; frame < 100; ++frame) {
+        FrameArena::BeginFrame();
+        renderer.Record(commands);
+    }
+    countAllocations = false;
+
+    EXPECT_EQ(numAllocations.load(), 0U);
+}
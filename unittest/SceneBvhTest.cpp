@@ -0,0 +1,178 @@
+#include "bounds.h"
+#include "culling.h"
+#include "scenebvh.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+using Boxes = std::unordered_map<EntityId, BoundingBox>;
+
+auto RandomBox(std::mt19937& rng) -> BoundingBox {
+    auto position = std::uniform_real_distribution<float>(-50.0F, 50.0F);
+    auto size = std::uniform_real_distribution<float>(0.1F, 2.0F);
+    const auto min = glm::vec3(position(rng), position(rng), position(rng));
+    return BoundingBox{ .min = min, .max = min + glm::vec3(size(rng), size(rng), size(rng)) };
+}
+
+auto Sorted(std::vector<EntityId> entities) -> std::vector<EntityId> {
+    std::ranges::sort(entities);
+    return entities;
+}
+
+// Fat bounds can report a few extra entities, but never miss one the exact bounds overlap
+auto ExpectCovers(const std::vector<EntityId>& found, const std::vector<EntityId>& expected) -> void {
+    const auto sortedFound = Sorted(found);
+    for (const auto entity : expected) {
+        EXPECT_TRUE(std::ranges::binary_search(sortedFound, entity)) << "Missing entity " << entity;
+    }
+}
+
+auto ExpectQueriesMatch(const SceneBvh& bvh, const Boxes& boxes) -> void {
+    const auto proj = glm::perspective(glm::radians(60.0F), 1.0F, 0.1F, 40.0F);
+    const auto view = glm::lookAt(glm::vec3(0.0F, 0.0F, 30.0F), glm::vec3(0.0F), glm::vec3(0.0F, 1.0F, 0.0F));
+    const auto frustum = Frustum::FromMatrix(proj * view);
+    const auto queryBox = BoundingBox{ .min = glm::vec3(-10.0F), .max = glm::vec3(5.0F, 10.0F, 20.0F) };
+    const auto querySphere = BoundingSphere{ .center = glm::vec3(3.0F, -4.0F, 8.0F), .radius = 12.0F };
+    const auto ray = Ray{ .origin = glm::vec3(-60.0F, 0.5F, 0.5F), .direction = glm::vec3(1.0F, 0.0F, 0.0F) };
+
+    auto expectedFrustum = std::vector<EntityId>{};
+    auto expectedBox = std::vector<EntityId>{};
+    auto expectedSphere = std::vector<EntityId>{};
+    auto expectedRay = std::vector<EntityId>{};
+    for (const auto& [entity, box] : boxes) {
+        if (frustum.Intersects(box)) expectedFrustum.push_back(entity);
+        if (box.Overlaps(queryBox)) expectedBox.push_back(entity);
+        const auto offset = querySphere.center - glm::clamp(querySphere.center, box.min, box.max);
+        if (glm::dot(offset, offset) <= querySphere.radius * querySphere.radius) expectedSphere.push_back(entity);
+        if (ray.Intersect(box, 200.0F)) expectedRay.push_back(entity);
+    }
+
+    auto found = std::vector<EntityId>{};
+    bvh.QueryFrustum(frustum, found);
+    ExpectCovers(found, expectedFrustum);
+
+    found.clear();
+    bvh.QueryBox(queryBox, found);
+    ExpectCovers(found, expectedBox);
+
+    found.clear();
+    bvh.QuerySphere(querySphere, found);
+    ExpectCovers(found, expectedSphere);
+
+    auto hits = std::vector<RayHit>{};
+    bvh.QueryRay(ray, 200.0F, hits);
+    EXPECT_TRUE(std::ranges::is_sorted(hits, {}, &RayHit::distance));
+    found.clear();
+    for (const auto& hit : hits) found.push_back(hit.entity);
+    ExpectCovers(found, expectedRay);
+}
+
+}
+
+TEST(SceneBvh, QueriesMatchBruteForce) {
+    auto rng = std::mt19937{7U};
+    auto boxes = Boxes{};
+    auto bvh = SceneBvh{};
+    for (auto entity = EntityId{0U}; entity < 500U; ++entity) {
+        boxes[entity] = RandomBox(rng);
+        bvh.Update(entity, boxes[entity]);
+    }
+
+    EXPECT_EQ(bvh.Size(), 500U);
+    ExpectQueriesMatch(bvh, boxes);
+
+    bvh.Rebuild();
+    ExpectQueriesMatch(bvh, boxes);
+}
+
+TEST(SceneBvh, MovesAndRemovalsStayConsistent) {
+    auto rng = std::mt19937{11U};
+    auto boxes = Boxes{};
+    auto bvh = SceneBvh{};
+    for (auto entity = EntityId{0U}; entity < 300U; ++entity) {
+        boxes[entity] = RandomBox(rng);
+        bvh.Update(entity, boxes[entity]);
+    }
+
+    for (auto frame = 0; frame < 20; ++frame) {
+        for (auto entity = EntityId{0U}; entity < 300U; entity += 3U) {
+            if (!boxes.contains(entity)) continue;
+            boxes[entity] = RandomBox(rng);
+            bvh.Update(entity, boxes[entity]);
+        }
+        const auto removed = static_cast<EntityId>(frame * 7);
+        boxes.erase(removed);
+        bvh.Remove(removed);
+        bvh.Maintain();
+
+        ExpectQueriesMatch(bvh, boxes);
+    }
+
+    // Let any background build land, then the tree must still cover everything
+    while (bvh.IsRebuilding()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        bvh.Maintain();
+    }
+    EXPECT_EQ(bvh.Size(), boxes.size());
+    EXPECT_GT(bvh.GetStats().numRebuilds, 0U);
+    ExpectQueriesMatch(bvh, boxes);
+}
+
+TEST(SceneBvh, RebuildLowersCost) {
+    auto rng = std::mt19937{3U};
+    auto bvh = SceneBvh{};
+    for (auto entity = EntityId{0U}; entity < 200U; ++entity) bvh.Update(entity, RandomBox(rng));
+
+    // Scattering every entity after the build leaves refitted nodes spanning the whole scene
+    bvh.Rebuild();
+    for (auto entity = EntityId{0U}; entity < 200U; ++entity) bvh.Update(entity, RandomBox(rng));
+    const auto refitCost = bvh.Cost();
+
+    bvh.Rebuild();
+    EXPECT_LT(bvh.Cost(), refitCost);
+}
+
+TEST(SceneBvh, SyncRemovesUnseenEntities) {
+    auto bvh = SceneBvh{};
+    const auto box = BoundingBox{ .min = glm::vec3(0.0F), .max = glm::vec3(1.0F) };
+
+    bvh.BeginSync();
+    bvh.Update(1U, box);
+    bvh.Update(2U, box);
+    bvh.EndSync();
+
+    bvh.BeginSync();
+    bvh.Update(2U, box);
+    bvh.EndSync();
+
+    EXPECT_FALSE(bvh.Contains(1U));
+    EXPECT_TRUE(bvh.Contains(2U));
+    EXPECT_EQ(bvh.Size(), 1U);
+}
+
+TEST(SceneBvh, RayHitsNearestFirst) {
+    auto bvh = SceneBvh{};
+    for (auto i = 0U; i < 5U; ++i) {
+        const auto center = glm::vec3(0.0F, 0.0F, -5.0F * static_cast<float>(i + 1U));
+        bvh.Update(i, BoundingBox{ .min = center - glm::vec3(0.5F), .max = center + glm::vec3(0.5F) });
+    }
+
+    auto hits = std::vector<RayHit>{};
+    bvh.QueryRay(Ray{ .origin = glm::vec3(0.0F), .direction = glm::vec3(0.0F, 0.0F, -1.0F) }, 12.0F, hits);
+
+    ASSERT_EQ(hits.size(), 2U);
+    EXPECT_EQ(hits[0].entity, 0U);
+    EXPECT_EQ(hits[1].entity, 1U);
+    EXPECT_LT(hits[0].distance, hits[1].distance);
+}
@@ -0,0 +1,87 @@
+#include "transformbatch.h"
+#include "transformcomponent.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+
+namespace {
+
+constexpr auto TOLERANCE = 1e-4F;
+
+// Varied rotations and non-uniform scales, an odd count so the scalar tail runs as well
+auto MakeTestTransform(std::size_t i) -> TransformComponent {
+    const auto f = static_cast<float>(i);
+    const auto axis = glm::normalize(glm::vec3(1.0F + f, 2.0F - f * 0.5F, 0.5F + f * 0.25F));
+    return TransformComponent{
+        .scale = glm::vec3(1.0F + f * 0.1F, 0.5F + f * 0.05F, 2.0F - f * 0.02F),
+        .rotation = glm::angleAxis(0.3F * f, axis),
+        .translation = glm::vec3(f, -2.0F * f, 0.5F * f)
+    };
+}
+
+auto ExpectMatrixNear(const glm::mat4& actual, const glm::mat4& expected) -> void {
+    for (auto c = 0; c < 4; ++c) {
+        for (auto r = 0; r < 4; ++r) {
+            EXPECT_NEAR(actual[c][r], expected[c][r], TOLERANCE) << "column " << c << ", row " << r;
+        }
+    }
+}
+
+}
+
+TEST(TransformBatch, ComponentIsCompact) {
+    EXPECT_EQ(sizeof(TransformComponent), 40U);
+}
+
+TEST(TransformBatch, WorldMatchesComponent) {
+    constexpr auto count = std::size_t{37U};
+    auto batch = TransformBatch{};
+    for (auto i = std::size_t{0U}; i < count; ++i) batch.Add(MakeTestTransform(i));
+
+    const auto world = batch.ComputeWorld();
+    ASSERT_EQ(world.size(), count);
+    for (auto i = std::size_t{0U}; i < count; ++i) {
+        ExpectMatrixNear(world[i], MakeTestTransform(i).GetTransform());
+    }
+}
+
+TEST(TransformBatch, InverseUndoesWorld) {
+    constexpr auto count = std::size_t{37U};
+    auto batch = TransformBatch{};
+    for (auto i = std::size_t{0U}; i < count; ++i) batch.Add(MakeTestTransform(i));
+
+    const auto inverse = batch.ComputeInverseWorld();
+    ASSERT_EQ(inverse.size(), count);
+    for (auto i = std::size_t{0U}; i < count; ++i) {
+        const auto transform = MakeTestTransform(i);
+        ExpectMatrixNear(inverse[i], transform.GetInverseTransform());
+        ExpectMatrixNear(inverse[i] * transform.GetTransform(), glm::mat4(1.0F));
+    }
+}
+
+TEST(TransformBatch, ClearKeepsNothing) {
+    auto batch = TransformBatch{};
+    batch.Add(TransformComponent::Identity());
+    batch.Clear();
+
+    EXPECT_EQ(batch.Size(), 0U);
+    EXPECT_TRUE(batch.ComputeWorld().empty());
+}
+
+TEST(TransformComponent, InterpolatesBetweenStates) {
+    const auto a = TransformComponent{glm::vec3(1.0F), glm::angleAxis(0.0F, glm::vec3(0.0F, 1.0F, 0.0F)), glm::vec3(0.0F)};
+    const auto b = TransformComponent{glm::vec3(3.0F), glm::angleAxis(1.0F, glm::vec3(0.0F, 1.0F, 0.0F)), glm::vec3(2.0F, 4.0F, 0.0F)};
+
+    const auto half = TransformComponent::Interpolate(a, b, 0.5F);
+    EXPECT_FLOAT_EQ(half.scale.x, 2.0F);
+    EXPECT_FLOAT_EQ(half.translation.x, 1.0F);
+    EXPECT_FLOAT_EQ(half.translation.y, 2.0F);
+    EXPECT_NEAR(glm::angle(half.rotation), 0.5F, 1e-5F);
+
+    const auto end = TransformComponent::Interpolate(a, b, 1.0F);
+    EXPECT_NEAR(glm::angle(end.rotation), 1.0F, 1e-5F);
+}